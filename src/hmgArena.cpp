@@ -0,0 +1,247 @@
+//***********************************************************************
+// HexMG Aligned Arena CPP
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgArena.h"
+#include "hmgException.h"
+#include <new>
+#include <filesystem>
+#include <string>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdlib>
+#endif
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+static void* mapScratchFile(size_t size, void*& file, void*& mapping) {
+// a new file of size bytes in the temp directory, mapped into the memory; it is deleted when it is unmapped
+//***********************************************************************
+#ifdef _WIN32
+    char dir[MAX_PATH + 1], name[MAX_PATH + 1];
+    if (GetTempPathA(MAX_PATH + 1, dir) == 0 || GetTempFileNameA(dir, "hmg", 0, name) == 0)
+        throw hmgExcept("AlignedArena::addChunk", "cannot create a scratch file in the temp directory");
+    HANDLE hFile = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        throw hmgExcept("AlignedArena::addChunk", "cannot open the scratch file: %s", name);
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xffffffffu), nullptr);
+    void* p = hMapping != nullptr ? MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : nullptr;
+    if (p == nullptr) {
+        if (hMapping != nullptr)
+            CloseHandle(hMapping);
+        CloseHandle(hFile);
+        throw hmgExcept("AlignedArena::addChunk", "cannot map %llu bytes of the scratch file: %s", (unsigned long long)size, name);
+    }
+    file = hFile;
+    mapping = hMapping;
+    return p;
+#else
+    std::string name = (std::filesystem::temp_directory_path() / "hexmg_XXXXXX").string();
+    int fd = mkstemp(name.data());
+    if (fd < 0)
+        throw hmgExcept("AlignedArena::addChunk", "cannot create a scratch file: %s", name.c_str());
+    unlink(name.c_str()); // the mapping keeps it
+    void* p = ftruncate(fd, (off_t)size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED)
+        throw hmgExcept("AlignedArena::addChunk", "cannot map %llu bytes of the scratch file: %s", (unsigned long long)size, name.c_str());
+    file = mapping = nullptr;
+    return p;
+#endif
+}
+
+
+//***********************************************************************
+static void unmapScratchFile(void* p, [[maybe_unused]] size_t size, [[maybe_unused]] void* file, [[maybe_unused]] void* mapping) noexcept {
+//***********************************************************************
+#ifdef _WIN32
+    UnmapViewOfFile(p);
+    CloseHandle(mapping);
+    CloseHandle(file);
+#else
+    munmap(p, size);
+#endif
+}
+
+
+//***********************************************************************
+void AlignedArena::addChunk(size_t size) {
+//***********************************************************************
+    Chunk chunk;
+    chunk.data = isFileBacked
+        ? static_cast<std::byte*>(mapScratchFile(size, chunk.file, chunk.mapping)) // page aligned
+        : static_cast<std::byte*>(::operator new(size, std::align_val_t{ alignment }));
+    chunk.size = size;
+    chunks.push_back(chunk);
+    nChunkAllocations++;
+}
+
+
+//***********************************************************************
+void* AlignedArena::allocate(size_t bytes) {
+//***********************************************************************
+    if (bytes == 0)
+        return nullptr;
+    bytes = (bytes + alignment - 1) & ~(alignment - 1); // the next block starts aligned too
+
+    while (actChunk < chunks.size()) {
+        if (actOffset + bytes <= chunks[actChunk].size) {
+            void* p = chunks[actChunk].data + actOffset;
+            actOffset += bytes;
+            usedBytes += bytes;
+            return p;
+        }
+        actChunk++;
+        actOffset = 0;
+    }
+
+    // no room: the new chunk is at least as big as the previous ones together
+
+    size_t newSize = getReservedBytes();
+    if (newSize < minChunkSize)
+        newSize = minChunkSize;
+    if (newSize < bytes)
+        newSize = bytes;
+    addChunk(newSize);
+    actChunk = chunks.size() - 1;
+    actOffset = bytes;
+    usedBytes += bytes;
+    return chunks[actChunk].data;
+}
+
+
+//***********************************************************************
+void AlignedArena::reserve(size_t bytes) {
+// the rest of the actual chunk is skipped if it is too small
+//***********************************************************************
+    size_t maxFree = 0;
+    for (size_t i = actChunk; i < chunks.size(); i++) {
+        const size_t rest = chunks[i].size - (i == actChunk ? actOffset : 0);
+        if (rest > maxFree)
+            maxFree = rest;
+    }
+    if (bytes <= maxFree)
+        return;
+    addChunk(bytes > minChunkSize ? bytes : minChunkSize);
+    actChunk = chunks.size() - 1;
+    actOffset = 0;
+}
+
+
+//***********************************************************************
+void AlignedArena::reset() {
+//***********************************************************************
+    if (chunks.size() > 1) { // merging, so the next round fits in one chunk
+        size_t total = getReservedBytes();
+        release();
+        addChunk(total);
+    }
+    actChunk = 0;
+    actOffset = 0;
+    usedBytes = 0;
+}
+
+
+//***********************************************************************
+void AlignedArena::release() noexcept {
+//***********************************************************************
+    for (auto& chunk : chunks) {
+        if (isFileBacked)
+            unmapScratchFile(chunk.data, chunk.size, chunk.file, chunk.mapping);
+        else
+            ::operator delete(chunk.data, std::align_val_t{ alignment });
+    }
+    chunks.clear();
+    actChunk = 0;
+    actOffset = 0;
+    usedBytes = 0;
+}
+
+
+//***********************************************************************
+void AlignedArena::setFileBacked(bool isFileBacked_) {
+//***********************************************************************
+    if (isFileBacked == isFileBacked_)
+        return;
+    release();
+    isFileBacked = isFileBacked_;
+}
+
+
+//***********************************************************************
+static size_t getPageSize() noexcept {
+//***********************************************************************
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+
+//***********************************************************************
+void AlignedArena::evict(const void* p, size_t bytes) noexcept {
+// only the whole pages inside the block, the neighbouring blocks can be in use
+//***********************************************************************
+    static const size_t pageSize = getPageSize();
+    const size_t begin = ((size_t)p + pageSize - 1) & ~(pageSize - 1);
+    const size_t end = ((size_t)p + bytes) & ~(pageSize - 1);
+    if (p == nullptr || end <= begin)
+        return;
+#ifdef _WIN32
+    VirtualUnlock((void*)begin, end - begin); // on unlocked pages: removes them from the working set
+#else
+#ifdef MADV_PAGEOUT
+    if (madvise((void*)begin, end - begin, MADV_PAGEOUT) == 0)
+        return;
+#endif
+    madvise((void*)begin, end - begin, MADV_DONTNEED); // shared mapping: the pages stay in the file
+#endif
+}
+
+
+//***********************************************************************
+void AlignedArena::prefetch(const void* p, size_t bytes) noexcept {
+//***********************************************************************
+    static const size_t pageSize = getPageSize();
+    const size_t begin = (size_t)p & ~(pageSize - 1);
+    const size_t end = ((size_t)p + bytes + pageSize - 1) & ~(pageSize - 1);
+    if (p == nullptr || end <= begin)
+        return;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range{ (void*)begin, end - begin };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise((void*)begin, end - begin, MADV_WILLNEED);
+#endif
+}
+
+
+//***********************************************************************
+size_t AlignedArena::getReservedBytes() const noexcept {
+//***********************************************************************
+    size_t sum = 0;
+    for (const auto& chunk : chunks)
+        sum += chunk.size;
+    return sum;
+}
+
+
+}
@@ -0,0 +1,91 @@
+//***********************************************************************
+// HexMG Aligned Arena Header
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_ARENA_HEADER
+#define	HMG_ARENA_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include <cstddef>
+#include <memory>
+#include <vector>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+class AlignedArena {
+// Bump allocator for vektor storage, every block is 64-byte aligned.
+// The blocks are not freed one by one: reset() frees everything at once but keeps the memory
+// for the next round (merged into one chunk), release() gives the memory back to the system.
+// The vektors allocated from the arena do not free their storage, so they must be cleared or
+// destroyed before reset() / release(). Not thread safe.
+// A file backed arena maps its chunks from scratch files of the temp directory (deleted when released),
+// so the OS can write the blocks to the file and drop them from the memory instead of the swap.
+//***********************************************************************
+    struct Chunk {
+        std::byte* data = nullptr;
+        size_t size = 0;
+        void* file = nullptr;       // file backed on Windows: the file and the file mapping handles
+        void* mapping = nullptr;
+    };
+    std::vector<Chunk> chunks;
+    size_t actChunk = 0;        // the allocation continues in chunks[actChunk]...
+    size_t actOffset = 0;       // ...from this byte
+    size_t usedBytes = 0;       // since the last reset
+    size_t nChunkAllocations = 0;
+    bool isFileBacked = false;
+    //***********************************************************************
+    void addChunk(size_t size);
+    //***********************************************************************
+    AlignedArena(const AlignedArena&) = delete;
+    void operator=(const AlignedArena&) = delete;
+    //***********************************************************************
+public:
+    //***********************************************************************
+    static constexpr size_t alignment = 64;
+    static constexpr size_t minChunkSize = 64 * 1024;
+    //***********************************************************************
+    AlignedArena() = default;
+    ~AlignedArena() { release(); }
+    //***********************************************************************
+    void* allocate(size_t bytes); // nullptr if bytes == 0
+    //***********************************************************************
+    template<typename T> T* allocate_array(size_t n) {
+    // default initialized like new T[n]
+    //***********************************************************************
+        T* p = static_cast<T*>(allocate(n * sizeof(T)));
+        if (p != nullptr)
+            std::uninitialized_default_construct_n(p, n);
+        return p;
+    }
+    //***********************************************************************
+    void reserve(size_t bytes); // the next allocations of bytes (with the alignment) need no new chunk
+    void reset();
+    void release() noexcept;
+    void setFileBacked(bool isFileBacked_); // releases the memory if changed
+    //***********************************************************************
+    // hints for the blocks of a file backed arena, the content is kept
+    static void evict(const void* p, size_t bytes) noexcept;    // write to the file, drop from the memory
+    static void prefetch(const void* p, size_t bytes) noexcept; // start reading from the file
+    //***********************************************************************
+    size_t getUsedBytes() const noexcept { return usedBytes; }
+    size_t getReservedBytes() const noexcept;
+    size_t getNChunkAllocations() const noexcept { return nChunkAllocations; } // does not grow after warm-up
+    //***********************************************************************
+};
+
+
+}
+
+#endif
@@ -0,0 +1,577 @@
+//***********************************************************************
+// HexMG Benchmark CPP
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgBenchmark.h"
+#include "hmgCommon.h"
+#include "hmgMatrix.hpp"
+#include "hmgMatrixFixed.hpp"
+#include "hmgThreadPool.h"
+#include <random>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+using benchClock = std::chrono::high_resolution_clock;
+//***********************************************************************
+
+
+//***********************************************************************
+static void fillRandom(matrix<rvt>& m, std::mt19937& gen) {
+//***********************************************************************
+    std::uniform_real_distribution<rvt> dist(-1.0, 1.0);
+    for (uns i = 0; i < m.get_row(); i++)
+        for (uns j = 0; j < m.get_col(); j++)
+            m[i][j] = dist(gen);
+}
+
+
+//***********************************************************************
+static void fillRandom(matrix<cplx>& m, std::mt19937& gen) {
+//***********************************************************************
+    std::uniform_real_distribution<rvt> dist(-1.0, 1.0);
+    for (uns i = 0; i < m.get_row(); i++)
+        for (uns j = 0; j < m.get_col(); j++)
+            m[i][j] = cplx(dist(gen), dist(gen));
+}
+
+
+//***********************************************************************
+template<typename T>
+static rvt maxAbsDiff(const matrix<T>& m1, const matrix<T>& m2) {
+//***********************************************************************
+    rvt diff = rvt0;
+    for (uns i = 0; i < m1.get_row(); i++)
+        for (uns j = m1.get_is_symm() ? i : 0; j < m1.get_col(); j++)
+            diff = std::max(diff, std::abs(m1[i][j] - m2[i][j]));
+    return diff;
+}
+
+
+//***********************************************************************
+template<typename Op>
+static rvt measureGFlops(Op op, rvt flopPerCall) {
+// repeats op for at least 0.2 s, a longer op is measured by its warm-up call
+//***********************************************************************
+    const auto warmUp = benchClock::now();
+    op();
+    crvt warmUpTime = std::chrono::duration<rvt>(benchClock::now() - warmUp).count();
+    if (warmUpTime >= 0.2)
+        return flopPerCall / warmUpTime * 1.0e-9;
+    siz reps = 0;
+    rvt elapsed = rvt0;
+    const auto start = benchClock::now();
+    do {
+        for (uns i = 0; i < 8; i++)
+            op();
+        reps += 8;
+        elapsed = std::chrono::duration<rvt>(benchClock::now() - start).count();
+    } while (elapsed < 0.2);
+    return flopPerCall * reps / elapsed * 1.0e-9;
+}
+
+
+//***********************************************************************
+static void benchmarkMulT() {
+// GFLOP/s of the math_mul_t family for every kernel level the CPU supports,
+// and the max. difference from the scalar kernel
+//***********************************************************************
+    const uns sizes[] = { 4, 8, 16, 32, 64, 128, 256, 512 };
+    const KernelLevel originalLevel = MatrixKernels::getLevel();
+    std::mt19937 gen(1234);
+
+    printf("%-8s %5s %10s %10s %12s %12s %12s %10s\n", "kernel", "n", "mul_t", "nmul_t", "add_mul_t", "sub_mul_t", "add_symm", "max diff");
+    for (uns n : sizes) {
+        matrix<rvt> a, b_t, c, d, ref, symm, symmRef, symmC;
+        a.set_size(n, n);
+        b_t.set_size(n, n);
+        c.set_size(n, n);
+        d.set_size(n, n);
+        ref.set_size(n, n);
+        symm.set_size_symm(n);
+        symmRef.set_size_symm(n);
+        symmC.set_size_symm(n);
+        fillRandom(a, gen);
+        fillRandom(b_t, gen);
+        fillRandom(c, gen);
+        for (uns i = 0; i < n; i++)
+            for (uns j = i; j < n; j++)
+                symmC[i][j] = c[i][j];
+
+        MatrixKernels::setLevel(klScalar);
+        ref.math_add_mul_t_unsafe(c, a, b_t);
+        symmRef.math_add_mul_t_symm(symmC, a, b_t);
+
+        const rvt flop = 2.0 * n * n * n;
+        for (uns level = klScalar; level <= MatrixKernels::getMaxLevel(); level++) {
+            MatrixKernels::setLevel(KernelLevel(level));
+
+            d.math_add_mul_t_unsafe(c, a, b_t);
+            symm.math_add_mul_t_symm(symmC, a, b_t);
+            rvt diff = maxAbsDiff(d, ref);
+            for (uns i = 0; i < n; i++)
+                for (uns j = i; j < n; j++)
+                    diff = std::max(diff, std::abs(symm[i][j] - symmRef[i][j]));
+
+            crvt gMul  = measureGFlops([&]() { d.math_mul_t_unsafe(a, b_t); }, flop);
+            crvt gNMul = measureGFlops([&]() { d.math_nmul_t_safe(a, b_t); }, flop);
+            crvt gAdd  = measureGFlops([&]() { d.math_add_mul_t_unsafe(c, a, b_t); }, flop);
+            crvt gSub  = measureGFlops([&]() { d.math_sub_mul_t_safe(c, a, b_t); }, flop);
+            crvt gSymm = measureGFlops([&]() { symm.math_add_mul_t_symm(symmC, a, b_t); }, 0.5 * flop);
+            printf("%-8s %5u %10.3f %10.3f %12.3f %12.3f %12.3f %10.3g\n", MatrixKernels::getLevelName(KernelLevel(level)), n, gMul, gNMul, gAdd, gSub, gSymm, diff);
+        }
+    }
+    MatrixKernels::setLevel(originalLevel);
+}
+
+
+//***********************************************************************
+static void benchmarkComplex() {
+// matrix<cplx> kernels used by the AC and time constant analyses, "generic" is
+// the reference std::complex loop, ninv_np error is max|A * inv(A) - I|
+//***********************************************************************
+    const uns sizes[] = { 4, 8, 16, 32, 64, 128, 256 };
+    const KernelLevel originalLevel = MatrixKernels::getLevel();
+    std::mt19937 gen(1234);
+
+    printf("%-8s %5s %10s %12s %10s %10s %10s\n", "kernel", "n", "mul_t", "sub_mul_t", "ninv_np", "max diff", "inv error");
+    for (uns n : sizes) {
+        matrix<cplx> a, b_t, c, d, ref, y, inv;
+        a.set_size(n, n);
+        b_t.set_size(n, n);
+        c.set_size(n, n);
+        d.set_size(n, n);
+        ref.set_size(n, n);
+        y.set_size(n, n);
+        inv.set_size(n, n);
+        fillRandom(a, gen);
+        fillRandom(b_t, gen);
+        fillRandom(c, gen);
+        fillRandom(y, gen);
+        for (uns i = 0; i < n; i++)
+            y[i][i] += cplx(n, 0.5 * n); // diagonally dominant, as the admittance matrices
+
+        auto generic = [&]() {
+            for (uns i = 0; i < n; i++)
+                for (uns j = 0; j < n; j++) {
+                    cplx sum = cplx0;
+                    for (uns k = 0; k < n; k++)
+                        sum += a[i][k] * b_t[j][k];
+                    ref[i][j] = c[i][j] - sum;
+                }
+        };
+        generic();
+        const rvt flop = 8.0 * n * n * n;
+        printf("%-8s %5u %10s %12.3f\n", "generic", n, "", measureGFlops(generic, flop));
+
+        for (uns level = klScalar; level <= MatrixKernels::getMaxLevel(); level++) {
+            MatrixKernels::setLevel(KernelLevel(level));
+
+            d.math_sub_mul_t_safe(c, a, b_t);
+            const rvt diff = maxAbsDiff(d, ref);
+            inv = y;
+            inv.math_ninv_np();
+            rvt invError = rvt0;
+            for (uns i = 0; i < n; i++)
+                for (uns j = 0; j < n; j++) {
+                    cplx sum = cplx0;
+                    for (uns k = 0; k < n; k++)
+                        sum -= y[i][k] * inv[k][j];
+                    invError = std::max(invError, std::abs(sum - (i == j ? cplx(1.0) : cplx0)));
+                }
+
+            crvt gMul  = measureGFlops([&]() { d.math_mul_t_unsafe(a, b_t); }, flop);
+            crvt gSub  = measureGFlops([&]() { d.math_sub_mul_t_safe(c, a, b_t); }, flop);
+            crvt gNinv = measureGFlops([&]() { inv.copy_unsafe(y); inv.math_ninv_np(); }, flop);
+            printf("%-8s %5u %10.3f %12.3f %10.3f %10.3g %10.3g\n", MatrixKernels::getLevelName(KernelLevel(level)), n, gMul, gSub, gNinv, diff, invError);
+        }
+    }
+    MatrixKernels::setLevel(originalLevel);
+}
+
+
+//***********************************************************************
+static void benchmarkSweep() {
+// d = c - a * b_t from 8 to 4096 with the best kernel level: the unpacked SIMD kernel
+// against the packed, cache blocked one, "auto" is the path math_mul_t selects
+//***********************************************************************
+    const uns sizes[] = { 8, 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096 };
+    const KernelLevel originalLevel = MatrixKernels::getLevel();
+    cuns originalMinSize = MatrixKernels::getPackedMinSize();
+    std::mt19937 gen(1234);
+
+    MatrixKernels::setLevel(MatrixKernels::getMaxLevel());
+    printf("kernel: %s, packed from n = %u\n", MatrixKernels::getLevelName(MatrixKernels::getLevel()), originalMinSize);
+    printf("%5s %10s %10s %10s %8s %10s\n", "n", "scalar", "unpacked", "packed", "auto", "max diff");
+    for (uns n : sizes) {
+        matrix<rvt> a, b_t, c, d, ref;
+        a.set_size(n, n);
+        b_t.set_size(n, n);
+        c.set_size(n, n);
+        d.set_size(n, n);
+        ref.set_size(n, n);
+        fillRandom(a, gen);
+        fillRandom(b_t, gen);
+        fillRandom(c, gen);
+        const rvt flop = 2.0 * n * n * n;
+
+        char scalarText[32] = "-";
+        if (n <= 1024) { // the larger ones would take minutes
+            MatrixKernels::setLevel(klScalar);
+            sprintf_s(scalarText, 32, "%.3f", measureGFlops([&]() { d.math_sub_mul_t_safe(c, a, b_t); }, flop));
+            MatrixKernels::setLevel(MatrixKernels::getMaxLevel());
+        }
+
+        MatrixKernels::setPackedMinSize(~0u);
+        crvt gUnpacked = measureGFlops([&]() { ref.math_sub_mul_t_safe(c, a, b_t); }, flop);
+        MatrixKernels::setPackedMinSize(1);
+        crvt gPacked = measureGFlops([&]() { d.math_sub_mul_t_safe(c, a, b_t); }, flop);
+        MatrixKernels::setPackedMinSize(originalMinSize);
+
+        printf("%5u %10s %10.3f %10.3f %8s %10.3g\n", n, scalarText, gUnpacked, gPacked,
+            MatrixKernels::isPackedSize(n, n, n) ? "packed" : "unpacked", maxAbsDiff(d, ref));
+    }
+    MatrixKernels::setLevel(originalLevel);
+}
+
+
+//***********************************************************************
+static void benchmarkInversion() {
+// math_ninv_np and math_inv_p with 1...64 threads, "serial" is the unblocked single threaded
+// math_ninv_np, the speedups are relative to 1 thread, max diff is from the serial result
+//***********************************************************************
+    const uns sizes[] = { 256, 512, 1024, 2048 };
+    const uns threads[] = { 1, 2, 4, 8, 16, 32, 64 };
+    cuns originalMinSize = MatrixKernels::getBlockedInvMinSize();
+    ThreadPool& pool = ThreadPool::getInstance();
+    cuns originalThreads = pool.getNThreads();
+    std::mt19937 gen(1234);
+
+    printf("%5s %8s %10s %8s %10s %8s %10s\n", "n", "threads", "ninv_np", "speedup", "inv_p", "speedup", "max diff");
+    for (uns n : sizes) {
+        matrix<rvt> y, ref, inv;
+        y.set_size(n, n);
+        ref.set_size(n, n);
+        inv.set_size(n, n);
+        fillRandom(y, gen);
+        for (uns i = 0; i < n; i++)
+            y[i][i] += n; // diagonally dominant, as the admittance matrices
+        const rvt flop = 2.0 * n * n * n;
+
+        MatrixKernels::setBlockedInvMinSize(~0u);
+        crvt gSerial = measureGFlops([&]() { ref.copy_unsafe(y); ref.math_ninv_np(); }, flop);
+        MatrixKernels::setBlockedInvMinSize(originalMinSize);
+        printf("%5u %8s %10.3f\n", n, "serial", gSerial);
+
+        rvt gNinv1 = rvt0, gInvP1 = rvt0;
+        for (uns nThreads : threads) {
+            pool.setNThreads(nThreads);
+            crvt gNinv = measureGFlops([&]() { inv.copy_unsafe(y); inv.math_ninv_np(); }, flop);
+            rvt diff = maxAbsDiff(inv, ref);
+            char invPText[2][32] = { "-", "-" };
+            if (n <= 1024) { // the unblocked pivoting would take minutes
+                crvt gInvP = measureGFlops([&]() { inv.copy_unsafe(y); inv.math_inv_p(true); }, flop);
+                diff = std::max(diff, maxAbsDiff(inv, ref));
+                if (nThreads == 1)
+                    gInvP1 = gInvP;
+                sprintf_s(invPText[0], 32, "%.3f", gInvP);
+                sprintf_s(invPText[1], 32, "%.2f", gInvP / gInvP1);
+            }
+            if (nThreads == 1)
+                gNinv1 = gNinv;
+            printf("%5u %8u %10.3f %8.2f %10s %8s %10.3g\n", n, nThreads, gNinv, gNinv / gNinv1, invPText[0], invPText[1], diff);
+        }
+    }
+    pool.setNThreads(originalThreads);
+}
+
+
+//***********************************************************************
+static void benchmarkMixedPrecision() {
+// A SUNRED merge sized reduction (n internal and n / 4 external nodes) in double and with
+// MixedPrecisionReduction (GFLOP/s), and the relative error of the solution of YB * x = b
+// with the float accurate LDLT factor after 0...3 refinement steps (double residuals)
+//***********************************************************************
+    const uns sizes[] = { 128, 256, 512, 1024 };
+    std::mt19937 gen(1234);
+
+    printf("%5s %10s %10s %8s %10s %10s %8s %10s %10s %10s %10s\n", "n", "symm dbl", "symm flt", "speedup",
+        "nsymm dbl", "nsymm flt", "speedup", "err 0", "err 1", "err 2", "err 3");
+    for (uns n : sizes) {
+        cuns m = n / 4;
+        matrix<rvt> full, yb, ya, yaFull, xb, xat, nzb, z, yred, yredFull, ldltDouble;
+        full.set_size(n, n);
+        fillRandom(full, gen);
+        for (uns i = 0; i < n; i++) {
+            full[i][i] += n; // diagonally dominant, as the admittance matrices
+            for (uns j = 0; j < i; j++)
+                full[i][j] = full[j][i];
+        }
+        yb.set_size_symm(n);
+        for (uns i = 0; i < n; i++)
+            for (uns j = i; j < n; j++)
+                yb[i][j] = full[i][j];
+        yaFull.set_size(m, m);
+        fillRandom(yaFull, gen);
+        ya.set_size_symm(m);
+        for (uns i = 0; i < m; i++)
+            for (uns j = i; j < m; j++)
+                ya[i][j] = yaFull[i][j];
+        xb.set_size(m, n);
+        xat.set_size(m, n);
+        fillRandom(xb, gen);
+        fillRandom(xat, gen);
+        nzb.set_size(n, n);
+        z.set_size(m, n);
+        yred.set_size_symm(m);
+        yredFull.set_size(m, m);
+        ldltDouble.set_size_symm(n);
+
+        crvt symmFlop = n * (rvt)n * n / 3.0 + 2.0 * m * n * n + (rvt)m * m * n;
+        crvt nonSymmFlop = 2.0 * n * n * n + 4.0 * m * n * n;
+        crvt gSymmDouble = measureGFlops([&]() {
+            ldltDouble.copy_unsafe(yb);
+            ldltDouble.math_symm_ldlt();
+            z.math_ldlt_solve_rows(ldltDouble, xb);
+            yred.math_sub_mul_ldlt_symm(ya, z, ldltDouble);
+        }, symmFlop);
+        crvt gNonSymmDouble = measureGFlops([&]() {
+            nzb.copy_unsafe(full);
+            nzb.math_ninv_np();
+            z.math_mul_t_unsafe(xat, nzb);
+            yredFull.math_add_mul_t_unsafe(yaFull, xb, z);
+        }, nonSymmFlop);
+        matrix<rvt> ldltFloat;
+        ldltFloat.set_size_symm(n);
+        crvt gSymmFloat = measureGFlops([&]() {
+            ldltFloat.copy_unsafe(yb);
+            MixedPrecisionReduction::reduceSymm(ldltFloat, z, yred, ya, xb);
+        }, symmFlop);
+        crvt gNonSymmFloat = measureGFlops([&]() {
+            nzb.copy_unsafe(full);
+            MixedPrecisionReduction::reduceNonSymm(nzb, z, yredFull, yaFull, xat, xb);
+        }, nonSymmFlop);
+
+        // refinement: x -= YB_float^-1 * (YB * x - b)
+
+        vektor<rvt> b, x, xRef, r, dx;
+        b.set_size(n);
+        x.set_size_and_zero(n);
+        xRef.set_size(n);
+        r.set_size(n);
+        dx.set_size(n);
+        std::uniform_real_distribution<rvt> dist(-1.0, 1.0);
+        for (uns i = 0; i < n; i++)
+            r[i] = b[i] = dist(gen);
+        math_ldlt_nsolve(xRef, ldltDouble, b); // -x
+        rvt xMax = rvt0;
+        for (uns i = 0; i < n; i++)
+            xMax = std::max(xMax, std::abs(xRef[i]));
+        rvt err[4] = { rvt0 };
+        for (uns step = 0; step < 4; step++) {
+            math_ldlt_nsolve(dx, ldltFloat, r);
+            rvt diff = rvt0;
+            for (uns i = 0; i < n; i++) {
+                x[i] -= dx[i];
+                diff = std::max(diff, std::abs(x[i] + xRef[i]));
+            }
+            err[step] = diff / xMax;
+            for (uns i = 0; i < n; i++) {
+                rvt sum = b[i];
+                for (uns j = 0; j < n; j++)
+                    sum -= full[i][j] * x[j];
+                r[i] = sum;
+            }
+        }
+        printf("%5u %10.3f %10.3f %8.2f %10.3f %10.3f %8.2f %10.3g %10.3g %10.3g %10.3g\n", n, gSymmDouble, gSymmFloat, gSymmFloat / gSymmDouble,
+            gNonSymmDouble, gNonSymmFloat, gNonSymmFloat / gNonSymmDouble, err[0], err[1], err[2], err[3]);
+    }
+}
+
+
+//***********************************************************************
+static void benchmarkFixedSize() {
+// The SUNRED reduction of the lowest levels (n = 3...8 internal and 2n external nodes) with the
+// general matrix functions and with the matrix_fixed kernels (GFLOP/s), max diff is of YRED
+//***********************************************************************
+    std::mt19937 gen(1234);
+
+    printf("%5s %5s %10s %10s %8s %10s %10s %10s %8s %10s\n", "n", "m", "symm gen", "symm fix", "speedup", "diff",
+        "nsymm gen", "nsymm fix", "speedup", "diff");
+    for (uns n = 3; n <= matrixFixedMaxSize; n++) {
+        cuns m = 2 * n;
+        matrix<rvt> full, yb, ya, yaFull, xb, xat, nzb, nzbxa, z, yred, yredFull, ldlt, yredFix, yredFullFix;
+        full.set_size(n, n);
+        fillRandom(full, gen);
+        for (uns i = 0; i < n; i++) {
+            full[i][i] += n; // diagonally dominant, as the admittance matrices
+            for (uns j = 0; j < i; j++)
+                full[i][j] = full[j][i];
+        }
+        yb.set_size_symm(n);
+        for (uns i = 0; i < n; i++)
+            for (uns j = i; j < n; j++)
+                yb[i][j] = full[i][j];
+        yaFull.set_size(m, m);
+        fillRandom(yaFull, gen);
+        ya.set_size_symm(m);
+        for (uns i = 0; i < m; i++)
+            for (uns j = i; j < m; j++)
+                ya[i][j] = yaFull[i][j];
+        xb.set_size(m, n);
+        xat.set_size(m, n);
+        fillRandom(xb, gen);
+        fillRandom(xat, gen);
+        nzb.set_size(n, n);
+        nzbxa.set_size(n, m);
+        z.set_size(m, n);
+        yred.set_size_symm(m);
+        yredFix.set_size_symm(m);
+        yredFull.set_size(m, m);
+        yredFullFix.set_size(m, m);
+        ldlt.set_size_symm(n);
+
+        crvt symmFlop = n * (rvt)n * n / 3.0 + (rvt)m * n * n + (rvt)m * m * n;
+        crvt nonSymmFlop = 2.0 * n * n * n + 2.0 * m * n * n + 2.0 * m * m * n;
+        crvt gSymmGeneral = measureGFlops([&]() {
+            ldlt.copy_unsafe(yb);
+            ldlt.math_symm_ldlt();
+            z.math_ldlt_solve_rows(ldlt, xb);
+            yred.math_sub_mul_ldlt_symm(ya, z, ldlt);
+        }, symmFlop);
+        crvt gSymmFixed = measureGFlops([&]() {
+            ldlt.copy_unsafe(yb);
+            yredFix.copy_unsafe(ya);
+            math_fixed_reduce_symm(n, ldlt, z, yredFix, xb);
+        }, symmFlop);
+        crvt gNonSymmGeneral = measureGFlops([&]() {
+            nzb.copy_unsafe(full);
+            nzb.math_ninv_np();
+            nzbxa.math_mul_t_unsafe(nzb, xat);
+            z.transp(nzbxa);
+            yredFull.math_add_mul_t_unsafe(yaFull, xb, z);
+        }, nonSymmFlop);
+        crvt gNonSymmFixed = measureGFlops([&]() {
+            nzb.copy_unsafe(full);
+            yredFullFix.copy_unsafe(yaFull);
+            math_fixed_reduce_nonsymm(n, nzb, nzbxa, z, yredFullFix, xat, xb);
+        }, nonSymmFlop);
+        printf("%5u %5u %10.3f %10.3f %8.2f %10.3g %10.3f %10.3f %8.2f %10.3g\n", n, m, gSymmGeneral, gSymmFixed, gSymmFixed / gSymmGeneral,
+            maxAbsDiff(yredFix, yred), gNonSymmGeneral, gNonSymmFixed, gNonSymmFixed / gNonSymmGeneral, maxAbsDiff(yredFullFix, yredFull));
+    }
+}
+
+
+//***********************************************************************
+static void benchmarkTopNode() {
+// The reduction of a SUNRED root sized node (n internal and n / 2 external nodes), symmetrical (LDLT)
+// and nonsymmetrical (inversion), with 1...64 threads: the top levels of the tree have fewer nodes
+// than threads, these nodes run on all threads inside. Speedups are relative to 1 thread.
+//***********************************************************************
+    const uns sizes[] = { 256, 512, 1024 };
+    const uns threads[] = { 1, 2, 4, 8, 16, 32, 64 };
+    ThreadPool& pool = ThreadPool::getInstance();
+    cuns originalThreads = pool.getNThreads();
+    std::mt19937 gen(1234);
+
+    printf("%5s %8s %10s %8s %10s %8s %10s\n", "n", "threads", "symm", "speedup", "nonsymm", "speedup", "max diff");
+    for (uns n : sizes) {
+        cuns m = n / 2;
+        matrix<rvt> full, yb, ya, yaFull, xb, xat, nzb, nzbxa, z, yred, yredRef, yredFull, yredFullRef, ldlt;
+        full.set_size(n, n);
+        fillRandom(full, gen);
+        for (uns i = 0; i < n; i++) {
+            full[i][i] += n; // diagonally dominant, as the admittance matrices
+            for (uns j = 0; j < i; j++)
+                full[i][j] = full[j][i];
+        }
+        yb.set_size_symm(n);
+        for (uns i = 0; i < n; i++)
+            for (uns j = i; j < n; j++)
+                yb[i][j] = full[i][j];
+        yaFull.set_size(m, m);
+        fillRandom(yaFull, gen);
+        ya.set_size_symm(m);
+        for (uns i = 0; i < m; i++)
+            for (uns j = i; j < m; j++)
+                ya[i][j] = yaFull[i][j];
+        xb.set_size(m, n);
+        xat.set_size(m, n);
+        fillRandom(xb, gen);
+        fillRandom(xat, gen);
+        nzb.set_size(n, n);
+        nzbxa.set_size(m, n);
+        z.set_size(m, n);
+        yred.set_size_symm(m);
+        yredRef.set_size_symm(m);
+        yredFull.set_size(m, m);
+        yredFullRef.set_size(m, m);
+        ldlt.set_size_symm(n);
+
+        crvt symmFlop = n * (rvt)n * n / 3.0 + (rvt)m * n * n + (rvt)m * m * n;
+        crvt nonSymmFlop = 2.0 * n * n * n + 2.0 * m * n * n + 2.0 * m * m * n;
+        auto reduceSymm = [&]() {
+            ldlt.copy_unsafe(yb);
+            ldlt.math_symm_ldlt();
+            z.math_ldlt_solve_rows(ldlt, xb);
+            yred.math_sub_mul_ldlt_symm(ya, z, ldlt);
+        };
+        auto reduceNonSymm = [&]() { // the steps of SunredTreeNode::forwsubsDC
+            nzb.copy_unsafe(full);
+            nzb.math_ninv_np();
+            nzbxa.math_mul_t_unsafe(xat, nzb);
+            yredFull.math_add_mul_t_unsafe(yaFull, xb, nzbxa);
+        };
+
+        rvt gSymm1 = rvt0, gNonSymm1 = rvt0;
+        for (uns nThreads : threads) {
+            pool.setNThreads(nThreads);
+            crvt gSymm = measureGFlops(reduceSymm, symmFlop);
+            crvt gNonSymm = measureGFlops(reduceNonSymm, nonSymmFlop);
+            if (nThreads == 1) {
+                gSymm1 = gSymm;
+                gNonSymm1 = gNonSymm;
+                yredRef.copy_unsafe(yred);
+                yredFullRef.copy_unsafe(yredFull);
+            }
+            crvt diff = std::max(maxAbsDiff(yred, yredRef), maxAbsDiff(yredFull, yredFullRef));
+            printf("%5u %8u %10.3f %8.2f %10.3f %8.2f %10.3g\n", n, nThreads, gSymm, gSymm / gSymm1, gNonSymm, gNonSymm / gNonSymm1, diff);
+        }
+    }
+    pool.setNThreads(originalThreads);
+}
+
+
+//***********************************************************************
+void runBenchmark(int n, const char** params) {
+//***********************************************************************
+    const char* name = n > 0 ? params[0] : "mul_t";
+    if (strcmp(name, "mul_t") == 0)
+        benchmarkMulT();
+    else if (strcmp(name, "complex") == 0)
+        benchmarkComplex();
+    else if (strcmp(name, "sweep") == 0)
+        benchmarkSweep();
+    else if (strcmp(name, "inv") == 0)
+        benchmarkInversion();
+    else if (strcmp(name, "mixed") == 0)
+        benchmarkMixedPrecision();
+    else if (strcmp(name, "fixed") == 0)
+        benchmarkFixedSize();
+    else if (strcmp(name, "topnode") == 0)
+        benchmarkTopNode();
+    else
+        throw hmgExcept("runBenchmark", "unknown benchmark: %s (known: mul_t, complex, sweep, inv, mixed, fixed, topnode)", name);
+}
+
+
+}
@@ -0,0 +1,27 @@
+//***********************************************************************
+// HexMG Benchmark Header
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_BENCHMARK_HEADER
+#define	HMG_BENCHMARK_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+// hexmg -bench <name>, see the benchmark list in hmgBenchmark.cpp
+void runBenchmark(int n, const char** params);
+//***********************************************************************
+
+
+}
+
+#endif
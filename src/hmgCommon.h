@@ -91,7 +91,8 @@ struct DefaultNodeParameter {
 
 
 //***********************************************************************
-enum SolutionType { stFullMatrix, stSunRed }; // , stMultiGrid
+enum SolutionType { stFullMatrix, stSunRed, stSparse }; // , stMultiGrid
+inline constexpr uns autoSunredTreeIndex = ~0u; // SUNRED=AUTO: the tree is built from the netlist (SunredTreeBuilder)
 //***********************************************************************
 
 
@@ -385,6 +386,7 @@ struct RunData {
     bool isDT = false;  // TIMESTEP: T or DT
     bool isTau = false; // fTau is f or tau (f=1/(2*PI*TAU))
     bool isMultigrid = false;
+    bool isFloat = false; // mixed precision: DC reductions in float, refined by the DC iteration in double
     uns iterNumSPD = 0; // DC/TIMESTEP: number of iteration steps, if 0 => until convergence; TIMECONST: STEP PER DECADE
     rvt err = 0.0001;
     rvt fTauDtT = 1;
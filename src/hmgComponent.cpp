@@ -8,6 +8,9 @@
 //***********************************************************************
 #include "hmgComponent.h"
 #include "hmgMultigrid.hpp"
+#include <bit>
+#include <mutex>
+#include <unordered_map>
 //***********************************************************************
 
 
@@ -27,6 +30,8 @@ void ComponentSubCircuit::forwsubsDC() {
         sfmrDC->forwsubs();
     else if (model.solutionType == SolutionType::stSunRed)
         sunred.forwsubsDC();
+    else if (model.solutionType == SolutionType::stSparse)
+        ssrDC->forwsubs();
 }
 
 
@@ -40,6 +45,8 @@ void ComponentSubCircuit::backsubsDC() {
         sfmrDC->backsubs();
     else if (model.solutionType == SolutionType::stSunRed)
         sunred.backsubsDC();
+    else if (model.solutionType == SolutionType::stSparse)
+        ssrDC->backsubs();
     for (auto& comp : components)
         if (comp->isEnabled) comp->backsubs(true);
 }
@@ -56,6 +63,8 @@ void ComponentSubCircuit::forwsubsAC() {
         sfmrAC->forwsubs();
     else if (model.solutionType == SolutionType::stSunRed)
         sunred.forwsubsAC();
+    else if (model.solutionType == SolutionType::stSparse)
+        ssrAC->forwsubs();
 }
 
 
@@ -69,6 +78,8 @@ void ComponentSubCircuit::backsubsAC() {
         sfmrAC->backsubs();
     else if (model.solutionType == SolutionType::stSunRed)
         sunred.backsubsAC();
+    else if (model.solutionType == SolutionType::stSparse)
+        ssrAC->backsubs();
     for (auto& comp : components)
         if (comp->isEnabled) comp->backsubs(false);
 }
@@ -351,24 +362,25 @@ bool CircuitStorage::processInstructions(IsInstruction*& first) {
                 break;
             case sitDefModelSubcircuit: {
                     IsDefModelSubcircuitInstruction* pAct = static_cast<IsDefModelSubcircuitInstruction*>(act);
+                    reductionCache.eraseModel(pAct->index); // the reductions of the previous definition
                     
                     if (pAct->isReplace) {
                         ModelSubCircuit* ms = static_cast<ModelSubCircuit*>(models[pAct->index].get());
                         uns version = ms->version + 1;
-                        models[pAct->index] = std::make_unique<ModelSubCircuit>(ms->externalNs, ms->internalNs, ms->solutionType != SolutionType::stFullMatrix, ms->solutionType, ms->srTreeInstructions);
+                        models[pAct->index] = std::make_unique<ModelSubCircuit>(ms->externalNs, ms->internalNs, ms->solutionType == SolutionType::stSunRed, ms->solutionType, ms->srTreeInstructions);
                         ms = static_cast<ModelSubCircuit*>(models[pAct->index].get());
                         ms->version = version;
                     }
                     else {
                         if (pAct->index == models.size()) {
                             models.push_back(std::make_unique<ModelSubCircuit>(pAct->externalNs, pAct->internalNs,
-                                pAct->solutionType != SolutionType::stFullMatrix, pAct->solutionType, pAct->solutionType == SolutionType::stSunRed ? sunredTrees[pAct->solutionDescriptionIndex].get() : nullptr));
+                                pAct->solutionType == SolutionType::stSunRed, pAct->solutionType, pAct->solutionType == SolutionType::stSunRed && pAct->solutionDescriptionIndex != autoSunredTreeIndex ? sunredTrees[pAct->solutionDescriptionIndex].get() : nullptr));
                         }
                         else {
                             if (pAct->index > models.size())
                                 models.resize(pAct->index + 1);
                             models[pAct->index] = std::make_unique<ModelSubCircuit>(pAct->externalNs, pAct->internalNs,
-                                pAct->solutionType != SolutionType::stFullMatrix, pAct->solutionType, pAct->solutionType == SolutionType::stSunRed ? sunredTrees[pAct->solutionDescriptionIndex].get() : nullptr);
+                                pAct->solutionType == SolutionType::stSunRed, pAct->solutionType, pAct->solutionType == SolutionType::stSunRed && pAct->solutionDescriptionIndex != autoSunredTreeIndex ? sunredTrees[pAct->solutionDescriptionIndex].get() : nullptr);
                         }
                     }
 
@@ -1598,20 +1610,87 @@ void CircuitStorage::processFunctionInstructions(IsInstruction*& first, uns func
 }
 
 
+//***********************************************************************
+void ComponentSubCircuit::setNodesToComponents() {
+// parallel counting sort: the connections of the nodes are counted, the lists are allocated and filled,
+// then sorted, so the components are in increasing order in the lists as they were in a serial loop
+//***********************************************************************
+    cuns nExternal = (uns)pModel->getN_ExternalNodes(); // ONode is possible
+    cuns nInternal = (uns)static_cast<const ModelSubCircuit*>(pModel)->getN_N_Nodes(); // ?? What about ONodes?
+    cuns nComponents = (uns)components.size();
+    externalNodesToComponents.clear();
+    externalNodesToComponents.resize(nExternal);
+    internalNodesToComponents.clear();
+    internalNodesToComponents.resize(nInternal);
+
+    // the slots: internal nodes, then external nodes; ground, var and unconnected nodes ignored
+
+    auto forEachSlot = [&](uns i, auto&& fn) {
+        const auto& nodes = components[i]->def->nodesConnectedTo;
+        for (uns j = 0; j < nodes.size(); j++) {
+            uns slot = ~0u;
+            if (nodes[j].type == CDNodeType::cdntInternal && nodes[j].index < nInternal)
+                slot = nodes[j].index;
+            else if (nodes[j].type == CDNodeType::cdntExternal && nodes[j].index < nExternal)
+                slot = nInternal + nodes[j].index;
+            if (slot == ~0u)
+                continue;
+            bool isFirst = true;
+            for (uns k = 0; k < j && isFirst; k++)
+                isFirst = nodes[k].type != nodes[j].type || nodes[k].index != nodes[j].index;
+            if (isFirst)
+                fn(slot);
+        }
+    };
+    auto list = [&](uns slot) -> std::vector<uns>& { return slot < nInternal ? internalNodesToComponents[slot] : externalNodesToComponents[slot - nInternal]; };
+
+    ThreadPool& pool = ThreadPool::getInstance();
+    auto counts = std::make_unique<std::atomic<uns>[]>(nInternal + nExternal);
+    pool.parallelFor(nComponents, [&](unsigned begin, unsigned end) {
+        for (uns i = begin; i < end; i++)
+            if (components[i]->isEnabled)
+                forEachSlot(i, [&](uns slot) { counts[slot].fetch_add(1, std::memory_order_relaxed); });
+    });
+    pool.parallelFor(nInternal + nExternal, [&](unsigned begin, unsigned end) {
+        for (uns slot = begin; slot < end; slot++) {
+            list(slot).resize(counts[slot].load(std::memory_order_relaxed));
+            counts[slot].store(0, std::memory_order_relaxed);
+        }
+    });
+    pool.parallelFor(nComponents, [&](unsigned begin, unsigned end) {
+        for (uns i = begin; i < end; i++)
+            if (components[i]->isEnabled)
+                forEachSlot(i, [&](uns slot) { list(slot)[counts[slot].fetch_add(1, std::memory_order_relaxed)] = i; });
+    });
+    pool.parallelFor(nInternal + nExternal, [&](unsigned begin, unsigned end) {
+        for (uns slot = begin; slot < end; slot++)
+            std::sort(list(slot).begin(), list(slot).end());
+    });
+}
+
+
 //***********************************************************************
 void ComponentSubCircuit::allocForReductionDC() {
 //***********************************************************************
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
-    if (model.solutionType == SolutionType::stFullMatrix || model.solutionType == SolutionType::stSunRed) {
+    if (model.solutionType == SolutionType::stFullMatrix || model.solutionType == SolutionType::stSunRed || model.solutionType == SolutionType::stSparse) {
         if (model.solutionType == SolutionType::stFullMatrix) {
             if (!sfmrDC)
                 sfmrDC = std::make_unique<SubCircuitFullMatrixReductorDC>(this);
             sfmrDC->alloc();
         }
         else if (model.solutionType == SolutionType::stSunRed) {
-            sunred.buildTree(*model.srTreeInstructions, this);
+            if (model.srTreeInstructions == nullptr) // SUNRED=AUTO
+                sunred.buildAutoTree(this);
+            else
+                sunred.buildTree(*model.srTreeInstructions, this);
             sunred.allocDC();
         }
+        else if (model.solutionType == SolutionType::stSparse) {
+            if (!ssrDC)
+                ssrDC = std::make_unique<SubCircuitSparseReductorDC>(this);
+            ssrDC->alloc();
+        }
     }
 }
 
@@ -1620,7 +1699,7 @@ void ComponentSubCircuit::allocForReductionDC() {
 void ComponentSubCircuit::allocForReductionAC() {
 //***********************************************************************
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
-    if (model.solutionType == SolutionType::stFullMatrix || model.solutionType == SolutionType::stSunRed) {
+    if (model.solutionType == SolutionType::stFullMatrix || model.solutionType == SolutionType::stSunRed || model.solutionType == SolutionType::stSparse) {
         if (model.solutionType == SolutionType::stFullMatrix) {
             if (!sfmrAC)
                 sfmrAC = std::make_unique<SubCircuitFullMatrixReductorAC>(this);
@@ -1629,6 +1708,11 @@ void ComponentSubCircuit::allocForReductionAC() {
         else if (model.solutionType == SolutionType::stSunRed) {
             sunred.allocAC();
         }
+        else if (model.solutionType == SolutionType::stSparse) {
+            if (!ssrAC)
+                ssrAC = std::make_unique<SubCircuitSparseReductorAC>(this);
+            ssrAC->alloc();
+        }
     }
 }
 
@@ -1929,185 +2013,441 @@ void ComponentSubCircuit::buildOrReplace(uns id, uns parentId, uns parentParentI
 
 
 //***********************************************************************
-void SubCircuitFullMatrixReductorDC::forwsubs() {
+void SubCircuitFullMatrixReductorDC::buildStampMap(bool isSymm) {
+// where the admittances and currents of the contained components go, so forwsubs does not
+// need to decide it in every iteration; the disabled components are also mapped
 //***********************************************************************
     ComponentSubCircuit& subckt = *pSubCircuit;
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*subckt.pModel);
-    const bool isSymm = subckt.isJacobianMXSymmetrical(true);
-
-    YAwork.zero_unsafe();
-    XATwork.zero_unsafe();
-    XBwork.zero_unsafe();
-    YBwork.zero_unsafe();
-    JA.zero(); // the defect of the external nodes is addad to the defect of the subckt component's JB so here not used
-    // JB.zero(); // initialized with the defect of the internal nodes
 
-    cuns A1_nIONodes = model.getN_X_Nodes();
-    cuns A2_nNINodes = model.getN_Y_Nodes();
     cuns B1_nNInternalNodes = model.getN_N_Nodes();
     cuns B2_nNONodes = model.getN_O_Nodes();
     cuns ONodes_start = model.getN_Start_Of_O_Nodes();
     cuns NONodes_end = ONodes_start + B2_nNONodes; // end index of normal ONodes
+    cuns nComponents = subckt.getNContainedComponents();
 
-    // defect of the internal nodes
+    admStamps.clear();
+    curStamps.clear();
+    admStart.resize(nComponents + 1);
+    curStart.resize(nComponents + 1);
+    const rvt* const targetData[4] = { YA.kernel_data(), XAT.kernel_data(), XB.kernel_data(), YB.kernel_data() };
 
-    for (uns i = 0; i < B1_nNInternalNodes; i++)
-        JB[i] = -subckt.internalNodesAndVars[i].getDDC(); // JB initialized here
-
-    if (B2_nNONodes != 0) { // some internal nodes are routed out (they are stored among the external nodes)
-        for (uns i = 0; i < B2_nNONodes; i++)
-            JB[B1_nNInternalNodes + i] = -subckt.externalNodes[ONodes_start + i]->getDDC();
-    }
+    for (uns i = 0; i < nComponents; i++) {
+        admStart[i] = (uns)admStamps.size();
+        curStart[i] = (uns)curStamps.size();
+        const ComponentBase& compInstance = *subckt.getContainedComponent(i);
+        const ComponentAndControllerModelBase& compModel = compInstance.getModel();
+        const ComponentDefinition& compDef = *compInstance.def;
+        cuns nIO = compModel.getN_X_Nodes();
+        cuns nAx = nIO + (isSymm ? 0 : compModel.getN_Y_Nodes());
+        for (uns rowSrc = 0; rowSrc < nIO; rowSrc++) {
+
+            // ground connections disappear
+
+            if (compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntRail || compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntGnd || compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntUnconnected)
+                continue;
+
+            // what is the destination?
+            // if normal ONode among the external nodes, it must be handled as an internal node
+
+            bool isA;
+            uns yDest = compDef.nodesConnectedTo[rowSrc].index;
+            if (B2_nNONodes != 0) {
+                if (compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntExternal) {
+                    if (yDest >= ONodes_start && yDest < NONodes_end) { // internal node as normal (=to be reduced) ONode
+                        isA = false; // false: ONode
+                        yDest += B1_nNInternalNodes - ONodes_start;
+                    }
+                    else isA = true;
+                }
+                else isA = false; // false: internal
+            }
+            else isA = compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntExternal; // false: internal
 
-    // admittance + defect of the contained components
+            // J
 
-    for (uns i = 0; i < subckt.getNContainedComponents(); i++) {
-        ComponentBase& compInstance = *const_cast<ComponentBase*>(subckt.getContainedComponent(i));
-        if (compInstance.isEnabled) {
-            const ComponentAndControllerModelBase& compModel = compInstance.getModel();
-            const ComponentDefinition& compDef = *compInstance.def;
-            cuns nIO = compModel.getN_X_Nodes();
-            cuns nAx = nIO + (isSymm ? 0 : compModel.getN_Y_Nodes());
-            for (uns rowSrc = 0; rowSrc < nIO; rowSrc++) {
+            if (yDest >= (isA ? JA.size() : JB.size())) {
+                curStamps.push_back({ rowSrc, isA, unsMax });
+                continue;
+            }
+            curStamps.push_back({ rowSrc, isA, yDest });
 
-                // ground connections disappear
+            // admittances 
 
-                if (compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntRail || compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntGnd || compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntUnconnected)
+            for (uns colSrc = isSymm ? rowSrc : 0; colSrc < nAx; colSrc++) { // in symmetric matrices the admittances should be increased only once(y[i,j] and y[j,i] would be the same)
+                const CDNode& nct = compDef.nodesConnectedTo[colSrc];
+                if (!(nct.type == CDNodeType::cdntInternal || nct.type == CDNodeType::cdntExternal))
                     continue;
 
-                // what is the destination?
-                // if normal ONode among the external nodes, it must be handled as an internal node
+                // INode connected to ControlInternalNode
 
-                bool isA;
-                uns yDest = compDef.nodesConnectedTo[rowSrc].index;
+                if (nct.type == CDNodeType::cdntInternal && nct.index >= B1_nNInternalNodes)
+                    continue;
+
+                bool isUp;
+                uns xDest = nct.index;
                 if (B2_nNONodes != 0) {
-                    if (compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntExternal) {
-                        if (yDest >= ONodes_start && yDest < NONodes_end) { // internal node as normal (=to be reduced) ONode
-                            isA = false; // false: ONode
-                            yDest += B1_nNInternalNodes - ONodes_start;
+                    if (nct.type == CDNodeType::cdntExternal) {
+                        if (xDest >= ONodes_start && xDest < NONodes_end) { // internal node as normal (=to be reduced) ONode
+                            isUp = false; // false: ONode
+                            xDest += B1_nNInternalNodes - ONodes_start;
                         }
-                        else isA = true;
+                        else isUp = true;
                     }
-                    else isA = false; // false: internal
+                    else isUp = false; // false: internal
                 }
-                else isA = compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntExternal; // false: internal
+                else isUp = nct.type == CDNodeType::cdntExternal; // false: internal
 
-                uns externalIndex1 = isA ? yDest : 0;
-                uns internalIndex1 = isA ? 0 : yDest;
-
-                // loading J
+                // the element (isA and isUp are switched, see the J vector: isA is the row, the matrix side is isUp)
 
-                if (isA) {
-                    if (yDest >= JA.size())
-                        throw  hmgExcept("SubCircuitFullMatrixReductorDC::forwsubs", "Connecting a Component Normal node to an external Basic node (A node) is not allowed.");
-                    JA[yDest] += compInstance.getJreducedDC(rowSrc);
+                StampTarget target;
+                const rvt* pElem;
+                if (isUp) {
+                    if (isA) { target = stYA; pElem = &YA.get_elem(yDest, xDest); } // get_elem because yDest > xDest possible
+                    else if (isSymm) { target = stXB; pElem = &XB.get_elem(xDest, yDest); } // (!) in symm case XA is not used, XB is XAT; indices switched
+                    else { target = stXAT; pElem = &XAT.get_elem(xDest, yDest); }
                 }
                 else {
-                    if(yDest>= JB.size())
-                        throw  hmgExcept("SubCircuitFullMatrixReductorDC::forwsubs", "Connecting a Component Normal node to an internal Basic node (B node) is not allowed.");
-                    JB[yDest] += compInstance.getJreducedDC(rowSrc);
+                    if (isA) { target = stXB; pElem = &XB.get_elem(yDest, xDest); }
+                    else { target = stYB; pElem = &YB.get_elem(yDest, xDest); }
                 }
+                admStamps.push_back({ rowSrc, colSrc, target, size_t(pElem - targetData[target]) });
+            }
+        }
+    }
+    admStart[nComponents] = (uns)admStamps.size();
+    curStart[nComponents] = (uns)curStamps.size();
+
+    admValues.assign(admStamps.size(), rvt0);
+    isCacheable = subckt.def->modelType == cmtCustom && isLinear(subckt);
+    compYVersion.assign(nComponents, 0);
+    isCompLoaded.assign(nComponents, 0);
+    isStampMapSymm = isSymm;
+    isLoaded = false;
+
+    // parallel stamping: the elements are distributed among the threads, not the components, so there is no conflict
+
+    scatterOrder.clear();
+    elementStart.clear();
+    curValues.clear();
+    isParallelStamping = nComponents >= parallelMinComponents;
+    if (isParallelStamping) {
+        curValues.resize(curStamps.size());
+        scatterOrder.resize(admStamps.size());
+        for (uns s = 0; s < scatterOrder.size(); s++)
+            scatterOrder[s] = s;
+        auto isBefore = [&](uns a, uns b) {
+            return admStamps[a].target != admStamps[b].target ? admStamps[a].target < admStamps[b].target : admStamps[a].offset < admStamps[b].offset;
+        };
+        std::stable_sort(scatterOrder.begin(), scatterOrder.end(), isBefore);
+        for (uns k = 0; k < scatterOrder.size(); k++)
+            if (k == 0 || isBefore(scatterOrder[k - 1], scatterOrder[k]))
+                elementStart.push_back(k);
+        elementStart.push_back((uns)scatterOrder.size());
+    }
+}
 
-                // admittances 
 
-                for (uns colSrc = isSymm ? rowSrc : 0; colSrc < nAx; colSrc++) { // in symmetric matrices the admittances should be increased only once(y[i,j] and y[j,i] would be the same)
-                    const CDNode& nct = compDef.nodesConnectedTo[colSrc];
-                    if (!(nct.type == CDNodeType::cdntInternal || nct.type == CDNodeType::cdntExternal))
-                        continue;
-                    crvt adm = compInstance.getYDC(rowSrc, colSrc);
+//***********************************************************************
+bool SubCircuitFullMatrixReductorDC::loadComponentsParallel() {
+// the loading loop of forwsubs: every component writes only its own stamps, the currents are added later
+//***********************************************************************
+    ComponentSubCircuit& subckt = *pSubCircuit;
+    std::atomic<bool> isChanged = false;
+    ThreadPool::getInstance().parallelFor(subckt.getNContainedComponents(), [&](unsigned begin, unsigned end) {
+        bool isChunkChanged = false;
+        for (uns i = begin; i < end; i++) {
+            const ComponentBase& compInstance = *subckt.getContainedComponent(i);
+            if (!compInstance.isEnabled) {
+                if (isCompLoaded[i]) {
+                    for (uns s = admStart[i]; s < admStart[i + 1]; s++)
+                        admValues[s] = rvt0;
+                    isCompLoaded[i] = 0;
+                    isChunkChanged = true;
+                }
+                continue;
+            }
+            for (uns s = curStart[i]; s < curStart[i + 1]; s++)
+                curValues[s] = compInstance.getJreducedDC(curStamps[s].rowSrc);
+            cuns YVersion = compInstance.getYDCVersion();
+            if (isCompLoaded[i] && YVersion != 0 && YVersion == compYVersion[i])
+                continue;
+            for (uns s = admStart[i]; s < admStart[i + 1]; s++) {
+                crvt adm = compInstance.getYDC(admStamps[s].rowSrc, admStamps[s].colSrc);
+                if (adm != admValues[s]) {
+                    admValues[s] = adm;
+                    isChunkChanged = true;
+                }
+            }
+            isCompLoaded[i] = 1;
+            compYVersion[i] = YVersion;
+        }
+        if (isChunkChanged)
+            isChanged.store(true, std::memory_order_relaxed);
+    });
 
-                    if (adm == rvt0)
-                        continue;
+    // currents: serial, in component order
 
-                    // INode connected to ControlInternalNode
+    for (uns i = 0; i < subckt.getNContainedComponents(); i++) {
+        if (!subckt.getContainedComponent(i)->isEnabled)
+            continue;
+        for (uns s = curStart[i]; s < curStart[i + 1]; s++) {
+            const CurrentStamp& stamp = curStamps[s];
+            if (stamp.dest == unsMax)
+                throw hmgExcept("SubCircuitFullMatrixReductorDC::forwsubs", stamp.isA
+                    ? "Connecting a Component Normal node to an external Basic node (A node) is not allowed."
+                    : "Connecting a Component Normal node to an internal Basic node (B node) is not allowed.");
+            (stamp.isA ? JA : JB)[stamp.dest] += curValues[s];
+        }
+    }
+    return isChanged.load();
+}
 
-                    if (nct.type == CDNodeType::cdntInternal && nct.index >= B1_nNInternalNodes) {
-                        continue;
-                    }
 
-                    // what is the destination?
-                    // if normal ONode among the external nodes, it must be handled as an internal node
+//***********************************************************************
+void SubCircuitFullMatrixReductorDC::refillParallel() {
+// a thread adds every stamp of its elements, in the original order
+//***********************************************************************
+    rvt* const targetData[4] = { YA.kernel_data(), XAT.kernel_data(), XB.kernel_data(), YB.kernel_data() };
+    ThreadPool::getInstance().parallelFor((unsigned)elementStart.size() - 1, [&](unsigned begin, unsigned end) {
+        for (uns k = begin; k < end; k++)
+            for (uns j = elementStart[k]; j < elementStart[k + 1]; j++) {
+                cuns s = scatterOrder[j];
+                if (admValues[s] != rvt0)
+                    targetData[admStamps[s].target][admStamps[s].offset] += admValues[s];
+            }
+    });
+}
 
-                    bool isUp;
-                    uns xDest = nct.index;
-                    if (B2_nNONodes != 0) {
-                        if (nct.type == CDNodeType::cdntExternal) {
-                            if (xDest >= ONodes_start && xDest < NONodes_end) { // internal node as normal (=to be reduced) ONode
-                                isUp = false; // false: ONode
-                                xDest += B1_nNInternalNodes - ONodes_start;
-                            }
-                            else isUp = true;
-                        }
-                        else isUp = false; // false: internal
-                    }
-                    else isUp = nct.type == CDNodeType::cdntExternal; // false: internal
 
-                    uns externalIndex2 = isUp ? xDest : 0;
-                    uns internalIndex2 = isUp ? 0 : xDest;
+//***********************************************************************
+struct SharedReductions {
+// the registered full matrix DC reductions, by SubCircuitFullMatrixReductorDC::getSharedHash
+//***********************************************************************
+    std::mutex mutex; // the subcircuits can be built parallel
+    std::unordered_multimap<size_t, SubCircuitFullMatrixReductorDC*> registry;
+};
+static SharedReductions sharedReductions;
 
-                    // add admittance
 
-                    // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-                    // Az isA-t s az isUp-ot megcserltem, mert az isA a J vektornl jelenti, hogy A-ban van, de a mtrixnl pont a msik oldalt!
-                    // Krds, hogy ez stimmel-e mindenhol, mert az Ynodes miatt XAT s XB mrete klnbzhet.
-                    // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+//***********************************************************************
+size_t SubCircuitFullMatrixReductorDC::getSharedHash(bool isFloatReduction) const noexcept {
+// FNV-1a on 64 bit words; -0 and +0 are the same, as in the comparison of the keys
+//***********************************************************************
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+    add(pSubCircuit->def->modelType);
+    add(pSubCircuit->def->modelIndex);
+    add(pSubCircuit->version);
+    add((isStampMapSymm ? 1 : 0) + (isFloatReduction ? 2 : 0));
+    for (crvt value : admValues)
+        add(value == rvt0 ? 0 : std::bit_cast<uint64_t>(value));
+    return size_t(hash ^ (hash >> 29));
+}
 
-                    if (isUp) {
-                        if (isA) {  // YA
-                            YAwork.get_elem(externalIndex1, externalIndex2) += adm; // get_elem_unsafe cannot be used because yDest > xDest possible
-                        }
-                        else { // XA
-                            if (isSymm) {
-                                XBwork[externalIndex1 + externalIndex2][internalIndex1 + internalIndex2] += adm; // (!) in symm case XA is not used, XB is XAT; indices switched;
-                            }
-                            else {
-                                XATwork[externalIndex1 + externalIndex2][internalIndex1 + internalIndex2] += adm;
-                            }
-                        }
-                    }
-                    else {
-                        if (isA) { // XB
-                            XBwork[externalIndex1 + externalIndex2][internalIndex1 + internalIndex2] += adm;
-                        }
-                        else { // YB
-                            YBwork.get_elem(internalIndex1, internalIndex2) += adm; // get_elem_unsafe cannot be used because yDest > xDest possible
-                        }
-                    }
-                }
+
+//***********************************************************************
+bool SubCircuitFullMatrixReductorDC::loadSharedReduction(size_t hash, bool isFloatReduction) {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(sharedReductions.mutex);
+    auto range = sharedReductions.registry.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const SubCircuitFullMatrixReductorDC& src = *it->second;
+        if (src.pSubCircuit->pModel != pSubCircuit->pModel || src.sharedModelVersion != pSubCircuit->version
+            || src.isStampMapSymm != isStampMapSymm || src.sharedIsFloat != isFloatReduction || src.sharedKey != admValues)
+            continue;
+        YRED.copy_unsafe(src.YRED);
+        NZB.copy_unsafe(src.NZB);
+        NZBXAT.copy_unsafe(src.NZBXAT);
+        return true;
+    }
+    return false;
+}
+
+
+//***********************************************************************
+void SubCircuitFullMatrixReductorDC::registerSharedReduction(size_t hash, bool isFloatReduction) {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(sharedReductions.mutex);
+    sharedKey = admValues;
+    sharedHash = hash;
+    sharedIsFloat = isFloatReduction;
+    sharedModelVersion = pSubCircuit->version;
+    sharedReductions.registry.emplace(hash, this);
+    isSharedRegistered = true;
+}
+
+
+//***********************************************************************
+void SubCircuitFullMatrixReductorDC::unregisterSharedReduction() {
+// before YRED, NZB or NZBXAT changes
+//***********************************************************************
+    if (!isSharedRegistered)
+        return;
+    std::lock_guard<std::mutex> lock(sharedReductions.mutex);
+    auto range = sharedReductions.registry.equal_range(sharedHash);
+    for (auto it = range.first; it != range.second; ++it)
+        if (it->second == this) {
+            sharedReductions.registry.erase(it);
+            break;
+        }
+    sharedKey.clear();
+    isSharedRegistered = false;
+}
+
+
+//***********************************************************************
+bool SubCircuitFullMatrixReductorDC::isLinear(const ComponentSubCircuit& subckt) noexcept {
+//***********************************************************************
+    if (!subckt.controllers.empty())
+        return false;
+    for (const auto& comp : subckt.components) {
+        if (comp->getModel().canBeNonlinear())
+            return false;
+        if (comp->getModel().modelType == ccmt_SubCircuit && !isLinear(static_cast<const ComponentSubCircuit&>(*comp)))
+            return false;
+    }
+    return true;
+}
+
+
+//***********************************************************************
+void SubCircuitFullMatrixReductorDC::forwsubs() {
+//***********************************************************************
+    ComponentSubCircuit& subckt = *pSubCircuit;
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*subckt.pModel);
+    const bool isSymm = subckt.isJacobianMXSymmetrical(true);
+    if (isSymm != isStampMapSymm)
+        alloc();
+
+    JA.zero(); // the defect of the external nodes is addad to the defect of the subckt component's JB so here not used
+    // JB.zero(); // initialized with the defect of the internal nodes
+
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+    cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+
+    // defect of the internal nodes
+
+    for (uns i = 0; i < B1_nNInternalNodes; i++)
+        JB[i] = -subckt.internalNodesAndVars[i].getDDC(); // JB initialized here
+
+    if (B2_nNONodes != 0) { // some internal nodes are routed out (they are stored among the external nodes)
+        for (uns i = 0; i < B2_nNONodes; i++)
+            JB[B1_nNInternalNodes + i] = -subckt.externalNodes[ONodes_start + i]->getDDC();
+    }
+
+    // defect + admittance of the contained components
+    // the admittances of a component are not read if it reports the same getYDCVersion as at the last load
+
+    bool isJacobiChanged = !isLoaded;
+    if (isParallelStamping)
+        isJacobiChanged = loadComponentsParallel() || isJacobiChanged;
+    else for (uns i = 0; i < subckt.getNContainedComponents(); i++) {
+        const ComponentBase& compInstance = *subckt.getContainedComponent(i);
+        if (!compInstance.isEnabled) {
+            if (isCompLoaded[i]) { // a disabled component adds nothing
+                for (uns s = admStart[i]; s < admStart[i + 1]; s++)
+                    admValues[s] = rvt0;
+                isCompLoaded[i] = 0;
+                isJacobiChanged = true;
             }
+            continue;
+        }
+        for (uns s = curStart[i]; s < curStart[i + 1]; s++) {
+            const CurrentStamp& stamp = curStamps[s];
+            if (stamp.dest == unsMax)
+                throw hmgExcept("SubCircuitFullMatrixReductorDC::forwsubs", stamp.isA
+                    ? "Connecting a Component Normal node to an external Basic node (A node) is not allowed."
+                    : "Connecting a Component Normal node to an internal Basic node (B node) is not allowed.");
+            (stamp.isA ? JA : JB)[stamp.dest] += compInstance.getJreducedDC(stamp.rowSrc);
         }
+        cuns YVersion = compInstance.getYDCVersion();
+        if (isCompLoaded[i] && YVersion != 0 && YVersion == compYVersion[i])
+            continue;
+        for (uns s = admStart[i]; s < admStart[i + 1]; s++) {
+            crvt adm = compInstance.getYDC(admStamps[s].rowSrc, admStamps[s].colSrc);
+            if (adm != admValues[s]) {
+                admValues[s] = adm;
+                isJacobiChanged = true;
+            }
+        }
+        isCompLoaded[i] = 1;
+        compYVersion[i] = YVersion;
     }
 
-    // Refresh matrices
+    // refill the matrices: the same additions in the same order as the component by component loading
 
-    bool isJacobiChanged = YAcopy.refresh_unsafe(YAwork);
-    if (!isSymm) isJacobiChanged = XATcopy.refresh_unsafe(XATwork) || isJacobiChanged;
-    isJacobiChanged = XBcopy.refresh_unsafe(XBwork) || isJacobiChanged;
-    isJacobiChanged = YBcopy.refresh_unsafe(YBwork) || isJacobiChanged;
+    if (isJacobiChanged) {
+        YA.zero_unsafe();
+        XAT.zero_unsafe();
+        XB.zero_unsafe();
+        YB.zero_unsafe();
+        if (isParallelStamping)
+            refillParallel();
+        else {
+            rvt* const targetData[4] = { YA.kernel_data(), XAT.kernel_data(), XB.kernel_data(), YB.kernel_data() };
+            for (size_t s = 0; s < admStamps.size(); s++)
+                if (admValues[s] != rvt0)
+                    targetData[admStamps[s].target][admStamps[s].offset] += admValues[s];
+        }
+        isLoaded = true;
+    }
+    const bool isFloatReduction = SimControl::isFloatReductionDC(B1_nNInternalNodes + B2_nNONodes);
+    isJacobiChanged = isJacobiChanged || isFloatReduced != isFloatReduction;
+    isFloatReduced = isFloatReduction;
 
-    // reduce (=Jacobi)
+    // reduce (=Jacobi), or copy the reduction of an instance with the same admittances, or a cached reduction
 
     if (isJacobiChanged) {
-        if (isSymm) {
-            NZB.copy_from_symm_to_nonsymm(YBcopy);
-            NZB.math_symm_ninv_of_nonsymm();
-            NZBXA.math_mul_t_unsafe(NZB, XBcopy);
-            NZBXAT.transp(NZBXA);
-            YRED.math_add_mul_t_symm(YAcopy, XBcopy, NZBXAT);
+        YREDVersion++;
+        unregisterSharedReduction();
+        const bool isShared = sharedMinBNodes != 0 && B1_nNInternalNodes + B2_nNONodes >= sharedMinBNodes;
+        const bool isCached = isShared && isCacheable && ReductionCache::memoryCap != 0;
+        const size_t hash = isShared ? getSharedHash(isFloatReduction) : 0;
+        ReductionCache& cache = CircuitStorage::getInstance().reductionCache;
+        ReductionCache::Key key;
+        if (isCached)
+            key = { subckt.def->modelIndex, subckt.version, isSymm, isFloatReduction, hash, admValues };
+        bool isCopied = isShared && loadSharedReduction(hash, isFloatReduction);
+        if (!isCopied && isCached && cache.load(key, YRED, NZB, NZBXAT)) {
+            registerSharedReduction(hash, isFloatReduction); // the other instances copy it from here
+            isCopied = true;
         }
-        else {
-            NZB.copy_unsafe(YBcopy);
-            NZB.math_ninv_np();
-            NZBXA.math_mul_t_unsafe(NZB, XATcopy);
-            NZBXAT.transp(NZBXA);
-            YRED.math_add_mul_t_unsafe(YAcopy, XBcopy, NZBXAT);
+        if (!isCopied) {
+            if (isFloatReduction) {
+                NZB.copy_unsafe(YB);
+                if (isSymm)
+                    MixedPrecisionReduction::reduceSymm(NZB, NZBXAT, YRED, YA, XB);
+                else
+                    MixedPrecisionReduction::reduceNonSymm(NZB, NZBXAT, YRED, YA, XAT, XB);
+            }
+            else if (isSymm) { // YRED = YA - XB * YB^-1 * XBT with YB = L * D * LT
+                NZB.copy_unsafe(YB);
+                NZB.math_symm_ldlt();
+                NZBXAT.math_ldlt_solve_rows(NZB, XB);
+                YRED.math_sub_mul_ldlt_symm(YA, NZBXAT, NZB);
+            }
+            else {
+                NZB.copy_unsafe(YB);
+                NZB.math_ninv_np();
+                NZBXAT.math_mul_t_unsafe(XAT, NZB); // (NZB * XA)^T = XAT * NZB^T, NZBXA is not stored, backsubs uses the transposed view
+                YRED.math_add_mul_t_unsafe(YA, XB, NZBXAT);
+            }
+            if (isShared)
+                registerSharedReduction(hash, isFloatReduction);
+            if (isCached)
+                cache.store(key, YRED, NZB, NZBXAT);
         }
     }
 
     // forward (=defects)
 
-    math_mul(NZBJB, NZB, JB);
-    math_add_mul(JRED, JA, XBcopy, NZBJB);
+    if (isSymm)
+        math_ldlt_nsolve(NZBJB, NZB, JB);
+    else
+        math_mul(NZBJB, NZB, JB);
+    math_add_mul(JRED, JA, XB, NZBJB);
 }
 
 
@@ -2132,9 +2472,8 @@ void SubCircuitFullMatrixReductorDC::backsubs() {
 
     // backward
 
-    if (UB.size() == 1)      math_1_add_mul_ub(UB, NZBJB, NZBXA, UA);
-    else if (UB.size() == 2) math_2_add_mul_ub(UB, NZBJB, NZBXA, UA);
-    else                         math_add_mul(UB, NZBJB, NZBXA, UA);
+    if (isSymm) math_ldlt_add_nsolve_ub(UB, NZBJB, NZB, XB, UA);
+    else        math_add_mul(UB, NZBJB, NZBXAT.view().transposed(), UA); // UB = NZBJB + NZBXA * UA
 
     // v of the internal nodes
 
@@ -2352,6 +2691,374 @@ void SubCircuitFullMatrixReductorAC::backsubs() {
 }
 
 
+//***********************************************************************
+static void buildSparsePattern(const ComponentSubCircuit& subckt, bool isSymm, SparseSymbolic& sym) {
+// The B nodes of a component are coupled with each other (the disabled components are also
+// included, so enabling a component does not change the pattern). The B node indexing is the
+// same as in the forwsubs of the reductors: the normal ONodes follow the internal nodes.
+//***********************************************************************
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(subckt.getModel());
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+    cuns nB = B1_nNInternalNodes + B2_nNONodes;
+    cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+    cuns NONodes_end = ONodes_start + B2_nNONodes;
+
+    std::vector<std::vector<uns>> adjacency(nB);
+    std::vector<uns> bNodes;
+    for (uns i = 0; i < subckt.getNContainedComponents(); i++) {
+        const ComponentBase& compInstance = *subckt.getContainedComponent(i);
+        const ComponentAndControllerModelBase& compModel = compInstance.getModel();
+        const ComponentDefinition& compDef = *compInstance.def;
+        cuns nIO = compModel.getN_X_Nodes();
+        cuns nAx = nIO + (isSymm ? 0 : compModel.getN_Y_Nodes());
+        bNodes.clear();
+        for (uns j = 0; j < nAx; j++) {
+            const CDNode& nct = compDef.nodesConnectedTo[j];
+            if (nct.type == CDNodeType::cdntInternal) {
+                if (nct.index < (j < nIO ? nB : B1_nNInternalNodes)) // a column of a ControlInternalNode is skipped
+                    bNodes.push_back(nct.index);
+            }
+            else if (nct.type == CDNodeType::cdntExternal && nct.index >= ONodes_start && nct.index < NONodes_end)
+                bNodes.push_back(nct.index + B1_nNInternalNodes - ONodes_start);
+        }
+        for (uns y : bNodes)
+            adjacency[y].insert(adjacency[y].end(), bNodes.begin(), bNodes.end());
+    }
+    sym.build(adjacency, isSymm);
+}
+
+
+//***********************************************************************
+template<typename T>
+static void loadSparseReductor(const ComponentSubCircuit& subckt, const SparseSymbolic& sym, bool isSymm, 
+    matrix<T>& YA, matrix<T>& XAT, matrix<T>& XB, std::vector<T>& YB, vektor<T>& JA, vektor<T>& JB, const char* who) {
+// the admittance + defect of the contained components, as in the forwsubs of SubCircuitFullMatrixReductorDC/AC
+//***********************************************************************
+    constexpr bool isDC = std::is_same_v<T, rvt>;
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(subckt.getModel());
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+    cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+    cuns NONodes_end = ONodes_start + B2_nNONodes;
+
+    for (uns i = 0; i < subckt.getNContainedComponents(); i++) {
+        const ComponentBase& compInstance = *subckt.getContainedComponent(i);
+        if (compInstance.isEnabled) {
+            const ComponentAndControllerModelBase& compModel = compInstance.getModel();
+            const ComponentDefinition& compDef = *compInstance.def;
+            cuns nIO = compModel.getN_X_Nodes();
+            cuns nAx = nIO + (isSymm ? 0 : compModel.getN_Y_Nodes());
+            for (uns rowSrc = 0; rowSrc < nIO; rowSrc++) {
+
+                // ground connections disappear
+
+                if (compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntRail || compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntGnd || compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntUnconnected)
+                    continue;
+
+                // what is the destination?
+
+                bool isA;
+                uns yDest = compDef.nodesConnectedTo[rowSrc].index;
+                if (B2_nNONodes != 0) {
+                    if (compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntExternal) {
+                        if (yDest >= ONodes_start && yDest < NONodes_end) { // internal node as normal (=to be reduced) ONode
+                            isA = false;
+                            yDest += B1_nNInternalNodes - ONodes_start;
+                        }
+                        else isA = true;
+                    }
+                    else isA = false;
+                }
+                else isA = compDef.nodesConnectedTo[rowSrc].type == CDNodeType::cdntExternal;
+
+                // loading J
+
+                if (isA) {
+                    if (yDest >= JA.size())
+                        throw hmgExcept(who, "Connecting a Component Normal node to an external Basic node (A node) is not allowed.");
+                    if constexpr (isDC) JA[yDest] += compInstance.getJreducedDC(rowSrc);
+                    else                JA[yDest] += compInstance.getJreducedAC(rowSrc);
+                }
+                else {
+                    if (yDest >= JB.size())
+                        throw hmgExcept(who, "Connecting a Component Normal node to an internal Basic node (B node) is not allowed.");
+                    if constexpr (isDC) JB[yDest] += compInstance.getJreducedDC(rowSrc);
+                    else                JB[yDest] += compInstance.getJreducedAC(rowSrc);
+                }
+
+                // admittances 
+
+                for (uns colSrc = isSymm ? rowSrc : 0; colSrc < nAx; colSrc++) { // in symmetric matrices the admittances should be increased only once
+                    const CDNode& nct = compDef.nodesConnectedTo[colSrc];
+                    if (!(nct.type == CDNodeType::cdntInternal || nct.type == CDNodeType::cdntExternal))
+                        continue;
+                    T adm;
+                    if constexpr (isDC) adm = compInstance.getYDC(rowSrc, colSrc);
+                    else                adm = compInstance.getYAC(rowSrc, colSrc);
+
+                    if (adm == T(0))
+                        continue;
+
+                    // INode connected to ControlInternalNode
+
+                    if (nct.type == CDNodeType::cdntInternal && nct.index >= B1_nNInternalNodes)
+                        continue;
+
+                    bool isUp;
+                    uns xDest = nct.index;
+                    if (B2_nNONodes != 0) {
+                        if (nct.type == CDNodeType::cdntExternal) {
+                            if (xDest >= ONodes_start && xDest < NONodes_end) {
+                                isUp = false;
+                                xDest += B1_nNInternalNodes - ONodes_start;
+                            }
+                            else isUp = true;
+                        }
+                        else isUp = false;
+                    }
+                    else isUp = nct.type == CDNodeType::cdntExternal;
+
+                    // add admittance (see the note on isA and isUp in SubCircuitFullMatrixReductorDC::forwsubs)
+
+                    if (isUp) {
+                        if (isA)         YA.get_elem(yDest, xDest) += adm;
+                        else if (isSymm) XB[xDest][yDest] += adm; // in symm case XA is not used, XB is XAT
+                        else             XAT[xDest][yDest] += adm;
+                    }
+                    else {
+                        if (isA) XB[yDest][xDest] += adm;
+                        else {
+                            cuns slot = sym.getSlot(yDest, xDest);
+                            if (slot == unsMax)
+                                throw hmgExcept(who, "YB[%u][%u] is out of the sparse pattern", yDest, xDest);
+                            YB[slot] += adm;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//***********************************************************************
+template<typename T>
+static void reduceSparse(const SparseSymbolic& sym, const SparseFactor<T>& NZB, bool isSymm, matrix<T>& YRED, matrix<T>& NZBXAT,
+    const matrix<T>& YA, const matrix<T>& XAT, const matrix<T>& XB) {
+// NZBXAT[a] = -YB^-1 * XA[*][a], YRED = YA + XB * NZBXAT^T; in the symmetrical case XA = XB^T
+//***********************************************************************
+    const matrix<T>& XA_T = isSymm ? XB : XAT;
+    ThreadPool::getInstance().parallelFor(NZBXAT.get_row(), [&](unsigned begin, unsigned end) {
+        std::vector<T> work(sym.getN());
+        for (unsigned a = begin; a < end; a++)
+            NZB.nsolve(sym, NZBXAT[a].data(), XA_T[a].data(), work.data());
+    });
+    if (isSymm)
+        YRED.math_add_mul_t_symm(YA, XB, NZBXAT);
+    else
+        YRED.math_add_mul_t_unsafe(YA, XB, NZBXAT);
+}
+
+
+//***********************************************************************
+void SubCircuitSparseReductorDC::alloc() {
+//***********************************************************************
+    YREDVersion++; // the users of YRED reload it
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pSubCircuit->pModel);
+    const bool isSymm = pSubCircuit->isJacobianMXSymmetrical(true);
+    cuns Arow = model.getN_X_Nodes();
+    cuns Acol = Arow + (isSymm ? 0 : model.getN_Y_Nodes());
+    cuns Browcol = model.getN_N_Nodes() + model.getN_O_Nodes();
+    buildSparsePattern(*pSubCircuit, isSymm, sym);
+    YRED.resize_if_needed(Arow, Acol, isSymm);
+    JRED.resize_if_needed(Arow);
+    YAwork.resize_if_needed(Arow, Acol, isSymm);
+    YAcopy.resize_if_needed(Arow, Acol, isSymm);
+    if (!isSymm) XATwork.resize_if_needed(Acol, Browcol, false);
+    if (!isSymm) XATcopy.resize_if_needed(Acol, Browcol, false);
+    XBwork.resize_if_needed(Arow, Browcol, false);
+    XBcopy.resize_if_needed(Arow, Browcol, false);
+    YBwork.assign(sym.getNSlots(), rvt0);
+    YBcopy.assign(sym.getNSlots(), rvt0);
+    isFactored = false;
+    NZBXAT.resize_if_needed(Acol, Browcol, false);
+    JA.resize_if_needed(Arow);
+    JB.resize_if_needed(Browcol);
+    NZBJB.resize_if_needed(Browcol);
+    UA.resize_if_needed(Acol);
+    UB.resize_if_needed(Browcol);
+    work.resize(Browcol);
+}
+
+
+//***********************************************************************
+void SubCircuitSparseReductorDC::forwsubs() {
+//***********************************************************************
+    ComponentSubCircuit& subckt = *pSubCircuit;
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*subckt.pModel);
+    const bool isSymm = subckt.isJacobianMXSymmetrical(true);
+
+    YAwork.zero_unsafe();
+    XATwork.zero_unsafe();
+    XBwork.zero_unsafe();
+    std::fill(YBwork.begin(), YBwork.end(), rvt0);
+    JA.zero();
+
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+    cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+
+    // defect of the internal nodes
+
+    for (uns i = 0; i < B1_nNInternalNodes; i++)
+        JB[i] = -subckt.internalNodesAndVars[i].getDDC();
+    for (uns i = 0; i < B2_nNONodes; i++)
+        JB[B1_nNInternalNodes + i] = -subckt.externalNodes[ONodes_start + i]->getDDC();
+
+    // admittance + defect of the contained components
+
+    loadSparseReductor(subckt, sym, isSymm, YAwork, XATwork, XBwork, YBwork, JA, JB, "SubCircuitSparseReductorDC::forwsubs");
+
+    // refresh: a changed "work" becomes the "copy" by swapping
+
+    bool isJacobiChanged = YAcopy.refresh_by_swap(YAwork);
+    if (!isSymm) isJacobiChanged = XATcopy.refresh_by_swap(XATwork) || isJacobiChanged;
+    isJacobiChanged = XBcopy.refresh_by_swap(XBwork) || isJacobiChanged;
+    if (YBwork != YBcopy || !isFactored) {
+        YBwork.swap(YBcopy);
+        NZB.factor(sym, YBcopy);
+        isFactored = true;
+        isJacobiChanged = true;
+    }
+
+    // reduce (=Jacobi)
+
+    if (isJacobiChanged) {
+        YREDVersion++;
+        reduceSparse(sym, NZB, isSymm, YRED, NZBXAT, YAcopy, XATcopy, XBcopy);
+    }
+
+    // forward (=defects)
+
+    NZB.nsolve(sym, NZBJB.data(), JB.data(), work.data());
+    math_add_mul(JRED, JA, XBcopy, NZBJB);
+}
+
+
+//***********************************************************************
+void SubCircuitSparseReductorDC::backsubs() {
+//***********************************************************************
+    ComponentSubCircuit& subckt = *pSubCircuit;
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*subckt.pModel);
+    cuns nA = model.getN_X_Nodes() + model.getN_Y_Nodes();
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+
+    for (uns i = 0; i < UA.size() && i < nA; i++)
+        UA[i] = subckt.externalNodes[i]->getVDC();
+
+    math_add_mul(UB, NZBJB, NZBXAT.view().transposed(), UA); // UB = NZBJB + NZBXA * UA
+
+    for (uns i = 0; i < B1_nNInternalNodes; i++)
+        subckt.internalNodesAndVars[i].setVDC(UB[i]);
+    if (B2_nNONodes != 0) {
+        cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+        for (uns i = 0; i < B2_nNONodes; i++)
+            subckt.externalNodes[ONodes_start + i]->setVDC(UB[B1_nNInternalNodes + i]);
+    }
+}
+
+
+//***********************************************************************
+void SubCircuitSparseReductorAC::alloc() {
+//***********************************************************************
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pSubCircuit->pModel);
+    const bool isSymm = pSubCircuit->isJacobianMXSymmetrical(false);
+    cuns Arow = model.getN_X_Nodes();
+    cuns Acol = Arow + (isSymm ? 0 : model.getN_Y_Nodes());
+    cuns Browcol = model.getN_N_Nodes() + model.getN_O_Nodes();
+    buildSparsePattern(*pSubCircuit, isSymm, sym);
+    YRED.resize_if_needed(Arow, Acol, isSymm);
+    JRED.resize_if_needed(Arow);
+    YA.resize_if_needed(Arow, Acol, isSymm);
+    if (!isSymm) XAT.resize_if_needed(Acol, Browcol, false);
+    XB.resize_if_needed(Arow, Browcol, false);
+    YB.assign(sym.getNSlots(), cplx0);
+    NZBXAT.resize_if_needed(Acol, Browcol, false);
+    JA.resize_if_needed(Arow);
+    JB.resize_if_needed(Browcol);
+    NZBJB.resize_if_needed(Browcol);
+    UA.resize_if_needed(Acol);
+    UB.resize_if_needed(Browcol);
+    work.resize(Browcol);
+}
+
+
+//***********************************************************************
+void SubCircuitSparseReductorAC::forwsubs() {
+//***********************************************************************
+    ComponentSubCircuit& subckt = *pSubCircuit;
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*subckt.pModel);
+    const bool isSymm = subckt.isJacobianMXSymmetrical(false);
+
+    YA.zero_unsafe();
+    XAT.zero_unsafe();
+    XB.zero_unsafe();
+    std::fill(YB.begin(), YB.end(), cplx0);
+    JA.zero();
+
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+    cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+
+    // defect of the internal nodes
+
+    for (uns i = 0; i < B1_nNInternalNodes; i++)
+        JB[i] = -subckt.internalNodesAndVars[i].getDAC();
+    for (uns i = 0; i < B2_nNONodes; i++)
+        JB[B1_nNInternalNodes + i] = -subckt.externalNodes[ONodes_start + i]->getDAC();
+
+    // admittance + defect of the contained components
+
+    loadSparseReductor(subckt, sym, isSymm, YA, XAT, XB, YB, JA, JB, "SubCircuitSparseReductorAC::forwsubs");
+
+    // reduce (=Jacobi)
+
+    NZB.factor(sym, YB);
+    reduceSparse(sym, NZB, isSymm, YRED, NZBXAT, YA, XAT, XB);
+
+    // forward (=defects)
+
+    NZB.nsolve(sym, NZBJB.data(), JB.data(), work.data());
+    math_add_mul(JRED, JA, XB, NZBJB);
+}
+
+
+//***********************************************************************
+void SubCircuitSparseReductorAC::backsubs() {
+//***********************************************************************
+    ComponentSubCircuit& subckt = *pSubCircuit;
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*subckt.pModel);
+    cuns nA = model.getN_X_Nodes() + model.getN_Y_Nodes();
+    cuns B1_nNInternalNodes = model.getN_N_Nodes();
+    cuns B2_nNONodes = model.getN_O_Nodes();
+
+    for (uns i = 0; i < UA.size() && i < nA; i++)
+        UA[i] = subckt.externalNodes[i]->getVAC();
+
+    math_add_mul(UB, NZBJB, NZBXAT.view().transposed(), UA); // UB = NZBJB + NZBXA * UA
+
+    for (uns i = 0; i < B1_nNInternalNodes; i++)
+        subckt.internalNodesAndVars[i].setVAC(UB[i]);
+    if (B2_nNONodes != 0) {
+        cuns ONodes_start = model.getN_Start_Of_O_Nodes();
+        for (uns i = 0; i < B2_nNONodes; i++)
+            subckt.externalNodes[ONodes_start + i]->setVAC(UB[B1_nNInternalNodes + i]);
+    }
+}
+
+
 //***********************************************************************
 void ComponentSubCircuit::solveDC() {
 //***********************************************************************
@@ -16,6 +16,8 @@
 #include "hmgMatrix.hpp"
 #include "hmgComponentModel.h"
 #include "hmgSunred.h"
+#include "hmgSparse.h"
+#include "hmgReductionCache.h"
 #include "hmgMultigridTypes.h"
 #include "hmgMultigrid.hpp"
 #include "hmgSimulation.h"
@@ -65,6 +67,12 @@ public:
     inline static NodeVariable stepError;       // relative error of the current iteration compared to the previous
     inline static std::atomic<uns> nNonlinComponents = 0; // actual number of nonlinear components in the network; if 0 => no more than 1 DC / timestep iteration needed
     inline static std::atomic<uns> nComponents = 0; // actual number of components in the network
+    inline static std::atomic<uns> nControllers = 0; // actual number of controllers in the network; a controller is a feedback, so if not 0 => the timestep needs the defect-checked iteration
+    inline static bool isMixedPrecisionDC = false;  // .RUN ... FLOAT: the large DC reductions are done in float, the DC iteration refines the result in double
+    inline static uns mixedPrecisionMinSize = 64;   // the reductions with less internal (B) nodes remain double
+    inline static uns mixedPrecisionMaxRefinement = 10; // extra DC iterations after the normal ones while the error decreases
+    //***********************************************************************
+    static bool isFloatReductionDC(uns nBNodes) noexcept { return isMixedPrecisionDC && nBNodes >= mixedPrecisionMinSize; }
     //***********************************************************************
     static void setInitialDC() noexcept { timeStepStart.setValueDC(rvt0); timeStepStop.setValueDC(rvt0); dt.setValueDC(rvt0); }
     static void setFinalDC() noexcept { if (timeStepStart.getValueDC() == rvt0)timeStepStart.setValueDC(1e-20); timeStepStop.setValueDC(timeStepStart.getValueDC()); dt.setValueDC(rvt0); }
@@ -172,6 +180,7 @@ public:
     virtual void printNodeValue() const noexcept = 0;
     virtual rvt getJreducedDC(uns y) const noexcept = 0;
     virtual rvt getYDC(uns y, uns x) const noexcept = 0;
+    virtual uns getYDCVersion() const noexcept { return 0; } // changes when getYDC changes, 0: unknown (the caller must compare the values)
     virtual void calculateYiiDC() noexcept = 0;
     //************************** AC functions *******************************
     virtual void acceptIterationAndStepAC() noexcept = 0; // Vnode = Vnode + v
@@ -3766,8 +3775,11 @@ public:
         workField.resize(wfs);
         for (uns i = 0; i < wfs; i++)
             workField[i] = rvt0;
+        SimControl::nControllers++;
     }
     //***********************************************************************
+    ~Controller() { SimControl::nControllers--; }
+    //***********************************************************************
 
     //***********************************************************************
     void buildOrReplace(uns id, uns parentId, uns parentParentId, uns parentParentParentId) override {
@@ -3903,6 +3915,8 @@ public:
 //***********************************************************************
 class SubCircuitFullMatrixReductorDC;
 class SubCircuitFullMatrixReductorAC;
+class SubCircuitSparseReductorDC;
+class SubCircuitSparseReductorAC;
 struct CellReductionDescription;
 //***********************************************************************
 
@@ -3913,8 +3927,11 @@ class ComponentSubCircuit final : public ComponentBase {
     //***********************************************************************
     friend class SubCircuitFullMatrixReductorDC;
     friend class SubCircuitFullMatrixReductorAC;
+    friend class SubCircuitSparseReductorDC;
+    friend class SubCircuitSparseReductorAC;
     friend class hmgSunred;
     friend class SunredTreeNode;
+    friend class SunredTreeOptimizer;
     friend class CircuitStorage;
     friend struct FineCoarseConnectionDescription;
     //***********************************************************************
@@ -3927,6 +3944,8 @@ class ComponentSubCircuit final : public ComponentBase {
     std::vector<ComponentAndControllerBase*> componentParams;
     std::unique_ptr<SubCircuitFullMatrixReductorDC> sfmrDC;
     std::unique_ptr<SubCircuitFullMatrixReductorAC> sfmrAC;
+    std::unique_ptr<SubCircuitSparseReductorDC> ssrDC;
+    std::unique_ptr<SubCircuitSparseReductorAC> ssrAC;
     uns nInternalNodesAndVars = 0;
     uns version = 0; // buildOrReplace must be run if this->version != model->version
     bool isJacobianMXSymmetricalDC_ = false;
@@ -3976,44 +3995,7 @@ public:
     const ComponentBase* getContainedComponent(uns i) const noexcept override { return components[i].get(); }
     void buildOrReplace(uns id, uns parentId, uns parentParentId, uns parentParentParentId)override;
     //***********************************************************************
-    void setNodesToComponents() {
-    // how many components are connecting to a node (multiple connection from the same component is counted as 1)
-    //***********************************************************************
-        externalNodesToComponents.clear();
-        externalNodesToComponents.resize(pModel->getN_ExternalNodes()); // ONode is possible
-        internalNodesToComponents.clear();
-        internalNodesToComponents.resize(static_cast<const ModelSubCircuit*>(pModel)->getN_N_Nodes()); // ?? What about ONodes?
-        for (uns i = 0; i < components.size(); i++) {
-            const auto& comp = *components[i];
-            if (comp.isEnabled) {
-                for (const auto& node : comp.def->nodesConnectedTo) {
-                    if (node.type == CDNodeType::cdntInternal) {
-                        if (node.index < internalNodesToComponents.size()) {
-                            bool isNotIn = true;
-                            auto& ntc = internalNodesToComponents[node.index];
-                            for (uns j = 0; j < ntc.size() && isNotIn; j++)
-                                if (ntc[j] == i)
-                                    isNotIn = false;
-                            if (isNotIn)
-                                ntc.push_back(i);
-                        }
-                    }
-                    else if (node.type == CDNodeType::cdntExternal) {
-                        if (node.index < externalNodesToComponents.size()) {
-                            bool isNotIn = true;
-                            auto& ntc = externalNodesToComponents[node.index];
-                            for (uns j = 0; j < ntc.size() && isNotIn; j++)
-                                if (ntc[j] == i)
-                                    isNotIn = false;
-                            if (isNotIn)
-                                ntc.push_back(i);
-                        }
-                    }
-                    // ground, var and unconnected nodes ignored
-                }
-            }
-        }
-    }
+    void setNodesToComponents(); // how many components are connecting to a node (multiple connection from the same component is counted as 1)
     //************************** AC / DC functions *******************************
     void resetNodes(bool isDC) noexcept override {
     // TO PARALLEL
@@ -4329,6 +4311,7 @@ public:
     //***********************************************************************
     rvt getJreducedDC(uns y) const noexcept override;
     rvt getYDC(uns y, uns x) const noexcept override;
+    uns getYDCVersion() const noexcept override;
     //***********************************************************************
     void calculateYiiDC() noexcept override {
     // TO PARALLEL
@@ -4577,18 +4560,70 @@ class SubCircuitFullMatrixReductorDC {
     //***********************************************************************
     matrix<rvt> YRED; // forwsubs sets
     vektor<rvt> JRED; // forwsubs sets
-    matrix<rvt> YAwork, YAcopy, XATwork, XATcopy, XBwork, XBcopy, YBwork, YBcopy; // step 1: fill "work" YA, XA, XB, YB; step2: update all "copy". If no change, no need for matrix reduction. 
-    matrix<rvt> NZB, NZBXA, NZBXAT;
+    matrix<rvt> YA, XAT, XB, YB; // refilled from admValues only if an admittance changed, if no change, no need for matrix reduction
+    matrix<rvt> NZB, NZBXAT;
     vektor<rvt> JA, JB, NZBJB, UA, UB;
+    bool isFloatReduced = false; // NZB, NZBXAT and YRED are from a mixed precision reduction
+    bool isLoaded = false; // YA, XAT, XB and YB are filled from admValues
+    uns YREDVersion = 0; // incremented when YRED changes, see ComponentBase::getYDCVersion
+    //*******  stamp map, built in alloc (buildOrReplace)  *****************
+    enum StampTarget : unsigned char { stYA, stXAT, stXB, stYB };
+    struct AdmittanceStamp {
+        uns rowSrc, colSrc; // getYDC(rowSrc, colSrc) of the component
+        StampTarget target;
+        size_t offset;      // of the element in the storage of the target matrix
+    };
+    struct CurrentStamp {
+        uns rowSrc;         // getJreducedDC(rowSrc) of the component
+        bool isA;
+        uns dest;           // index in JA or JB, unsMax: invalid connection (an error if the component is enabled)
+    };
+    std::vector<AdmittanceStamp> admStamps;
+    std::vector<rvt> admValues;           // the admittances at the last forwsubs, 0 for a disabled component
+    std::vector<CurrentStamp> curStamps;
+    std::vector<uns> admStart, curStart;  // the stamps of component i: [admStart[i], admStart[i + 1]), [curStart[i], curStart[i + 1])
+    std::vector<uns> compYVersion;        // ComponentBase::getYDCVersion at the last load of the admittances
+    std::vector<unsigned char> isCompLoaded; // the admittances of the component are in admValues
+    bool isStampMapSymm = false;
+    //*******  parallel stamping (at least parallelMinComponents components)  ******
+    bool isParallelStamping = false;
+    std::vector<rvt> curValues;           // getJreducedDC of curStamps, read in parallel, added serially
+    std::vector<uns> scatterOrder;        // admStamps sorted by destination element, stable: the order of the additions is kept
+    std::vector<uns> elementStart;        // scatterOrder[elementStart[k] ... elementStart[k + 1] - 1] go to the same element
+    //*******  shared reduction of the instances of the same model (at least sharedMinBNodes B nodes)  ******
+    // the result of the reduction depends on the model, the symmetry, the precision and admValues only, so an
+    // instance with the same key copies YRED, NZB and NZBXAT of a registered instance instead of reducing
+    bool isSharedRegistered = false;      // this instance is in the registry with the following key
+    bool sharedIsFloat = false;
+    uns sharedModelVersion = 0;
+    size_t sharedHash = 0;
+    std::vector<rvt> sharedKey;           // admValues of the registered reduction (admValues itself may change during the loading)
+    bool isCacheable = false;             // a linear subcircuit of a custom model, its reductions go to CircuitStorage::reductionCache
     //***********************************************************************
     ComponentSubCircuit* pSubCircuit;
     //***********************************************************************
+    void buildStampMap(bool isSymm);
+    bool loadComponentsParallel(); // returns true if an admittance changed
+    void refillParallel();
+    size_t getSharedHash(bool isFloatReduction) const noexcept;
+    bool loadSharedReduction(size_t hash, bool isFloatReduction); // returns false if there is no registered instance with the same key
+    void registerSharedReduction(size_t hash, bool isFloatReduction);
+    void unregisterSharedReduction();
+    static bool isLinear(const ComponentSubCircuit& subckt) noexcept; // no nonlinear component and no controller at any depth
+    //***********************************************************************
 public:
+    //***********************************************************************
+    inline static uns parallelMinComponents = 4096; // hexmg -parstamp <n>
+    inline static uns sharedMinBNodes = 8;          // hexmg -sharedred <n>, 0: off (also turns off the ReductionCache)
+    //***********************************************************************
     //***********************************************************************
     SubCircuitFullMatrixReductorDC(ComponentSubCircuit* pOwner) :pSubCircuit{ pOwner } {}
+    ~SubCircuitFullMatrixReductorDC() { unregisterSharedReduction(); }
     //***********************************************************************
     void alloc() {
     //***********************************************************************
+        unregisterSharedReduction(); // the structure may change
+        YREDVersion++; // the users of YRED reload it
         const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pSubCircuit->pModel);
         const bool isSymm = pSubCircuit->isJacobianMXSymmetrical(true);
         cuns Arow = model.getN_X_Nodes();
@@ -4596,22 +4631,18 @@ public:
         cuns Browcol = model.getN_N_Nodes() + model.getN_O_Nodes();
         YRED.resize_if_needed(Arow, Acol, isSymm);
         JRED.resize_if_needed(Arow);
-        YAwork.resize_if_needed(Arow, Acol, isSymm);
-        YAcopy.resize_if_needed(Arow, Acol, isSymm);
-        if (!isSymm) XATwork.resize_if_needed(Acol, Browcol, false);
-        if (!isSymm) XATcopy.resize_if_needed(Acol, Browcol, false);
-        XBwork.resize_if_needed(Arow, Browcol, false);
-        XBcopy.resize_if_needed(Arow, Browcol, false);
-        YBwork.resize_if_needed(Browcol, Browcol, isSymm);
-        YBcopy.resize_if_needed(Browcol, Browcol, isSymm);
-        NZB.resize_if_needed(Browcol, Browcol, false); // never symmetrical!
-        NZBXA.resize_if_needed(Browcol, Acol, false);
+        YA.resize_if_needed(Arow, Acol, isSymm);
+        if (!isSymm) XAT.resize_if_needed(Acol, Browcol, false);
+        XB.resize_if_needed(Arow, Browcol, false);
+        YB.resize_if_needed(Browcol, Browcol, isSymm);
+        NZB.resize_if_needed(Browcol, Browcol, isSymm); // symmetrical: LDLT factor, nonsymmetrical: inverse
         NZBXAT.resize_if_needed(Acol, Browcol, false);
         JA.resize_if_needed(Arow);
         JB.resize_if_needed(Browcol);
         NZBJB.resize_if_needed(Browcol);
         UA.resize_if_needed(Acol);
         UB.resize_if_needed(Browcol);
+        buildStampMap(isSymm);
     }
     //***********************************************************************
     void forwsubs();
@@ -4665,6 +4696,67 @@ public:
     //***********************************************************************
 };
 
+
+//***********************************************************************
+class SubCircuitSparseReductorDC {
+// SubCircuitFullMatrixReductorDC with a sparse YB: the pattern and the pivot order are built
+// in alloc (i.e. once per structure version), forwsubs refactors YB only if it changed.
+// YRED = YA + XB * NZBXAT^T, where the rows of NZBXAT are -YB^-1 * (the columns of XA).
+//***********************************************************************
+    friend class ComponentSubCircuit;
+    //***********************************************************************
+    matrix<rvt> YRED; // forwsubs sets
+    vektor<rvt> JRED; // forwsubs sets
+    matrix<rvt> YAwork, YAcopy, XATwork, XATcopy, XBwork, XBcopy; // step 1: fill "work"; step 2: if changed, it becomes the "copy" (swap)
+    std::vector<rvt> YBwork, YBcopy; // in the slots of sym
+    SparseSymbolic sym;
+    SparseFactor<rvt> NZB;
+    matrix<rvt> NZBXAT;
+    vektor<rvt> JA, JB, NZBJB, UA, UB;
+    std::vector<rvt> work;
+    bool isFactored = false; // NZB is the factor of YBcopy
+    uns YREDVersion = 0; // incremented when YRED changes, see ComponentBase::getYDCVersion
+    //***********************************************************************
+    ComponentSubCircuit* pSubCircuit;
+    //***********************************************************************
+public:
+    //***********************************************************************
+    SubCircuitSparseReductorDC(ComponentSubCircuit* pOwner) :pSubCircuit{ pOwner } {}
+    //***********************************************************************
+    void alloc();
+    void forwsubs();
+    void backsubs();
+    //***********************************************************************
+};
+
+
+//***********************************************************************
+class SubCircuitSparseReductorAC {
+//***********************************************************************
+    friend class ComponentSubCircuit;
+    //***********************************************************************
+    matrix<cplx> YRED; // forwsubs sets
+    vektor<cplx> JRED; // forwsubs sets
+    matrix<cplx> YA, XAT, XB;
+    std::vector<cplx> YB; // in the slots of sym
+    SparseSymbolic sym;
+    SparseFactor<cplx> NZB;
+    matrix<cplx> NZBXAT;
+    vektor<cplx> JA, JB, NZBJB, UA, UB;
+    std::vector<cplx> work;
+    //***********************************************************************
+    ComponentSubCircuit* pSubCircuit;
+    //***********************************************************************
+public:
+    //***********************************************************************
+    SubCircuitSparseReductorAC(ComponentSubCircuit* pOwner) :pSubCircuit{ pOwner } {}
+    //***********************************************************************
+    void alloc();
+    void forwsubs();
+    void backsubs();
+    //***********************************************************************
+};
+
 #ifdef HMG_DEBUGPRINT
 
 //***********************************************************************
@@ -4684,22 +4776,22 @@ inline void ComponentSubCircuit::testPrint() const noexcept {
     std::cout << "\nYRED:" << std::endl;
     YREDdc.print_z();
     std::cout << "\nYB:" << std::endl;
-    sfmrDC->YBcopy.print_z();
+    sfmrDC->YB.print_z();
     std::cout << "\nNZB:" << std::endl;
     sfmrDC->NZB.print_z();
-    if (sfmrDC->YBcopy.get_col() == 2) {
-        sfmrDC->YBcopy.get_elem(0, 1) *= -1.0;
-        sfmrDC->YBcopy.get_elem(1, 0) *= -1.0;
-        sfmrDC->YBwork.math_mul_t_safe(sfmrDC->NZB, sfmrDC->YBcopy);
+    if (sfmrDC->YB.get_col() == 2) {
+        sfmrDC->YB.get_elem(0, 1) *= -1.0;
+        sfmrDC->YB.get_elem(1, 0) *= -1.0;
+        sfmrDC->YBwork.math_mul_t_safe(sfmrDC->NZB, sfmrDC->YB);
         std::cout << "\nE:" << std::endl;
         sfmrDC->YBwork.print_z();
     }
     std::cout << "\nYA:" << std::endl;
-    sfmrDC->YAcopy.print_z();
+    sfmrDC->YA.print_z();
     std::cout << "\nXAT:" << std::endl;
-    sfmrDC->XATcopy.print_z();
+    sfmrDC->XAT.print_z();
     std::cout << "\nXB:" << std::endl;
-    sfmrDC->XBcopy.print_z();
+    sfmrDC->XB.print_z();
     std::cout << "\nNZBJB:" << std::endl;
     sfmrDC->NZBJB.print_z();
     std::cout << "\nJRED:" << std::endl;
@@ -4712,8 +4804,8 @@ inline void ComponentSubCircuit::testPrint() const noexcept {
     sfmrDC->UA.print_z();
     std::cout << "\nUB:" << std::endl;
     sfmrDC->UB.print_z();
-    std::cout << "\nNZBXA:" << std::endl;
-    sfmrDC->NZBXA.print_z();
+    std::cout << "\nNZBXAT:" << std::endl;
+    sfmrDC->NZBXAT.print_z();
     for (uns i = 0; i < components.size(); i++) {
         if (dynamic_cast<ComponentSubCircuit*>(components[i].get())) std::cout << "\n***************\n" << i << "\n***************" << std::endl;
         if (components[i].get()->isEnabled) components[i].get()->testPrint();
@@ -4727,24 +4819,40 @@ inline rvt ComponentSubCircuit::getJreducedDC(uns y) const noexcept {
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
     if (model.solutionType == SolutionType::stFullMatrix)
         return y < sfmrDC->JRED.size() ? sfmrDC->JRED[y] : rvt0;
+    if (model.solutionType == SolutionType::stSparse)
+        return y < ssrDC->JRED.size() ? ssrDC->JRED[y] : rvt0;
     return rvt0;
 }
 inline rvt ComponentSubCircuit::getYDC(uns y, uns x) const noexcept {
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
     if (model.solutionType == SolutionType::stFullMatrix)
         return y < sfmrDC->YRED.get_row() && x < sfmrDC->YRED.get_col() ? sfmrDC->YRED.get_elem(y, x) : rvt0;
+    if (model.solutionType == SolutionType::stSparse)
+        return y < ssrDC->YRED.get_row() && x < ssrDC->YRED.get_col() ? ssrDC->YRED.get_elem(y, x) : rvt0;
     return rvt0;
 }
+inline uns ComponentSubCircuit::getYDCVersion() const noexcept {
+    const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
+    if (model.solutionType == SolutionType::stFullMatrix && sfmrDC)
+        return sfmrDC->YREDVersion;
+    if (model.solutionType == SolutionType::stSparse && ssrDC)
+        return ssrDC->YREDVersion;
+    return 0;
+}
 inline cplx ComponentSubCircuit::getJreducedAC(uns y) const noexcept {
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
     if (model.solutionType == SolutionType::stFullMatrix)
         return y < sfmrAC->JRED.size() ? sfmrAC->JRED[y] : cplx0;
+    if (model.solutionType == SolutionType::stSparse)
+        return y < ssrAC->JRED.size() ? ssrAC->JRED[y] : cplx0;
     return cplx0;
 }
 inline cplx ComponentSubCircuit::getYAC(uns y, uns x) const noexcept {
     const ModelSubCircuit& model = static_cast<const ModelSubCircuit&>(*pModel);
     if (model.solutionType == SolutionType::stFullMatrix)
         return y < sfmrAC->YRED.get_row() && x < sfmrAC->YRED.get_col() ? sfmrAC->YRED.get_elem(y, x) : cplx0;
+    if (model.solutionType == SolutionType::stSparse)
+        return y < ssrAC->YRED.get_row() && x < ssrAC->YRED.get_col() ? ssrAC->YRED.get_elem(y, x) : cplx0;
     return cplx0;
 }
 //***********************************************************************
@@ -4974,6 +5082,7 @@ class CircuitStorage {
 //***********************************************************************
     friend class Simulation;
     friend class ModelSubCircuit;
+    friend class SubCircuitFullMatrixReductorDC;
 
     //***********************************************************************
     struct Probe {
@@ -4990,6 +5099,7 @@ class CircuitStorage {
     std::vector<std::unique_ptr<hmgSunred::ReductionTreeInstructions>> sunredTrees;
     std::vector<std::unique_ptr<hmgMultigrid>> multiGrids;
     std::vector<std::unique_ptr<HmgFunction>> functions;
+    ReductionCache reductionCache;
     Simulation sim;
     hmgSaver saver;
     std::thread saverThread;
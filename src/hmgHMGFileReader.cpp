@@ -766,7 +766,16 @@ void HMGFileModelDescription::Read(ReadALine& reader, char* line, LineInfo& line
         else if (strcmp(lineToken.getActToken(), "SUNRED") == 0) {
             solutionType = stSunRed;
             lineToken.getNextToken(reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
-            solutionDescriptionIndex = globalNames.sunredTreeNames.at(lineToken.getActToken());
+            if (strcmp(lineToken.getActToken(), "AUTO") == 0)
+                solutionDescriptionIndex = autoSunredTreeIndex;
+            else
+                solutionDescriptionIndex = globalNames.sunredTreeNames.at(lineToken.getActToken());
+        }
+        else if (strcmp(lineToken.getActToken(), "SPARSE") == 0) { // SPARSE=AUTO: minimum degree ordering
+            solutionType = stSparse;
+            lineToken.getNextToken(reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
+            if (strcmp(lineToken.getActToken(), "AUTO") != 0)
+                throw hmgExcept("HMGFileModelDescription::Read", "SPARSE=AUTO expected, SPARSE=%s arrived (%s) in %s, line %u", lineToken.getActToken(), line, reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
         }
         else
             throw hmgExcept("HMGFileModelDescription::Read", "unknown node/parameter type, %s arrived (%s) in %s, line %u", lineToken.getActToken(), line, reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
@@ -1696,6 +1705,7 @@ void HMGFileRun::Read(ReadALine& reader, char* line, LineInfo& lineInfo) {
                 throw hmgExcept("HMGFileRun::Read", "unrecognised ITERS number (%s) in %s, line %u: %s", token, reader.getFileName(lineInfo).c_str(), lineInfo.firstLine, line);
         }
         else if (strcmp(token, "PRE") == 0) data.isPre = true;
+        else if (strcmp(token, "FLOAT") == 0) data.isFloat = true;
         else if (strcmp(token, "ERR") == 0) {
             token = lineToken.getNextToken(reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
             if (!spiceTextToRvt(token, data.err))
@@ -1900,6 +1910,9 @@ void HMGFileSunredTree::ReadOrReplaceBody(ReadALine& reader, char* line, LineInf
                 if( dest.level == 0)
                     throw hmgExcept("HMGFileSunredTree::ReadOrReplaceBody", "destination level cannot be 0: %s in %s, line %u",
                         line, reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
+                if (src1.level >= dest.level || src2.level >= dest.level)
+                    throw hmgExcept("HMGFileSunredTree::ReadOrReplaceBody", "source level must be lower than the destination level: %s in %s, line %u",
+                        line, reader.getFileName(lineInfo).c_str(), lineInfo.firstLine);
 
                 // store
 
@@ -14,6 +14,8 @@
 #include <ratio>
 #include "hmgHMGFileReader.h"
 #include "hmgInstructionQueue.h"
+#include "hmgBenchmark.h"
+#include "hmgSunredTree.h"
 //***********************************************************************
 
 
@@ -669,6 +671,39 @@ int main(int n, const char** params) {
 	Rails::resize(1);
 	Rails::reset();
 	try {
+		while (n > 2 && params[1][0] == '-' && strcmp(params[1], "-bench") != 0) {
+			if (strcmp(params[1], "-threads") == 0) // hexmg -threads <n> ...: the size of the thread pool, 0: all cores
+				ThreadPool::getInstance().setNThreads((unsigned)atoi(params[2]));
+			else if (strcmp(params[1], "-sunred") == 0) { // hexmg -sunred levels|dataflow ...: the scheduling of the SUNRED nodes
+				if (strcmp(params[2], "levels") == 0)
+					hmgSunred::scheduling = ssLevels;
+				else if (strcmp(params[2], "dataflow") == 0)
+					hmgSunred::scheduling = ssDataflow;
+				else
+					throw hmgExcept("main", "unknown -sunred scheduling: %s (levels or dataflow expected)", params[2]);
+			}
+			else if (strcmp(params[1], "-trace") == 0) // hexmg -trace <file> ...: thread utilization of the SUNRED passes
+				hmgSunred::openTrace(params[2]);
+			else if (strcmp(params[1], "-membudget") == 0) // hexmg -membudget <MB> ...: the SUNRED matrices over the budget go to scratch files
+				hmgSunred::memoryBudget = (size_t)(atof(params[2]) * 1048576.0);
+			else if (strcmp(params[1], "-parstamp") == 0) // hexmg -parstamp <n> ...: full matrix subcircuits with at least n components are stamped in parallel
+				SubCircuitFullMatrixReductorDC::parallelMinComponents = (uns)atoi(params[2]);
+			else if (strcmp(params[1], "-sharedred") == 0) // hexmg -sharedred <n> ...: the instances of a full matrix subcircuit with at least n B nodes share the equal reductions, 0: off
+				SubCircuitFullMatrixReductorDC::sharedMinBNodes = (uns)atoi(params[2]);
+			else if (strcmp(params[1], "-redcache") == 0) // hexmg -redcache <MB> ...: memory cap of the cache of the linear full matrix subcircuit reductions, 0: off
+				ReductionCache::memoryCap = (size_t)(atof(params[2]) * 1048576.0);
+			else if (strcmp(params[1], "-treeopt") == 0) // hexmg -treeopt <file> ...: cost of the SUNRED trees, the optimized trees as .SUNREDTREE
+				SunredTreeOptimizer::openOutput(params[2]);
+			else
+				throw hmgExcept("main", "unknown option: %s", params[1]);
+			n -= 2;
+			params += 2;
+		}
+		if (n > 1 && strcmp(params[1], "-bench") == 0) {
+			runBenchmark(n - 2, params + 2);
+			return 0;
+		}
+
 		HmgFileReader reader;
 
 		bench_now("start");
@@ -700,6 +735,8 @@ int main(int n, const char** params) {
 
 		bench_now("stop");
 		bench_print();
+		hmgSunred::closeTrace();
+		SunredTreeOptimizer::closeOutput();
 	}
 	catch (const hmgExcept& err) {
 		std::cerr << err.what() << std::endl;
@@ -13,6 +13,8 @@
 
 //***********************************************************************
 #include "hmgVektor.hpp"
+#include "hmgMatrixKernels.h"
+#include "hmgThreadPool.h"
 //***********************************************************************
 
 
@@ -26,42 +28,93 @@ template<typename datatype> class matrix;
 //***********************************************************************
 
 
+//***********************************************************************
+template<typename datatype> struct matrix_view {
+// non-owning, element (i,j) is arr[i * row_stride + j * col_stride]
+// so a transposed or a sub view needs no copy
+//***********************************************************************
+    datatype* arr = nullptr;
+    unsigned row = 0, col = 0;
+    size_t row_stride = 0, col_stride = 1;
+    //***********************************************************************
+    unsigned get_row() const noexcept { return row; }
+    unsigned get_col() const noexcept { return col; }
+    //***********************************************************************
+    datatype& operator()(unsigned i, unsigned j) const noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        if constexpr (hmgVErrorCheck) {
+            is_smaller_error(i, row, "matrix_view::operator() row");
+            is_smaller_error(j, col, "matrix_view::operator() col");
+        }
+        return arr[i * row_stride + j * col_stride];
+    }
+    //***********************************************************************
+    vektor_view<datatype> row_view(unsigned i) const noexcept { return { arr + i * row_stride, col, col_stride }; }
+    vektor_view<datatype> col_view(unsigned j) const noexcept { return { arr + j * col_stride, row, row_stride }; }
+    matrix_view transposed() const noexcept { return { arr, col, row, col_stride, row_stride }; }
+    operator matrix_view<const datatype>() const noexcept requires (!std::is_const<datatype>::value) { return { arr, row, col, row_stride, col_stride }; }
+    //***********************************************************************
+    matrix_view sub(unsigned start_row, unsigned start_col, unsigned row_no, unsigned col_no) const noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        if (row_no == 0 || col_no == 0)
+            return { nullptr, row_no, col_no, row_stride, col_stride };
+        is_smaller_error(start_row + row_no - 1, row, "matrix_view::sub start_row + row_no");
+        is_smaller_error(start_col + col_no - 1, col, "matrix_view::sub start_col + col_no");
+        return { arr + start_row * row_stride + start_col * col_stride, row_no, col_no, row_stride, col_stride };
+    }
+    //***********************************************************************
+};
+
+
 //***********************************************************************
 template<typename datatype> class matrix {
 //***********************************************************************
     
     //***********************************************************************
-    vektor<datatype> t;
-    vektor< vektor<datatype> > rows;
+    vektor<datatype> t; // row-major; symmetrical: packed upper triangle, row i holds (i,i)...(i,col-1)
     unsigned row, col;
+    size_t ld; // row stride of a nonsymmetrical matrix, col if not layed
     bool is_symm;
     //***********************************************************************
 
     //***********************************************************************
-    void set_rows() {
+    size_t row_offset(unsigned i) const noexcept {
+    // the index of (i,0) in t; in a symmetrical matrix only (i,j>=i) exists, but the offset is counted to (i,0)
     //***********************************************************************
-        rows.set_size(row);
-        if (is_symm) {
-            unsigned start = 0, no = row;
-            for (unsigned i = 0; i < row; i++) {
-                rows[i].lay(t, start - i, col); // so m[i][j] is indeed the element with index i,j, but j>=i is mandatory! 
-                start += no;
-                no--;
-            }
-        }
-        else {
-            for (unsigned i = 0; i < row; i++)
-                rows[i].lay(t, i*col, col);
-        }
+        return is_symm ? size_t(i) * col - (size_t(i) * (i + 1)) / 2 : size_t(i) * ld;
+    }
+    //***********************************************************************
+    vektor<datatype> row_vektor(unsigned i) noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        if constexpr (hmgVErrorCheck) is_smaller_error(i, row, "matrix::row_vektor");
+        return vektor<datatype>(t.data() + row_offset(i), col);
+    }
+    //***********************************************************************
+    const vektor<datatype> row_vektor(unsigned i) const noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        if constexpr (hmgVErrorCheck) is_smaller_error(i, row, "matrix::row_vektor const");
+        return vektor<datatype>(const_cast<datatype*>(t.data()) + row_offset(i), col);
     }
 
     //***********************************************************************
     matrix(const matrix&) = delete;
-    matrix(const matrix&&) = delete;
-    void operator=(const matrix&&) = delete;
     //***********************************************************************
 public:
     
+    //***********************************************************************
+    matrix(matrix&& theother) noexcept :matrix() { swap(theother); }
+    //***********************************************************************
+    matrix& operator=(matrix&& theother) noexcept { if (this != &theother) { clear(); swap(theother); } return *this; }
+    //***********************************************************************
+    void swap(matrix& theother) noexcept {
+    //***********************************************************************
+        t.swap(theother.t);
+        std::swap(row, theother.row);
+        std::swap(col, theother.col);
+        std::swap(ld, theother.ld);
+        std::swap(is_symm, theother.is_symm);
+    }
+    
     //***********************************************************************
     const matrix & operator=(const matrix & theother) {
     // Not lay-proof.
@@ -69,12 +122,12 @@ public:
         t = theother.t;
         row = theother.row;
         col = theother.col;
+        ld = theother.ld;
         is_symm = theother.is_symm;
-        set_rows();
         return *this;
     }
     //***********************************************************************
-    matrix() noexcept :row{ 0 }, col{ 0 }, is_symm{ false } {}
+    matrix() noexcept :row{ 0 }, col{ 0 }, ld{ 0 }, is_symm{ false } {}
     //***********************************************************************
     ~matrix() {}
     //***********************************************************************
@@ -84,19 +137,37 @@ public:
     //***********************************************************************
     bool get_is_symm() const noexcept { return is_symm; }
     //***********************************************************************
+    datatype* kernel_data() noexcept { return row == 0 ? nullptr : t.data(); }
+    //***********************************************************************
+    const datatype* kernel_data() const noexcept { return row == 0 ? nullptr : t.data(); }
+    //***********************************************************************
+    size_t kernel_stride() const noexcept { return ld; } // nonsymmetrical matrices only, also works on a layed matrix
+    //***********************************************************************
+    matrix_view<datatype> view() noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        is_true_error(is_symm, "matrix::view", "symmetrical matrix not allowed");
+        return { kernel_data(), row, col, kernel_stride(), 1 };
+    }
+    //***********************************************************************
+    matrix_view<const datatype> view() const noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        is_true_error(is_symm, "matrix::view const", "symmetrical matrix not allowed");
+        return { kernel_data(), row, col, kernel_stride(), 1 };
+    }
+    //***********************************************************************
     unsigned size() const noexcept { return t.size(); }
     //***********************************************************************
     void clear() noexcept {
     //***********************************************************************
         t.clear();
-        rows.clear();
         row = col = 0;
+        ld = 0;
         is_symm = false;
     }
     //***********************************************************************
     bool refresh_unsafe(unsigned i, const datatype & thenew) noexcept { return t.refresh_unsafe(i, thenew); }
     //***********************************************************************
-    bool refresh_unsafe(unsigned row, unsigned col, const datatype & thenew) noexcept { return rows[row].refresh_unsafe(col, thenew); }
+    bool refresh_unsafe(unsigned row, unsigned col, const datatype & thenew) noexcept { return t.refresh_unsafe((unsigned)(row_offset(row) + col), thenew); }
     //***********************************************************************
     bool refresh_unsafe(const matrix& src) {
     //***********************************************************************
@@ -107,17 +178,38 @@ public:
         return t.refresh_unsafe(src.t);
     }
     //***********************************************************************
-    void set_size(unsigned new_row, unsigned new_col) { clear(); row = new_row; col = new_col; is_symm = false; t.set_size(row*col); set_rows(); }
+    bool refresh_by_swap(matrix& src) {
+    // like refresh_unsafe, but if there is a difference, the storage of the matrices is swapped
+    // instead of copying: src gets the old values. Not lay-proof.
+    //***********************************************************************
+        if (col == 0 || row == 0)
+            return false;
+        if (is_symm != src.is_symm || row != src.row || col != src.col)
+            throw hmgExcept("matrix::refresh_by_swap", "src and dest matrix sizes are different");
+        const datatype* p1 = t.data();
+        const datatype* p2 = src.t.data();
+        const unsigned n = t.size();
+        unsigned i = 0;
+        while (i < n && p1[i] == p2[i])
+            i++;
+        if (i == n)
+            return false;
+        swap(src);
+        return true;
+    }
+    //***********************************************************************
+    // if arena is given, the elements come from the arena (see vektor::set_size)
+    void set_size(unsigned new_row, unsigned new_col, AlignedArena* arena = nullptr) { clear(); row = new_row; col = new_col; ld = col; is_symm = false; t.set_size(row*col, arena); }
     //***********************************************************************
-    void set_size_symm(unsigned new_rowcol) { clear(); row = new_rowcol; col = new_rowcol; is_symm = true; t.set_size((new_rowcol *(new_rowcol + 1)) / 2); set_rows(); }
+    void set_size_symm(unsigned new_rowcol, AlignedArena* arena = nullptr) { clear(); row = new_rowcol; col = new_rowcol; ld = col; is_symm = true; t.set_size((new_rowcol *(new_rowcol + 1)) / 2, arena); }
     //***********************************************************************
-    void resize_if_needed(unsigned new_row, unsigned new_col, bool new_symm) {
+    void resize_if_needed(unsigned new_row, unsigned new_col, bool new_symm, AlignedArena* arena = nullptr) {
     //***********************************************************************
         if (new_row != row || new_col != col || new_symm != is_symm) {
             if (new_symm)
-                set_size_symm(new_row);
+                set_size_symm(new_row, arena);
             else
-                set_size(new_row, new_col);
+                set_size(new_row, new_col, arena);
         }
     }
     //***********************************************************************
@@ -125,19 +217,20 @@ public:
     //***********************************************************************
     void set_size_symm_and_zero(unsigned uj_rowcol) { set_size_symm(uj_rowcol); zero_unsafe(); }
     //***********************************************************************
-    void lay(matrix & theother, unsigned start_row, unsigned start_col, unsigned row_no, unsigned col_no, bool is_symm) {
-    // t will be empty, so the member functions that use t will not work
-    // use rows to address cells
+    void lay(matrix & theother, unsigned start_row, unsigned start_col, unsigned row_no, unsigned col_no) {
+    // this matrix will be a (start_row, start_col, row_no, col_no) window of a nonsymmetrical matrix;
+    // t is not continuous, so the member functions that use t (see "Not lay-proof") will not work
     //***********************************************************************
         is_smaller_error(start_row + row_no - 1, theother.row, "matrix::lay start_row + row_no");
         is_smaller_error(start_col + col_no - 1, theother.col, "matrix::lay start_col + col_no");
+        is_true_error(theother.is_symm, "matrix::lay", "symmetrical matrix not allowed");
         clear();
-        rows.set_size(row_no);
         row = row_no;
         col = col_no;
-        is_symm = is_symm;
-        for (unsigned i = 0; i < row_no; i++)
-            rows[i].lay(theother.rows.unsafe(start_row + i), start_col, col_no); // (vektor & theother, unsigned start, unsigned no)
+        ld = theother.ld;
+        is_symm = false;
+        if (row_no != 0 && col_no != 0)
+            t.lay(theother.t, unsigned(start_row * theother.ld + start_col), unsigned((row_no - 1) * theother.ld + col_no));
     }
     //***********************************************************************
     // Not lay-proof.
@@ -149,27 +242,28 @@ public:
     // Not lay-proof.
     void math_neg_unsafe() noexcept { t.math_neg(); }
     //***********************************************************************
-    vektor<datatype> & operator[](unsigned i) noexcept(!hmgVErrorCheck) { return rows[i]; }
+    // m[i][j] is addressed by the index computed from i and j; in a symmetrical matrix j >= i is mandatory!
+    vektor<datatype> operator[](unsigned i) noexcept(!hmgVErrorCheck) { return row_vektor(i); }
     //***********************************************************************
-    const vektor<datatype> & operator[](unsigned i) const noexcept(!hmgVErrorCheck) { return rows[i]; }
+    const vektor<datatype> operator[](unsigned i) const noexcept(!hmgVErrorCheck) { return row_vektor(i); }
     //***********************************************************************
     const datatype & get_elem(unsigned row, unsigned col) const noexcept {
     //***********************************************************************
         if (is_symm) {// so m[i][j] is indeed the element with index i,j, but j>=i is mandatory!
-            return (col < row) ? rows[col][row] : rows[row][col];
+            return (col < row) ? row_vektor(col)[row] : row_vektor(row)[col];
         }
         else {
-            return rows[row][col];
+            return row_vektor(row)[col];
         }
     }
     //***********************************************************************
     datatype & get_elem(unsigned rw, unsigned cl) noexcept {
     //***********************************************************************
         if (is_symm) {// so m[i][j] is indeed the element with index i,j, but j>=i is mandatory!
-            return (cl < rw) ? rows[cl][rw] : rows[rw][cl];
+            return (cl < rw) ? row_vektor(cl)[rw] : row_vektor(rw)[cl];
         }
         else {
-            return rows[rw][cl];
+            return row_vektor(rw)[cl];
         }
     }
 
@@ -178,7 +272,7 @@ public:
     void debug_write(::std::ofstream & fs) const{
     //***********************************************************************
         for (unsigned i = 0; i < row; i++){
-            rows[i].debug_write(fs);
+            row_vektor(i).debug_write(fs);
         }            
     }
     
@@ -186,7 +280,7 @@ public:
     void print() const{
     //***********************************************************************
         for (unsigned i = 0; i < row; i++){
-            rows[i].print(is_symm ? i : 0);
+            row_vektor(i).print(is_symm ? i : 0);
             ::std::cout << ::std::endl;
         }            
         ::std::cout << ::std::endl;
@@ -196,7 +290,7 @@ public:
     void print_z() const{
     //***********************************************************************
         for (unsigned i = 0; i < row; i++){
-            rows[i].print_z(is_symm ? i : 0);
+            row_vektor(i).print_z(is_symm ? i : 0);
             ::std::cout << ::std::endl;
         }            
         ::std::cout << ::std::endl;
@@ -220,6 +314,12 @@ public:
         is_equal_error(a.col, b_t.col, "math_mul_t col col");
         is_true_error(is_symm || a.is_symm || b_t.is_symm, "matrix::math_mul_t", "symmetrical matrix not allowed");
 
+        if constexpr (hasMatrixKernel<datatype>) {
+            MatrixKernels::mul_t(kernel_data(), kernel_stride(), kernel_data(), kernel_stride(), a.kernel_data(), a.kernel_stride(),
+                b_t.kernel_data(), b_t.kernel_stride(), row, col, a.col, mtmSet);
+            return;
+        }
+
         if (row == 0 || col == 0)
             return;
         const unsigned ni = row, nj = col, nk = a.col;
@@ -294,23 +394,29 @@ public:
         is_equal_error(a.col, b_t.col, "math_mul_t col col");
         is_true_error(is_symm || a.is_symm || b_t.is_symm, "matrix::math_mul_t", "symmetrical matrix not allowed");
 
+        if constexpr (hasMatrixKernel<datatype>) {
+            MatrixKernels::mul_t(kernel_data(), kernel_stride(), kernel_data(), kernel_stride(), a.kernel_data(), a.kernel_stride(),
+                b_t.kernel_data(), b_t.kernel_stride(), row, col, a.col, mtmSet);
+            return;
+        }
+
         const unsigned ni = row, nj = col, nk = a.col;
         const unsigned di = row % 4, dj = col % 4, dk = a.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
         for (unsigned i = 0; i < hi; i += 4) {
-            vektor<datatype> & dest_row_i0 = rows[i + 0];
-            vektor<datatype> & dest_row_i1 = rows[i + 1];
-            vektor<datatype> & dest_row_i2 = rows[i + 2];
-            vektor<datatype> & dest_row_i3 = rows[i + 3];
-            const vektor<datatype> & a_row_i0 = a.rows[i + 0];
-            const vektor<datatype> & a_row_i1 = a.rows[i + 1];
-            const vektor<datatype> & a_row_i2 = a.rows[i + 2];
-            const vektor<datatype> & a_row_i3 = a.rows[i + 3];
+            vektor<datatype> dest_row_i0 = row_vektor(i + 0);
+            vektor<datatype> dest_row_i1 = row_vektor(i + 1);
+            vektor<datatype> dest_row_i2 = row_vektor(i + 2);
+            vektor<datatype> dest_row_i3 = row_vektor(i + 3);
+            const vektor<datatype> & a_row_i0 = a.row_vektor(i + 0);
+            const vektor<datatype> & a_row_i1 = a.row_vektor(i + 1);
+            const vektor<datatype> & a_row_i2 = a.row_vektor(i + 2);
+            const vektor<datatype> & a_row_i3 = a.row_vektor(i + 3);
             for (unsigned j = 0; j < hj; j += 4) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j + 0];
-                const vektor<datatype> & b_row_j1 = b_t.rows[j + 1];
-                const vektor<datatype> & b_row_j2 = b_t.rows[j + 2];
-                const vektor<datatype> & b_row_j3 = b_t.rows[j + 3];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j + 0);
+                const vektor<datatype> & b_row_j1 = b_t.row_vektor(j + 1);
+                const vektor<datatype> & b_row_j2 = b_t.row_vektor(j + 2);
+                const vektor<datatype> & b_row_j3 = b_t.row_vektor(j + 3);
                 datatype d[16] = { datatype() };
                 for (unsigned k = 0; k < hk; k += 4) {
                     d[0]  += a_row_i0[k + 0] * b_row_j0[k + 0] 
@@ -423,7 +529,7 @@ public:
                 dest_row_i3[j + 3] = d[15];
             }
             for (unsigned j = hj; j < nj; j++) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j);
                 datatype d[4] = { datatype() };
                 for (unsigned k = 0; k < nk; k++) {
                     d[0] += a_row_i0[k] * b_row_j0[k];
@@ -438,10 +544,10 @@ public:
             }
         }
         for (unsigned i = hi; i < ni; i++) {
-            vektor<datatype> & dest_row_i = rows[i];
-            const vektor<datatype> & a_row_i = a.rows[i];
+            vektor<datatype> dest_row_i = row_vektor(i);
+            const vektor<datatype> & a_row_i = a.row_vektor(i);
             for (unsigned j = 0; j < nj; j++) {
-                const vektor<datatype> & b_row_j = b_t.rows[j];
+                const vektor<datatype> & b_row_j = b_t.row_vektor(j);
                 datatype d = datatype();
                 for (unsigned k = 0; k < nk; k++)
                     d += a_row_i[k] * b_row_j[k];
@@ -461,23 +567,29 @@ public:
         is_equal_error(a.col, b_t.col, "math_nmul_t col col");
         is_true_error(is_symm || a.is_symm || b_t.is_symm, "matrix::math_nmul_t", "symmetrical matrix not allowed");
 
+        if constexpr (hasMatrixKernel<datatype>) {
+            MatrixKernels::mul_t(kernel_data(), kernel_stride(), kernel_data(), kernel_stride(), a.kernel_data(), a.kernel_stride(),
+                b_t.kernel_data(), b_t.kernel_stride(), row, col, a.col, mtmNeg);
+            return;
+        }
+
         const unsigned ni = row, nj = col, nk = a.col;
         const unsigned di = row % 4, dj = col % 4, dk = a.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
         for (unsigned i = 0; i < hi; i += 4) {
-            vektor<datatype> & dest_row_i0 = rows[i + 0];
-            vektor<datatype> & dest_row_i1 = rows[i + 1];
-            vektor<datatype> & dest_row_i2 = rows[i + 2];
-            vektor<datatype> & dest_row_i3 = rows[i + 3];
-            const vektor<datatype> & a_row_i0 = a.rows[i + 0];
-            const vektor<datatype> & a_row_i1 = a.rows[i + 1];
-            const vektor<datatype> & a_row_i2 = a.rows[i + 2];
-            const vektor<datatype> & a_row_i3 = a.rows[i + 3];
+            vektor<datatype> dest_row_i0 = row_vektor(i + 0);
+            vektor<datatype> dest_row_i1 = row_vektor(i + 1);
+            vektor<datatype> dest_row_i2 = row_vektor(i + 2);
+            vektor<datatype> dest_row_i3 = row_vektor(i + 3);
+            const vektor<datatype> & a_row_i0 = a.row_vektor(i + 0);
+            const vektor<datatype> & a_row_i1 = a.row_vektor(i + 1);
+            const vektor<datatype> & a_row_i2 = a.row_vektor(i + 2);
+            const vektor<datatype> & a_row_i3 = a.row_vektor(i + 3);
             for (unsigned j = 0; j < hj; j += 4) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j + 0];
-                const vektor<datatype> & b_row_j1 = b_t.rows[j + 1];
-                const vektor<datatype> & b_row_j2 = b_t.rows[j + 2];
-                const vektor<datatype> & b_row_j3 = b_t.rows[j + 3];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j + 0);
+                const vektor<datatype> & b_row_j1 = b_t.row_vektor(j + 1);
+                const vektor<datatype> & b_row_j2 = b_t.row_vektor(j + 2);
+                const vektor<datatype> & b_row_j3 = b_t.row_vektor(j + 3);
                 datatype d[16] = { datatype() };
                 for (unsigned k = 0; k < hk; k += 4) {
                     d[0]  += a_row_i0[k + 0] * b_row_j0[k + 0] 
@@ -590,7 +702,7 @@ public:
                 dest_row_i3[j + 3] = -d[15];
             }
             for (unsigned j = hj; j < nj; j++) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j);
                 datatype d[4] = { datatype() };
                 for (unsigned k = 0; k < nk; k++) {
                     d[0] += a_row_i0[k] * b_row_j0[k];
@@ -605,10 +717,10 @@ public:
             }
         }
         for (unsigned i = hi; i < ni; i++) {
-            vektor<datatype> & dest_row_i = rows[i];
-            const vektor<datatype> & a_row_i = a.rows[i];
+            vektor<datatype> dest_row_i = row_vektor(i);
+            const vektor<datatype> & a_row_i = a.row_vektor(i);
             for (unsigned j = 0; j < nj; j++) {
-                const vektor<datatype> & b_row_j = b_t.rows[j];
+                const vektor<datatype> & b_row_j = b_t.row_vektor(j);
                 datatype d = datatype();
                 for (unsigned k = 0; k < nk; k++)
                     d += a_row_i[k] * b_row_j[k];
@@ -634,6 +746,12 @@ public:
         is_equal_error(a.col, b_t.col, "math_add_mul_t col col");
         is_true_error(is_symm || a.is_symm || b_t.is_symm, "matrix::math_add_mul_t", "symmetrical matrix not allowed");
 
+        if constexpr (hasMatrixKernel<datatype>) {
+            MatrixKernels::mul_t(kernel_data(), kernel_stride(), c.kernel_data(), c.kernel_stride(), a.kernel_data(), a.kernel_stride(),
+                b_t.kernel_data(), b_t.kernel_stride(), row, col, a.col, mtmAdd);
+            return;
+        }
+
         const unsigned ni = row, nj = col, nk = a.col;
         const unsigned di = row % 4, dj = col % 4, dk = a.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
@@ -713,27 +831,33 @@ public:
         is_equal_error(a.col, b_t.col, "math_add_mul_t_ col col");
         is_true_error(is_symm || a.is_symm || b_t.is_symm, "matrix::math_add_mul_t_", "symmetrical matrix not allowed");
 
+        if constexpr (hasMatrixKernel<datatype>) {
+            MatrixKernels::mul_t(kernel_data(), kernel_stride(), c.kernel_data(), c.kernel_stride(), a.kernel_data(), a.kernel_stride(),
+                b_t.kernel_data(), b_t.kernel_stride(), row, col, a.col, mtmAdd);
+            return;
+        }
+
         const unsigned ni = row, nj = col, nk = a.col;
         const unsigned di = row % 4, dj = col % 4, dk = a.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
         for (unsigned i = 0; i < hi; i += 4) {
-            vektor<datatype> & dest_row_i0 = rows[i + 0];
-            vektor<datatype> & dest_row_i1 = rows[i + 1];
-            vektor<datatype> & dest_row_i2 = rows[i + 2];
-            vektor<datatype> & dest_row_i3 = rows[i + 3];
-            const vektor<datatype> & a_row_i0 = a.rows[i + 0];
-            const vektor<datatype> & a_row_i1 = a.rows[i + 1];
-            const vektor<datatype> & a_row_i2 = a.rows[i + 2];
-            const vektor<datatype> & a_row_i3 = a.rows[i + 3];
-            const vektor<datatype> & c_sor_i0 = c.rows[i + 0];
-            const vektor<datatype> & c_sor_i1 = c.rows[i + 1];
-            const vektor<datatype> & c_sor_i2 = c.rows[i + 2];
-            const vektor<datatype> & c_sor_i3 = c.rows[i + 3];
+            vektor<datatype> dest_row_i0 = row_vektor(i + 0);
+            vektor<datatype> dest_row_i1 = row_vektor(i + 1);
+            vektor<datatype> dest_row_i2 = row_vektor(i + 2);
+            vektor<datatype> dest_row_i3 = row_vektor(i + 3);
+            const vektor<datatype> & a_row_i0 = a.row_vektor(i + 0);
+            const vektor<datatype> & a_row_i1 = a.row_vektor(i + 1);
+            const vektor<datatype> & a_row_i2 = a.row_vektor(i + 2);
+            const vektor<datatype> & a_row_i3 = a.row_vektor(i + 3);
+            const vektor<datatype> & c_sor_i0 = c.row_vektor(i + 0);
+            const vektor<datatype> & c_sor_i1 = c.row_vektor(i + 1);
+            const vektor<datatype> & c_sor_i2 = c.row_vektor(i + 2);
+            const vektor<datatype> & c_sor_i3 = c.row_vektor(i + 3);
             for (unsigned j = 0; j < hj; j += 4) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j + 0];
-                const vektor<datatype> & b_row_j1 = b_t.rows[j + 1];
-                const vektor<datatype> & b_row_j2 = b_t.rows[j + 2];
-                const vektor<datatype> & b_row_j3 = b_t.rows[j + 3];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j + 0);
+                const vektor<datatype> & b_row_j1 = b_t.row_vektor(j + 1);
+                const vektor<datatype> & b_row_j2 = b_t.row_vektor(j + 2);
+                const vektor<datatype> & b_row_j3 = b_t.row_vektor(j + 3);
                 datatype d[16] = { datatype() };
                 for (unsigned k = 0; k < hk; k += 4) {
                     d[0]  += a_row_i0[k + 0] * b_row_j0[k + 0] 
@@ -846,7 +970,7 @@ public:
                 dest_row_i3[j + 3] = d[15] + c_sor_i3[j + 3];
             }
             for (unsigned j = hj; j < nj; j++) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j);
                 datatype d[4] = { datatype() };
                 for (unsigned k = 0; k < nk; k++) {
                     d[0] += a_row_i0[k] * b_row_j0[k];
@@ -861,11 +985,11 @@ public:
             }
         }
         for (unsigned i = hi; i < ni; i++) {
-            vektor<datatype> & dest_row_i = rows[i];
-            const vektor<datatype> & a_row_i = a.rows[i];
-            const vektor<datatype> & c_sor_i = c.rows[i];
+            vektor<datatype> dest_row_i = row_vektor(i);
+            const vektor<datatype> & a_row_i = a.row_vektor(i);
+            const vektor<datatype> & c_sor_i = c.row_vektor(i);
             for (unsigned j = 0; j < nj; j++) {
-                const vektor<datatype> & b_row_j = b_t.rows[j];
+                const vektor<datatype> & b_row_j = b_t.row_vektor(j);
                 datatype d = datatype();
                 for (unsigned k = 0; k < nk; k++)
                     d += a_row_i[k] * b_row_j[k];
@@ -890,27 +1014,33 @@ public:
         is_equal_error(a.col, b_t.col, "math_sub_mul_t col col");
         is_true_error(is_symm || a.is_symm || b_t.is_symm, "matrix::math_sub_mul_t", "symmetrical matrix not allowed");
 
+        if constexpr (hasMatrixKernel<datatype>) {
+            MatrixKernels::mul_t(kernel_data(), kernel_stride(), c.kernel_data(), c.kernel_stride(), a.kernel_data(), a.kernel_stride(),
+                b_t.kernel_data(), b_t.kernel_stride(), row, col, a.col, mtmSub);
+            return;
+        }
+
         const unsigned ni = row, nj = col, nk = a.col;
         const unsigned di = row % 4, dj = col % 4, dk = a.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
         for (unsigned i = 0; i < hi; i += 4) {
-            vektor<datatype> & dest_row_i0 = rows[i + 0];
-            vektor<datatype> & dest_row_i1 = rows[i + 1];
-            vektor<datatype> & dest_row_i2 = rows[i + 2];
-            vektor<datatype> & dest_row_i3 = rows[i + 3];
-            const vektor<datatype> & a_row_i0 = a.rows[i + 0];
-            const vektor<datatype> & a_row_i1 = a.rows[i + 1];
-            const vektor<datatype> & a_row_i2 = a.rows[i + 2];
-            const vektor<datatype> & a_row_i3 = a.rows[i + 3];
-            const vektor<datatype> & c_sor_i0 = c.rows[i + 0];
-            const vektor<datatype> & c_sor_i1 = c.rows[i + 1];
-            const vektor<datatype> & c_sor_i2 = c.rows[i + 2];
-            const vektor<datatype> & c_sor_i3 = c.rows[i + 3];
+            vektor<datatype> dest_row_i0 = row_vektor(i + 0);
+            vektor<datatype> dest_row_i1 = row_vektor(i + 1);
+            vektor<datatype> dest_row_i2 = row_vektor(i + 2);
+            vektor<datatype> dest_row_i3 = row_vektor(i + 3);
+            const vektor<datatype> & a_row_i0 = a.row_vektor(i + 0);
+            const vektor<datatype> & a_row_i1 = a.row_vektor(i + 1);
+            const vektor<datatype> & a_row_i2 = a.row_vektor(i + 2);
+            const vektor<datatype> & a_row_i3 = a.row_vektor(i + 3);
+            const vektor<datatype> & c_sor_i0 = c.row_vektor(i + 0);
+            const vektor<datatype> & c_sor_i1 = c.row_vektor(i + 1);
+            const vektor<datatype> & c_sor_i2 = c.row_vektor(i + 2);
+            const vektor<datatype> & c_sor_i3 = c.row_vektor(i + 3);
             for (unsigned j = 0; j < hj; j += 4) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j + 0];
-                const vektor<datatype> & b_row_j1 = b_t.rows[j + 1];
-                const vektor<datatype> & b_row_j2 = b_t.rows[j + 2];
-                const vektor<datatype> & b_row_j3 = b_t.rows[j + 3];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j + 0);
+                const vektor<datatype> & b_row_j1 = b_t.row_vektor(j + 1);
+                const vektor<datatype> & b_row_j2 = b_t.row_vektor(j + 2);
+                const vektor<datatype> & b_row_j3 = b_t.row_vektor(j + 3);
                 datatype d[16] = { datatype() };
                 for (unsigned k = 0; k < hk; k += 4) {
                     d[0]  += a_row_i0[k + 0] * b_row_j0[k + 0] 
@@ -1023,7 +1153,7 @@ public:
                 dest_row_i3[j + 3] = c_sor_i3[j + 3] - d[15];
             }
             for (unsigned j = hj; j < nj; j++) {
-                const vektor<datatype> & b_row_j0 = b_t.rows[j];
+                const vektor<datatype> & b_row_j0 = b_t.row_vektor(j);
                 datatype d[4] = { datatype() };
                 for (unsigned k = 0; k < nk; k++) {
                     d[0] += a_row_i0[k] * b_row_j0[k];
@@ -1038,11 +1168,11 @@ public:
             }
         }
         for (unsigned i = hi; i < ni; i++) {
-            vektor<datatype> & dest_row_i = rows[i];
-            const vektor<datatype> & a_row_i = a.rows[i];
-            const vektor<datatype> & c_sor_i = c.rows[i];
+            vektor<datatype> dest_row_i = row_vektor(i);
+            const vektor<datatype> & a_row_i = a.row_vektor(i);
+            const vektor<datatype> & c_sor_i = c.row_vektor(i);
             for (unsigned j = 0; j < nj; j++) {
-                const vektor<datatype> & b_row_j = b_t.rows[j];
+                const vektor<datatype> & b_row_j = b_t.row_vektor(j);
                 datatype d = datatype();
                 for (unsigned k = 0; k < nk; k++)
                     d += a_row_i[k] * b_row_j[k];
@@ -1061,7 +1191,7 @@ public:
         is_true_error(is_symm, "matrix::transp", "symmetrical matrix not allowed");
         for (unsigned i = 0; i < row; i++)
             for (unsigned j = 0; j < col; j++)
-                rows[i][j] = a.rows[j][i];
+                row_vektor(i)[j] = a.row_vektor(j)[i];
     }
 
     
@@ -1076,7 +1206,7 @@ public:
         is_true_error(is_symm, "matrix::copy", "symmetrical matrix not allowed");
         for (unsigned i = 0; i < row; i++)
             for (unsigned j = 0; j < col; j++)
-                rows[i][j] = a.rows[i][j];
+                row_vektor(i)[j] = a.row_vektor(i)[j];
     }
 
     
@@ -1087,6 +1217,21 @@ public:
     }
 
     
+    //***********************************************************************
+    template<typename src_datatype>
+    void convert_unsafe(const matrix<src_datatype>& src) {
+    // resized to the size of src, then every element is converted (e.g. the float copies of the mixed precision reduction)
+    // Not lay-proof.
+    //***********************************************************************
+        resize_if_needed(src.get_row(), src.get_col(), src.get_is_symm());
+        const src_datatype* p = src.kernel_data();
+        datatype* d = kernel_data();
+        const unsigned n = t.size();
+        for (unsigned i = 0; i < n; i++)
+            d[i] = static_cast<datatype>(p[i]);
+    }
+
+    
      //***********************************************************************
     void copy_from_symm_to_nonsymm(const matrix& src) noexcept(!hmgVErrorCheck) {
     // also works on a layed matrix
@@ -1097,9 +1242,9 @@ public:
         is_equal_error(src.row, row, "matrix::copy_from_symm_to_nonsymm row-row");
         is_true_error(is_symm || !src.is_symm, "matrix::copy_from_symm_to_nonsymm", "symmetrical src and non-symmetrical dest required");
         for (unsigned i = 0; i < row; i++) {
-            rows[i][i] = src.rows[i][i];
+            row_vektor(i)[i] = src.row_vektor(i)[i];
             for (unsigned j = i + 1; j < col; j++) {
-                rows[j][i] = rows[i][j] = src.rows[i][j];
+                row_vektor(j)[i] = row_vektor(i)[j] = src.row_vektor(i)[j];
             }
         }
     }
@@ -1120,14 +1265,14 @@ public:
                     if (start_dest_row + no_row - 1 <= start_dest_col) { // the target is completely above the main diagonal
                         if (start_src_row + no_row - 1 <= start_src_col) { // the source is completely above the main diagonal
                             for (unsigned i = 0; i < no_row; i++)
-                                rows.unsafe(start_dest_row + i).subvektor_copy(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                                row_vektor(start_dest_row + i).subvektor_copy(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
                         }
                         else if (start_src_row >= start_src_col + no_col) { // the source is completely under the main diagonal (this is not supposed to happen)
                             unsigned src_row = start_src_row, dest_row = start_dest_row;
                             for (unsigned i = 0; i < no_row; i++, src_row++, dest_row++) {
                                 unsigned src_col = start_src_col, dest_col = start_dest_col;
                                 for (unsigned j = 0; j < no_col; j++, src_col++, dest_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                    row_vektor(dest_row)[dest_col] = src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                             }
                         }
@@ -1137,10 +1282,10 @@ public:
                                 unsigned dest_col = start_dest_col;
                                 const unsigned ig = start_src_col + no_col;
                                 for (unsigned src_col = start_src_col; src_col < src_row && src_col < ig; src_col++, dest_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                    row_vektor(dest_row)[dest_col] = src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                                 for (unsigned src_col = start_src_col > src_row ? start_src_col : src_row; src_col < ig; src_col++, dest_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                    row_vektor(dest_row)[dest_col] = src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                                 }
                             }
                         }
@@ -1152,7 +1297,7 @@ public:
                                 unsigned dest_col = dest_row > start_dest_col ? dest_row : start_dest_col;
                                 unsigned src_col = start_src_col + dest_col - start_dest_col;
                                 for (; dest_col < start_dest_col + no_col; dest_col++, src_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                    row_vektor(dest_row)[dest_col] = src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                                 }
                             }
                         }
@@ -1162,7 +1307,7 @@ public:
                                 unsigned dest_col = dest_row > start_dest_col ? dest_row : start_dest_col;
                                 unsigned src_col = start_src_col + dest_col - start_dest_col;
                                 for (; dest_col < start_dest_col + no_col; dest_col++, src_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                    row_vektor(dest_row)[dest_col] = src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                             }
                         }
@@ -1173,9 +1318,9 @@ public:
                                 unsigned src_col = start_src_col + dest_col - start_dest_col;
                                 for (; dest_col < start_dest_col + no_col; dest_col++, src_col++) {
                                     if (src_col >= src_row)
-                                        rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                        row_vektor(dest_row)[dest_col] = src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                                     else
-                                        rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                        row_vektor(dest_row)[dest_col] = src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                             }
                         }
@@ -1184,7 +1329,7 @@ public:
                 else { // nonsymm => symm (is it possible?)
                     if (start_dest_row + no_row - 1 <= start_dest_col) { // the destination is completely above the main diagonal
                         for (unsigned i = 0; i < no_row; i++)
-                            rows.unsafe(start_dest_row + i).subvektor_copy(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                            row_vektor(start_dest_row + i).subvektor_copy(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
                     }
                     else { // there is also a section below the main diagonal in the destination
                         unsigned src_row = start_src_row, dest_row = start_dest_row;
@@ -1192,7 +1337,7 @@ public:
                             unsigned dest_col = start_dest_col >= dest_row ? start_dest_col : dest_row;
                             unsigned src_col = start_src_col + dest_col - start_dest_col;
                             for (; dest_col < start_dest_col + no_col; src_col++, dest_col++) {
-                                rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                row_vektor(dest_row)[dest_col] = src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                             }
                         }
                     }
@@ -1203,14 +1348,14 @@ public:
             if (src.is_symm) { // symm => nonsyimm
                 if (start_src_row + no_row - 1 <= start_src_col) { // the source is completely above the main diagonal
                     for (unsigned i = 0; i < no_row; i++)
-                        rows.unsafe(start_dest_row + i).subvektor_copy(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                        row_vektor(start_dest_row + i).subvektor_copy(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
                 }
                 else if (start_src_row >= start_src_col + no_col) { // the source is completely under the main diagonal
                     unsigned src_row = start_src_row, dest_row = start_dest_row;
                     for (unsigned i = 0; i < no_row; i++, src_row++, dest_row++) {
                         unsigned src_col = start_src_col, dest_col = start_dest_col;
                         for (unsigned j = 0; j < no_col; j++, src_col++, dest_col++) {
-                            rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                            row_vektor(dest_row)[dest_col] = src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                         }
                     }
                 }
@@ -1220,16 +1365,16 @@ public:
                         unsigned src_col = start_src_col, dest_col = start_dest_col;
                         for (unsigned j = 0; j < no_col; j++, src_col++, dest_col++) {
                             if (src_col >= src_row)
-                                rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                row_vektor(dest_row)[dest_col] = src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                             else
-                                rows.unsafe(dest_row).unsafe(dest_col) = src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                row_vektor(dest_row)[dest_col] = src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                         }
                     }
                 }
             }
             else { // nonsyimm => nonsyimm
                 for (unsigned i = 0; i < no_row; i++)
-                    rows.unsafe(start_dest_row + i).subvektor_copy(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                    row_vektor(start_dest_row + i).subvektor_copy(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
             }
         }
     }
@@ -1250,14 +1395,14 @@ public:
                     if (start_dest_row + no_row - 1 <= start_dest_col) { // the destination is completely above the main diagonal
                         if (start_src_row + no_row - 1 <= start_src_col) { // the source is completely above the main diagonal
                             for (unsigned i = 0; i < no_row; i++)
-                                rows.unsafe(start_dest_row + i).subvektor_pluszegyenlo(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                                row_vektor(start_dest_row + i).subvektor_plus_equal(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
                         }
                         else if (start_src_row >= start_src_col + no_col) { // the source is completely under the main diagonal (this is not supposed to happen)
                             unsigned src_row = start_src_row, dest_row = start_dest_row;
                             for (unsigned i = 0; i < no_row; i++, src_row++, dest_row++) {
                                 unsigned src_col = start_src_col, dest_col = start_dest_col;
                                 for (unsigned j = 0; j < no_col; j++, src_col++, dest_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                    row_vektor(dest_row)[dest_col] += src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                             }
                         }
@@ -1267,10 +1412,10 @@ public:
                                 unsigned dest_col = start_dest_col;
                                 const unsigned ig = start_src_col + no_col;
                                 for (unsigned src_col = start_src_col; src_col < src_row && src_col < ig; src_col++, dest_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                    row_vektor(dest_row)[dest_col] += src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                                 for (unsigned src_col = start_src_col > src_row ? start_src_col : src_row; src_col < ig; src_col++, dest_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                    row_vektor(dest_row)[dest_col] += src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                                 }
                             }
                         }
@@ -1282,7 +1427,7 @@ public:
                                 unsigned dest_col = dest_row > start_dest_col ? dest_row : start_dest_col;
                                 unsigned src_col = start_src_col + dest_col - start_dest_col;
                                 for (; dest_col < start_dest_col + no_col; dest_col++, src_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                    row_vektor(dest_row)[dest_col] += src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                                 }
                             }
                         }
@@ -1292,7 +1437,7 @@ public:
                                 unsigned dest_col = dest_row > start_dest_col ? dest_row : start_dest_col;
                                 unsigned src_col = start_src_col + dest_col - start_dest_col;
                                 for (; dest_col < start_dest_col + no_col; dest_col++, src_col++) {
-                                    rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                    row_vektor(dest_row)[dest_col] += src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                             }
                         }
@@ -1303,9 +1448,9 @@ public:
                                 unsigned src_col = start_src_col + dest_col - start_dest_col;
                                 for (; dest_col < start_dest_col + no_col; dest_col++, src_col++) {
                                     if (src_col >= src_row)
-                                        rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                        row_vektor(dest_row)[dest_col] += src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                                     else
-                                        rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                        row_vektor(dest_row)[dest_col] += src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                                 }
                             }
                         }
@@ -1314,7 +1459,7 @@ public:
                 else { // nonsymm => symm (is it possible?)
                     if (start_dest_row + no_row - 1 <= start_dest_col) { // the destination is completely above the main diagonal
                         for (unsigned i = 0; i < no_row; i++)
-                            rows.unsafe(start_dest_row + i).subvektor_pluszegyenlo(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                            row_vektor(start_dest_row + i).subvektor_plus_equal(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
                     }
                     else { // there is also a section below the main diagonal in the destination
                         unsigned src_row = start_src_row, dest_row = start_dest_row;
@@ -1322,7 +1467,7 @@ public:
                             unsigned dest_col = start_dest_col >= dest_row ? start_dest_col : dest_row;
                             unsigned src_col = start_src_col + dest_col - start_dest_col;
                             for (; dest_col < start_dest_col + no_col; src_col++, dest_col++) {
-                                rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                row_vektor(dest_row)[dest_col] += src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                             }
                         }
                     }
@@ -1333,14 +1478,14 @@ public:
             if (src.is_symm) { // symm => nonsymm
                 if (start_src_row + no_row - 1 <= start_src_col) { // the source is completely above the main diagonal
                     for (unsigned i = 0; i < no_row; i++)
-                        rows.unsafe(start_dest_row + i).subvektor_pluszegyenlo(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                        row_vektor(start_dest_row + i).subvektor_plus_equal(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
                 }
                 else if (start_src_row >= start_src_col + no_col) { // the source is completely under the main diagonal
                     unsigned src_row = start_src_row, dest_row = start_dest_row;
                     for (unsigned i = 0; i < no_row; i++, src_row++, dest_row++) {
                         unsigned src_col = start_src_col, dest_col = start_dest_col;
                         for (unsigned j = 0; j < no_col; j++, src_col++, dest_col++) {
-                            rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                            row_vektor(dest_row)[dest_col] += src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                         }
                     }
                 }
@@ -1350,16 +1495,16 @@ public:
                         unsigned src_col = start_src_col, dest_col = start_dest_col;
                         for (unsigned j = 0; j < no_col; j++, src_col++, dest_col++) {
                             if (src_col >= src_row)
-                                rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_row).unsafe(src_col); // dest(i,j) = src(i,j)
+                                row_vektor(dest_row)[dest_col] += src.row_vektor(src_row)[src_col]; // dest(i,j) = src(i,j)
                             else
-                                rows.unsafe(dest_row).unsafe(dest_col) += src.rows.unsafe(src_col).unsafe(src_row); // dest(i,j) = src(j,i)
+                                row_vektor(dest_row)[dest_col] += src.row_vektor(src_col)[src_row]; // dest(i,j) = src(j,i)
                         }
                     }
                 }
             }
             else { // nonsymm => nonsymm
                 for (unsigned i = 0; i < no_row; i++)
-                    rows.unsafe(start_dest_row + i).subvektor_pluszegyenlo(src.rows.unsafe(start_src_row + i), start_dest_col, start_src_col, no_col);
+                    row_vektor(start_dest_row + i).subvektor_plus_equal(src.row_vektor(start_src_row + i), start_dest_col, start_src_col, no_col);
             }
         }
     }
@@ -1378,7 +1523,7 @@ public:
 
         if (!is_symm && !src_1.is_symm && !src_2.is_symm) {
             for (unsigned i = 0; i < no_row; i++)
-                rows.unsafe(start_dest_row + i).subvektor_add(src_1.rows.unsafe(start_src_1_row + i), src_2.rows.unsafe(start_src_2_row + i), start_dest_col, start_src_1_col, start_src_2_col, no_col);
+                row_vektor(start_dest_row + i).subvektor_add(src_1.row_vektor(start_src_1_row + i), src_2.row_vektor(start_src_2_row + i), start_dest_col, start_src_1_col, start_src_2_col, no_col);
             return;
         }
 
@@ -1397,7 +1542,7 @@ public:
         is_equal_error(dest.size(), src1.get_row(), "vektor math_mul size");
         is_true_error(src1.is_symm, "matrix::math_mul vektor", "symmetrical matrix not allowed");
         for (unsigned i = 0; i < dest.size(); i++)
-            dest[i] = math_mul(src1.rows[i], src2);
+            dest[i] = math_mul(src1.row_vektor(i), src2);
     }
 
 
@@ -1410,7 +1555,7 @@ public:
         is_equal_error(dest.size(), src1.get_row(), "vektor math_mul size");
         is_true_error(src1.is_symm, "matrix::math_add_mul vektor", "symmetrical matrix not allowed");
         for (unsigned i = 0; i < dest.size(); i++)
-            dest[i] = tobeadded[i] + math_mul(src1.rows[i], src2);
+            dest[i] = tobeadded[i] + math_mul(src1.row_vektor(i), src2);
     }
 
 
@@ -1425,10 +1570,10 @@ public:
         for (unsigned row = 0; row < dest.size(); row++) {
             datatype sum = tobeadded[row];
             for (unsigned col = 0; col < row; col++) {
-                sum += src1.rows[col][row] * src2[col]; // (j,i)
+                sum += src1.row_vektor(col)[row] * src2[col]; // (j,i)
             }
             for (unsigned col = row; col < dest.size(); col++) {
-                sum += src1.rows[row][col] * src2[col]; // (i,j)
+                sum += src1.row_vektor(row)[col] * src2[col]; // (i,j)
             }
             dest[row] = sum;
         }
@@ -1465,11 +1610,11 @@ public:
         }
 
         for (unsigned i = 0; i < row; i++){
-            vektor<datatype> & row_i = rows[i];
+            vektor<datatype> row_i = row_vektor(i);
             datatype divisor = abs(row_i[i]) < 1e-20f ? 1e20f : datatype(1.0f) / row_i[i];
             unsigned j;
             for (j = 0; j < i; j++) {
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 datatype C = row_j[i] * divisor;
                 unsigned k;
                 for (k = 0; k < i; k++) row_j[k] -= C * row_i[k];
@@ -1477,7 +1622,7 @@ public:
                 for (k++; k < row; k++) row_j[k] -= C * row_i[k];
             }
             for (j++; j < row; j++) {
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 datatype C = row_j[i] * divisor;
                 unsigned k;
                 for (k = 0; k < i; k++) row_j[k] -= C * row_i[k];
@@ -1500,16 +1645,16 @@ public:
         is_true_error(is_symm, "matrix::math_ninv_np_blokk_2x2", "symmetrical matrix not allowed");
 
         if (row == 1) {
-            rows[0][0] = datatype(-1) / rows[0][0];
+            row_vektor(0)[0] = datatype(-1) / row_vektor(0)[0];
             return;
         }
         if (row == 2) {
-            math_ninv_2x2_fv(&rows[0][0], &rows[1][0]);
+            math_ninv_2x2_fv(&row_vektor(0)[0], &row_vektor(1)[0]);
             return;
         }
 
         if (row == 4) {
-            math_ninv_4x4_fv(&rows[0][0], &rows[1][0], &rows[2][0], &rows[3][0]);
+            math_ninv_4x4_fv(&row_vektor(0)[0], &row_vektor(1)[0], &row_vektor(2)[0], &row_vektor(3)[0]);
             return;
         }
 
@@ -1517,8 +1662,8 @@ public:
         const unsigned hrow = row - drow;
         const unsigned nrow = row;
         for (unsigned i = 0; i < hrow; i += 2){
-            vektor<datatype> & row_i0 = rows[i];
-            vektor<datatype> & row_i1 = rows[i + 1];
+            vektor<datatype> row_i0 = row_vektor(i);
+            vektor<datatype> row_i1 = row_vektor(i + 1);
             
             // (i,i)-nl lv elem inverze
             const datatype p0 = abs(row_i0[i]) < 1e-20f ? 1e20f : datatype(1.0f) / row_i0[i];
@@ -1535,8 +1680,8 @@ public:
 
             unsigned j;
             for (j = 0; j < i; j += 2) {
-                vektor<datatype> & row_j0 = rows[j];
-                vektor<datatype> & row_j1 = rows[j + 1];
+                vektor<datatype> row_j0 = row_vektor(j);
+                vektor<datatype> row_j1 = row_vektor(j + 1);
                 const datatype C0 = row_j0[i] * a0 + row_j0[i + 1] * a2;
                 const datatype C1 = row_j0[i] * a1 + row_j0[i + 1] * a3;
                 const datatype C2 = row_j1[i] * a0 + row_j1[i + 1] * a2;
@@ -1564,8 +1709,8 @@ public:
                 }
             }
             for (j+=2; j < hrow; j += 2) {
-                vektor<datatype> & row_j0 = rows[j];
-                vektor<datatype> & row_j1 = rows[j + 1];
+                vektor<datatype> row_j0 = row_vektor(j);
+                vektor<datatype> row_j1 = row_vektor(j + 1);
                 const datatype C0 = row_j0[i] * a0 + row_j0[i + 1] * a2;
                 const datatype C1 = row_j0[i] * a1 + row_j0[i + 1] * a3;
                 const datatype C2 = row_j1[i] * a0 + row_j1[i + 1] * a2;
@@ -1593,7 +1738,7 @@ public:
                 }
             }
             for (j = hrow; j < nrow; j++) {
-                vektor<datatype> & row_j0 = rows[j];
+                vektor<datatype> row_j0 = row_vektor(j);
                 const datatype C0 = row_j0[i] * a0 + row_j0[i + 1] * a2;
                 const datatype C1 = row_j0[i] * a1 + row_j0[i + 1] * a3;
                 unsigned k;
@@ -1643,11 +1788,11 @@ public:
             }
         }
         for (unsigned i = hrow; i < nrow; i++) {
-            vektor<datatype> & row_i = rows[i];
+            vektor<datatype> row_i = row_vektor(i);
             datatype divisor = abs(row_i[i]) < 1e-20f ? 1e20f : datatype(1.0f) / row_i[i];
             unsigned j;
             for (j = 0; j < i; j++) {
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 datatype C = row_j[i] * divisor;
                 unsigned k;
                 for (k = 0; k < i; k++) row_j[k] -= C * row_i[k];
@@ -1655,7 +1800,7 @@ public:
                 for (k++; k < row; k++) row_j[k] -= C * row_i[k];
             }
             for (j++; j < row; j++) {
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 datatype C = row_j[i] * divisor;
                 unsigned k;
                 for (k = 0; k < i; k++) row_j[k] -= C * row_i[k];
@@ -1866,26 +2011,37 @@ public:
         is_true_error(is_symm, "matrix::math_ninv_np", "symmetrical matrix not allowed");
 
         if (row == 1) {
-            rows[0][0] = datatype(-1) / rows[0][0];
+            row_vektor(0)[0] = datatype(-1) / row_vektor(0)[0];
             return;
         }
         if (row == 2) {
-            math_ninv_2x2_fv(&rows[0][0], &rows[1][0]);
+            math_ninv_2x2_fv(&row_vektor(0)[0], &row_vektor(1)[0]);
             return;
         }
         if (row == 4) {
-            math_ninv_4x4_fv(&rows[0][0], &rows[1][0], &rows[2][0], &rows[3][0]);
+            math_ninv_4x4_fv(&row_vektor(0)[0], &row_vektor(1)[0], &row_vektor(2)[0], &row_vektor(3)[0]);
             return;
         }
 
+        if constexpr (::std::is_same<datatype, ::std::complex<double>>::value) {
+            MatrixKernels::cninv_np(kernel_data(), kernel_stride(), row);
+            return;
+        }
+        else if constexpr (hasRealMatrixKernel<datatype>) {
+            if (MatrixKernels::isBlockedInvSize(row)) {
+                MatrixKernels::ninv_np(kernel_data(), kernel_stride(), row);
+                return;
+            }
+        }
+
         const unsigned drow = row % 4;
         const unsigned hrow = row - drow;
         const unsigned nrow = row;
         for (unsigned i = 0; i < hrow; i += 4){
-            vektor<datatype> & row_i0 = rows[i];
-            vektor<datatype> & row_i1 = rows[i + 1];
-            vektor<datatype> & row_i2 = rows[i + 2];
-            vektor<datatype> & row_i3 = rows[i + 3];
+            vektor<datatype> row_i0 = row_vektor(i);
+            vektor<datatype> row_i1 = row_vektor(i + 1);
+            vektor<datatype> row_i2 = row_vektor(i + 2);
+            vektor<datatype> row_i3 = row_vektor(i + 3);
 
             // inverse of the element at (i,i)
             datatype a0[4], a1[4], a2[4], a3[4];
@@ -1897,10 +2053,10 @@ public:
 
             unsigned j;
             for (j = 0; j < i; j += 4) {
-                vektor<datatype> & row_j0 = rows[j];
-                vektor<datatype> & row_j1 = rows[j + 1];
-                vektor<datatype> & row_j2 = rows[j + 2];
-                vektor<datatype> & row_j3 = rows[j + 3];
+                vektor<datatype> row_j0 = row_vektor(j);
+                vektor<datatype> row_j1 = row_vektor(j + 1);
+                vektor<datatype> row_j2 = row_vektor(j + 2);
+                vektor<datatype> row_j3 = row_vektor(j + 3);
                 const datatype C00 = row_j0[i] * a0[0] + row_j0[i + 1] * a1[0] + row_j0[i + 2] * a2[0] + row_j0[i + 3] * a3[0];
                 const datatype C01 = row_j0[i] * a0[1] + row_j0[i + 1] * a1[1] + row_j0[i + 2] * a2[1] + row_j0[i + 3] * a3[1];
                 const datatype C02 = row_j0[i] * a0[2] + row_j0[i + 1] * a1[2] + row_j0[i + 2] * a2[2] + row_j0[i + 3] * a3[2];
@@ -1966,10 +2122,10 @@ public:
                 }
             }
             for (j+=4; j < hrow; j += 4) {
-                vektor<datatype> & row_j0 = rows[j];
-                vektor<datatype> & row_j1 = rows[j + 1];
-                vektor<datatype> & row_j2 = rows[j + 2];
-                vektor<datatype> & row_j3 = rows[j + 3];
+                vektor<datatype> row_j0 = row_vektor(j);
+                vektor<datatype> row_j1 = row_vektor(j + 1);
+                vektor<datatype> row_j2 = row_vektor(j + 2);
+                vektor<datatype> row_j3 = row_vektor(j + 3);
                 const datatype C00 = row_j0[i] * a0[0] + row_j0[i + 1] * a1[0] + row_j0[i + 2] * a2[0] + row_j0[i + 3] * a3[0];
                 const datatype C01 = row_j0[i] * a0[1] + row_j0[i + 1] * a1[1] + row_j0[i + 2] * a2[1] + row_j0[i + 3] * a3[1];
                 const datatype C02 = row_j0[i] * a0[2] + row_j0[i + 1] * a1[2] + row_j0[i + 2] * a2[2] + row_j0[i + 3] * a3[2];
@@ -2035,7 +2191,7 @@ public:
                 }
             }
             for (j = hrow; j < nrow; j++) {
-                vektor<datatype> & row_j0 = rows[j];
+                vektor<datatype> row_j0 = row_vektor(j);
                 const datatype C00 = row_j0[i] * a0[0] + row_j0[i + 1] * a1[0] + row_j0[i + 2] * a2[0] + row_j0[i + 3] * a3[0];
                 const datatype C01 = row_j0[i] * a0[1] + row_j0[i + 1] * a1[1] + row_j0[i + 2] * a2[1] + row_j0[i + 3] * a3[1];
                 const datatype C02 = row_j0[i] * a0[2] + row_j0[i + 1] * a1[2] + row_j0[i + 2] * a2[2] + row_j0[i + 3] * a3[2];
@@ -2118,11 +2274,11 @@ public:
             }
         }
         for (unsigned i = hrow; i < nrow; i++) {
-            vektor<datatype> & row_i = rows[i];
+            vektor<datatype> row_i = row_vektor(i);
             datatype divisor = abs(row_i[i]) < 1e-20f ? 1e20f : datatype(1.0f) / row_i[i];
             unsigned j;
             for (j = 0; j < i; j++) {
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 datatype C = row_j[i] * divisor;
                 unsigned k;
                 for (k = 0; k < i; k++) row_j[k] -= C * row_i[k];
@@ -2130,7 +2286,7 @@ public:
                 for (k++; k < row; k++) row_j[k] -= C * row_i[k];
             }
             for (j++; j < row; j++) {
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 datatype C = row_j[i] * divisor;
                 unsigned k;
                 for (k = 0; k < i; k++) row_j[k] -= C * row_i[k];
@@ -2155,45 +2311,43 @@ public:
 
         const unsigned S2 = row + row;
         unsigned *x = new unsigned[S2], *y = x + row;
-        for (unsigned i = 0; i < S2; i++) x[i] = ~0;
+        for (unsigned i = 0; i < S2; i++) x[i] = ~0u;
 
         for (unsigned i = 0; i < row; i++) {
 
             // choosing pivot
 
-            vektor<datatype> & row_i = rows[i];
+            vektor<datatype> row_i = row_vektor(i);
             double diff = 0.0;
-            unsigned V = ~0;
+            unsigned V = ~0u;
             unsigned j;
-            for (j = 0; j < row; j++) if (x[j] == ~0) {
+            for (j = 0; j < row; j++) if (x[j] == ~0u) {
                 double temp = abs(row_i[j]);
                 if (temp>diff) { diff = temp; V = j; }//v-edik oszlopot vlasztjuk
             }
-            if ((V == ~0) || (diff == 0))
+            if ((V == ~0u) || (diff == 0))
                 throw hmgExcept("matrix::math_inv_p", "singular matrix");
             x[V] = i;
             y[i] = V;
 
             // element replace
 
-            datatype A = datatype(1.0) / row_i.unsafe(V);
+            datatype A = datatype(1.0) / row_i[V];
 
-            for (j = 0; j < i; j++) {
-                vektor<datatype> & row_j = rows[j];
-                datatype C = -row_j.unsafe(V) * A;
-                unsigned k;
-                for (k = 0; k < V; k++)row_j[k] += C*row_i[k];
-                row_j[k] = C;
-                for (k++; k < row; k++)row_j[k] += C*row_i[k];
-            }
-            for (j++; j < row; j++) {
-                vektor<datatype> & row_j = rows[j];
-                datatype C = -row_j.unsafe(V) * A;
-                unsigned k;
-                for (k = 0; k < V; k++)row_j[k] += C*row_i[k];
-                row_j[k] = C;
-                for (k++; k < row; k++)row_j[k] += C*row_i[k];
-            }
+            auto replaceRows = [&](unsigned begin, unsigned end) {
+                for (unsigned j = begin; j < end; j++) if (j != i) {
+                    vektor<datatype> row_j = row_vektor(j);
+                    datatype C = -row_j[V] * A;
+                    unsigned k;
+                    for (k = 0; k < V; k++)row_j[k] += C*row_i[k];
+                    row_j[k] = C;
+                    for (k++; k < row; k++)row_j[k] += C*row_i[k];
+                }
+            };
+            if (MatrixKernels::isBlockedInvSize(row))
+                ThreadPool::getInstance().parallelFor(row, replaceRows);
+            else
+                replaceRows(0, row);
             for (j = 0;j<V;j++)row_i[j] *= A;
             row_i[j] = A;
             for (j++; j < row; j++)row_i[j] *= A;
@@ -2201,15 +2355,14 @@ public:
 
         // Order rows and columns
 
-        datatype * N = &t[0];
         unsigned i;
         for (i = 0; i < row; i++) {
             unsigned j;
             for (j = i; y[j] != i; j++)
                 ;
             if (i != j) {
-                vektor<datatype> & row_i = rows[i];
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_i = row_vektor(i);
+                vektor<datatype> row_j = row_vektor(j);
                 for (unsigned k = 0; k < row; k++) { datatype temp = row_i[k]; row_i[k] = row_j[k]; row_j[k] = temp; }
                 y[j] = y[i];
             }
@@ -2220,7 +2373,7 @@ public:
                 ;
             if (i != j) {
                 for (unsigned k = 0; k < row; k++) { 
-                    vektor<datatype> & sor_k = rows[k]; 
+                    vektor<datatype> sor_k = row_vektor(k); 
                     datatype temp  = sor_k[i];
                     sor_k[i] = sor_k[j];
                     sor_k[j] = temp; 
@@ -2248,31 +2401,31 @@ public:
         is_true_error(is_symm, "matrix::identity", "symmetrical matrix not allowed");
         t.zero();
         for (unsigned i = 0; i < row; i++)
-            rows[i][i] = 1.0;
+            row_vektor(i)[i] = 1.0;
     }
 
     //***********************************************************************
     void math_1_ninv_mul(matrix & yb, const matrix & xa) noexcept {
     // yb is 1x1, this is inverted and puts zb*xa inside itself
     //***********************************************************************
-        const datatype nzb = datatype(-1) / yb.rows[0][0];
-        yb.rows[0][0] = nzb;
+        const datatype nzb = datatype(-1) / yb.row_vektor(0)[0];
+        yb.row_vektor(0)[0] = nzb;
         if (col == 0 || row == 0)
             return;
         for (unsigned i = 0; i < col; i++)
-            rows[0][i] = nzb*xa.rows[0][i];
+            row_vektor(0)[i] = nzb*xa.row_vektor(0)[i];
     }
 
     //***********************************************************************
     void math_1_ninv_mulT(matrix & yb, const matrix & xat) noexcept {
     // yb is 1x1, this is inverted and puts zb*xa inside itself
     //***********************************************************************
-        const datatype nzb = datatype(-1) / yb.rows[0][0];
-        yb.rows[0][0] = nzb;
+        const datatype nzb = datatype(-1) / yb.row_vektor(0)[0];
+        yb.row_vektor(0)[0] = nzb;
         if (col == 0 || row == 0)
             return;
         for (unsigned i = 0; i < col; i++)
-            rows[0][i] = nzb*xat.rows[i][0];
+            row_vektor(0)[i] = nzb*xat.row_vektor(i)[0];
     }
 
     //***********************************************************************
@@ -2280,8 +2433,8 @@ public:
     // yb is 2x2, this is inverted and puts zb*xa inside itself
     //***********************************************************************
         is_true_error(yb.is_symm, "matrix::math_2_ninv_mul", "symmetrical matrix not allowed");
-        datatype * in0 = &yb.rows[0][0];
-        datatype * in1 = &yb.rows[1][0];
+        datatype * in0 = &yb.row_vektor(0)[0];
+        datatype * in1 = &yb.row_vektor(1)[0];
         const datatype p0 = abs(in0[0]) < 1e-20f ? 1e20f : datatype(1.0f) / in0[0];
         const datatype p2 = -in1[0] * p0;
         const datatype p1 = in0[1] * p0;
@@ -2295,10 +2448,10 @@ public:
 
         if (col == 0 || row == 0)
             return;
-        vektor<datatype> & nzbxa0 = rows[0];
-        vektor<datatype> & nzbxa1 = rows[1];
-        const vektor<datatype> & xa0 = xa.rows[0];
-        const vektor<datatype> & xa1 = xa.rows[1];
+        vektor<datatype> nzbxa0 = row_vektor(0);
+        vektor<datatype> nzbxa1 = row_vektor(1);
+        const vektor<datatype> & xa0 = xa.row_vektor(0);
+        const vektor<datatype> & xa1 = xa.row_vektor(1);
         for (unsigned i = 0; i < col; i++) {
             nzbxa0[i] = nzb00 * xa0[i] + nzb01 * xa1[i];
             nzbxa1[i] = nzb10 * xa0[i] + nzb11 * xa1[i];
@@ -2310,8 +2463,8 @@ public:
     // yb is 2x2, this is inverted and puts zb*xa inside itself
     //***********************************************************************
         is_true_error(yb.is_symm, "matrix::math_2_ninv_mul", "symmetrical matrix not allowed");
-        datatype * in0 = &yb.rows[0][0];
-        datatype * in1 = &yb.rows[1][0];
+        datatype * in0 = &yb.row_vektor(0)[0];
+        datatype * in1 = &yb.row_vektor(1)[0];
         const datatype p0 = abs(in0[0]) < 1e-20f ? 1e20f : datatype(1.0f) / in0[0];
         const datatype p2 = -in1[0] * p0;
         const datatype p1 = in0[1] * p0;
@@ -2325,8 +2478,8 @@ public:
 
         if (col == 0 || row == 0)
             return;
-        vektor<datatype> & nzbxa0 = rows[0];
-        vektor<datatype> & nzbxa1 = rows[1];
+        vektor<datatype> nzbxa0 = row_vektor(0);
+        vektor<datatype> nzbxa1 = row_vektor(1);
         for (unsigned i = 0; i < col; i++) {
             nzbxa0[i] = nzb00 * xat[i][0] + nzb01 * xat[i][1];
             nzbxa1[i] = nzb10 * xat[i][0] + nzb11 * xat[i][1];
@@ -2338,8 +2491,8 @@ public:
     // yb is 2x2, stored whole symmetrical, this is inverted and puts zb*xa inside itself
     //***********************************************************************
         is_true_error(yb.is_symm, "matrix::math_2_ninv_mul", "symmetrical matrix not allowed");
-        datatype * in0 = &yb.rows[0][0];
-        datatype * in1 = &yb.rows[1][0];
+        datatype * in0 = &yb.row_vektor(0)[0];
+        datatype * in1 = &yb.row_vektor(1)[0];
         const datatype p0 = abs(in0[0]) < 1e-20f ? 1e20f : datatype(1.0f) / in0[0];
         const datatype p2 = -in0[1] * p0;
         const datatype p3 = in1[1] + p2 * in0[1];
@@ -2351,10 +2504,10 @@ public:
 
         if (col == 0 || row == 0)
             return;
-        vektor<datatype> & nzbxa0 = rows[0];
-        vektor<datatype> & nzbxa1 = rows[1];
-        const vektor<datatype> & xa0 = xa.rows[0];
-        const vektor<datatype> & xa1 = xa.rows[1];
+        vektor<datatype> nzbxa0 = row_vektor(0);
+        vektor<datatype> nzbxa1 = row_vektor(1);
+        const vektor<datatype> & xa0 = xa.row_vektor(0);
+        const vektor<datatype> & xa1 = xa.row_vektor(1);
         for (unsigned i = 0; i < col; i++) {
             nzbxa0[i] = nzb00 * xa0[i] + nzb01 * xa1[i];
             nzbxa1[i] = nzb01 * xa0[i] + nzb11 * xa1[i];
@@ -2366,8 +2519,8 @@ public:
     // yb is 2x2, stored whole symmetrical, this is inverted and puts zb*xa inside itself
     //***********************************************************************
         is_true_error(yb.is_symm, "matrix::math_2_ninv_mul", "symmetrical matrix not allowed");
-        datatype * in0 = &yb.rows[0][0];
-        datatype * in1 = &yb.rows[1][0];
+        datatype * in0 = &yb.row_vektor(0)[0];
+        datatype * in1 = &yb.row_vektor(1)[0];
         const datatype p0 = abs(in0[0]) < 1e-20f ? 1e20f : datatype(1.0f) / in0[0];
         const datatype p2 = -in0[1] * p0;
         const datatype p3 = in1[1] + p2 * in0[1];
@@ -2379,10 +2532,10 @@ public:
 
         if (col == 0 || row == 0)
             return;
-        vektor<datatype> & nzbxa0 = rows[0];
-        vektor<datatype> & nzbxa1 = rows[1];
-        //const vektor<datatype> & xa0 = xa.rows[0];
-        //const vektor<datatype> & xa1 = xa.rows[1];
+        vektor<datatype> nzbxa0 = row_vektor(0);
+        vektor<datatype> nzbxa1 = row_vektor(1);
+        //const vektor<datatype> & xa0 = xa.row_vektor(0);
+        //const vektor<datatype> & xa1 = xa.row_vektor(1);
         for (unsigned i = 0; i < col; i++) {
             nzbxa0[i] = nzb00 * xat[i][0] + nzb01 * xat[i][1];
             nzbxa1[i] = nzb01 * xat[i][0] + nzb11 * xat[i][1];
@@ -2397,9 +2550,9 @@ public:
             return;
         is_true_error(ya.is_symm || is_symm, "matrix::math_1_add_mul", "symmetrical matrix not allowed");
         for (unsigned i = 0; i < row; i++) {
-            const datatype xbe = xb.rows[i][0];
+            const datatype xbe = xb.row_vektor(i)[0];
             for (unsigned j = 0; j < col; j++)
-                rows[i][j] = ya.rows[i][j] + xbe * nzbxa.rows[0][j];
+                row_vektor(i)[j] = ya.row_vektor(i)[j] + xbe * nzbxa.row_vektor(0)[j];
         }
     }
 
@@ -2411,9 +2564,9 @@ public:
             return;
         is_true_error(!ya.is_symm || !is_symm, "matrix::math_1_add_mul_symm", "nonsymmetrical matrix not allowed");
         for (unsigned i = 0; i < row; i++) {
-            const datatype xbe = xb.rows[i][0];
+            const datatype xbe = xb.row_vektor(i)[0];
             for (unsigned j = i; j < col; j++)
-                rows[i][j] = ya.rows[i][j] + xbe * nzbxa.rows[0][j];
+                row_vektor(i)[j] = ya.row_vektor(i)[j] + xbe * nzbxa.row_vektor(0)[j];
         }
     }
 
@@ -2424,13 +2577,13 @@ public:
         if (col == 0 || row == 0)
             return;
         is_true_error(ya.is_symm || is_symm, "matrix::math_2_add_mul", "symmetrical matrix not allowed");
-        const vektor<datatype> & nzbxa0 = nzbxa.rows[0];
-        const vektor<datatype> & nzbxa1 = nzbxa.rows[1];
+        const vektor<datatype> & nzbxa0 = nzbxa.row_vektor(0);
+        const vektor<datatype> & nzbxa1 = nzbxa.row_vektor(1);
         for (unsigned i = 0; i < row; i++) {
-            const datatype xb0 = xb.rows[i][0];
-            const datatype xb1 = xb.rows[i][1];
+            const datatype xb0 = xb.row_vektor(i)[0];
+            const datatype xb1 = xb.row_vektor(i)[1];
             for (unsigned j = 0; j < col; j++)
-                rows[i][j] = ya.rows[i][j] + xb0 * nzbxa0[j] + xb1 * nzbxa1[j];
+                row_vektor(i)[j] = ya.row_vektor(i)[j] + xb0 * nzbxa0[j] + xb1 * nzbxa1[j];
         }
     }
 
@@ -2441,13 +2594,13 @@ public:
         if (col == 0 || row == 0)
             return;
         is_true_error(!ya.is_symm || !is_symm, "matrix::math_2_add_mul_symm", "symmetrical matrix not allowed");
-        const vektor<datatype> & nzbxa0 = nzbxa.rows[0];
-        const vektor<datatype> & nzbxa1 = nzbxa.rows[1];
+        const vektor<datatype> & nzbxa0 = nzbxa.row_vektor(0);
+        const vektor<datatype> & nzbxa1 = nzbxa.row_vektor(1);
         for (unsigned i = 0; i < row; i++) {
-            const datatype xb0 = xb.rows[i][0];
-            const datatype xb1 = xb.rows[i][1];
+            const datatype xb0 = xb.row_vektor(i)[0];
+            const datatype xb1 = xb.row_vektor(i)[1];
             for (unsigned j = i; j < col; j++)
-                rows[i][j] = ya.rows[i][j] + xb0 * nzbxa0[j] + xb1 * nzbxa1[j];
+                row_vektor(i)[j] = ya.row_vektor(i)[j] + xb0 * nzbxa0[j] + xb1 * nzbxa1[j];
         }
     }
 
@@ -2455,7 +2608,7 @@ public:
     friend inline void math_1x1_mul(vektor<datatype> & nzbjb, const matrix & nzb, const vektor<datatype> & jb) noexcept {
     // everithing is 1 sized
     //***********************************************************************
-        nzbjb[0] = nzb.rows[0][0] * jb[0];
+        nzbjb[0] = nzb.row_vektor(0)[0] * jb[0];
     }
 
     //***********************************************************************
@@ -2463,8 +2616,8 @@ public:
     // nzb is 2x2
     //***********************************************************************
         is_true_error(nzb.is_symm, "math_2x2_mul", "symmetrical matrix not allowed");
-        nzbjb[0] = nzb.rows[0][0] * jb[0] + nzb.rows[0][1] * jb[1];
-        nzbjb[1] = nzb.rows[1][0] * jb[0] + nzb.rows[1][1] * jb[1];
+        nzbjb[0] = nzb.row_vektor(0)[0] * jb[0] + nzb.row_vektor(0)[1] * jb[1];
+        nzbjb[1] = nzb.row_vektor(1)[0] * jb[0] + nzb.row_vektor(1)[1] * jb[1];
     }
 
     //***********************************************************************
@@ -2473,7 +2626,7 @@ public:
     //***********************************************************************
         const datatype a = nzbjb[0];
         for (unsigned i = 0; i < jred.size(); i++)
-            jred[i] = ja[i] + xb.rows[i][0] * a;
+            jred[i] = ja[i] + xb.row_vektor(i)[0] * a;
     }
 
     //***********************************************************************
@@ -2483,22 +2636,22 @@ public:
         const datatype a0 = nzbjb[0];
         const datatype a1 = nzbjb[1];
         for (unsigned i = 0; i < jred.size(); i++)
-            jred[i] = ja[i] + xb.rows[i][0] * a0 + xb.rows[i][1] * a1;
+            jred[i] = ja[i] + xb.row_vektor(i)[0] * a0 + xb.row_vektor(i)[1] * a1;
     }
 
     //***********************************************************************
     friend inline void math_1_add_mul_ub(vektor<datatype> & ub, const vektor<datatype> & nzbjb, const matrix & nzbxa, const vektor<datatype> & UA) noexcept {
     // size of ub is 1
     //***********************************************************************
-        ub[0] = nzbjb[0] + math_mul(nzbxa.rows[0], UA);
+        ub[0] = nzbjb[0] + math_mul(nzbxa.row_vektor(0), UA);
     }
 
     //***********************************************************************
     friend inline void math_2_add_mul_ub(vektor<datatype> & ub, const vektor<datatype> & nzbjb, const matrix & nzbxa, const vektor<datatype> & UA) noexcept {
     // size of ub is 2
     //***********************************************************************
-        ub[0] = nzbjb[0] + math_mul(nzbxa.rows[0], UA);
-        ub[1] = nzbjb[1] + math_mul(nzbxa.rows[1], UA);
+        ub[0] = nzbjb[0] + math_mul(nzbxa.row_vektor(0), UA);
+        ub[1] = nzbjb[1] + math_mul(nzbxa.row_vektor(1), UA);
     }
     
     //***********************************************************************
@@ -2511,12 +2664,12 @@ public:
 #define NEWSUBSTITUTOR 32
 
         if (row == 1) {
-            rows[0][0] = datatype(-1) / rows[0][0];
+            row_vektor(0)[0] = datatype(-1) / row_vektor(0)[0];
             return;
         }
         if (row == 2) {
-            datatype * const ps0 = &rows[0][0];
-            datatype * const ps1 = &rows[1][0];
+            datatype * const ps0 = &row_vektor(0)[0];
+            datatype * const ps1 = &row_vektor(1)[0];
             datatype p0 = abs(ps0[0]) < 1e-20f ? 1e20f : datatype(1.0f) / ps0[0];
             datatype p2 = -ps0[1] * p0;
             datatype p3 = ps1[1] + p2 * ps0[1];
@@ -2532,22 +2685,22 @@ public:
         unsigned i, j, k;
 
         for (i = 0; i < row; i++) {
-            vektor<datatype> & row_i = rows[i];
+            vektor<datatype> row_i = row_vektor(i);
             datatype & pivot = row_i[i];
             datatype divisor = abs(pivot) < 1e-20f ? 1e20f : datatype(1.0f) / pivot;
-            for (k = 0; k < i; ++k) { datatype & v = rows[k][i]; b0[k] = v;	    bs[k] = v *= divisor; }
+            for (k = 0; k < i; ++k) { datatype & v = row_vektor(k)[i]; b0[k] = v;	    bs[k] = v *= divisor; }
                                                                  b0[k] = pivot;	bs[k] = pivot = -divisor;
             for (k++; k < row; k++) { datatype & v = row_i[k];   b0[k] = v;	    bs[k] = v *= divisor; }
 
             for (j = 0; j < i; j++) {//from j=0 to i-1
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 const datatype x = b0[j]; // jth element of row i
                 const datatype x2 = row_j[i]; // ith element of row j
                 for (k = j; k < row; k++) row_j[k] -= x*bs[k];
                 row_j[i] = x2;
             }
             for (j++; j < row; j++) {//from j=i+1 to S-1
-                vektor<datatype> & row_j = rows[j];
+                vektor<datatype> row_j = row_vektor(j);
                 const datatype x = b0[j];
                 for (k = j; k < row; k++) row_j[k] -= x*bs[k];//k!=i is always true because the loop starts from j=i+1
             }
@@ -2566,7 +2719,7 @@ public:
         is_equal_error(row, col, "matrix::symmetrize_from_upper");
         for (unsigned i = 1; i < col; i++)
             for (unsigned j = 0; j < i; j++) {
-                rows[i][j] = rows[j][i];
+                row_vektor(i)[j] = row_vektor(j)[i];
             }
     }
 
@@ -2581,18 +2734,38 @@ public:
         is_equal_error(nzbxat.row, col, "math_add_mul_t_symm row col");
         is_equal_error(xb.col, nzbxat.col, "math_add_mul_t_symm col col");
 
+        if constexpr (hasRealMatrixKernel<datatype>) {
+            // row by row, because the rows of a symmetrical matrix have different strides
+            const size_t ldb = nzbxat.kernel_stride();
+            const datatype* b_t = nzbxat.kernel_data();
+            for (unsigned i = 0; i < row; i++)
+                MatrixKernels::mul_t(row_vektor(i).data() + i, 0, ya.row_vektor(i).data() + i, 0, xb.row_vektor(i).data(), 0,
+                    b_t + i * ldb, ldb, 1, col - i, xb.col, mtmAdd);
+            return;
+        }
+        else if constexpr (::std::is_same<datatype, ::std::complex<double>>::value) {
+            static thread_local SplitComplexPanel xbPanel, nzbxatPanel;
+            const unsigned nk = xb.col;
+            xbPanel.pack(xb.kernel_data(), xb.kernel_stride(), row, nk);
+            nzbxatPanel.pack(nzbxat.kernel_data(), nzbxat.kernel_stride(), col, nk);
+            for (unsigned i = 0; i < row; i++)
+                MatrixKernels::cmul_t_split(row_vektor(i).data() + i, 0, ya.row_vektor(i).data() + i, 0, xbPanel.getRe() + i * nk, xbPanel.getIm() + i * nk, 0,
+                    nzbxatPanel.getRe() + i * nk, nzbxatPanel.getIm() + i * nk, nk, 1, col - i, nk, mtmAdd);
+            return;
+        }
+
         const unsigned ni = row, nj = col, nk = xb.col;
         const unsigned di = row % 4, dj = col % 4, dk = xb.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
         for (unsigned i = 0; i < hi; i += 4) {
-            const vektor<datatype> & xb_row_i0 = xb.rows[i + 0];
-            const vektor<datatype> & xb_row_i1 = xb.rows[i + 1];
-            const vektor<datatype> & xb_row_i2 = xb.rows[i + 2];
-            const vektor<datatype> & xb_row_i3 = xb.rows[i + 3];
-            const vektor<datatype> & nzbxat_row_i0 = nzbxat.rows[i + 0];
-            const vektor<datatype> & nzbxat_row_i1 = nzbxat.rows[i + 1];
-            const vektor<datatype> & nzbxat_row_i2 = nzbxat.rows[i + 2];
-            const vektor<datatype> & nzbxat_row_i3 = nzbxat.rows[i + 3];
+            const vektor<datatype> & xb_row_i0 = xb.row_vektor(i + 0);
+            const vektor<datatype> & xb_row_i1 = xb.row_vektor(i + 1);
+            const vektor<datatype> & xb_row_i2 = xb.row_vektor(i + 2);
+            const vektor<datatype> & xb_row_i3 = xb.row_vektor(i + 3);
+            const vektor<datatype> & nzbxat_row_i0 = nzbxat.row_vektor(i + 0);
+            const vektor<datatype> & nzbxat_row_i1 = nzbxat.row_vektor(i + 1);
+            const vektor<datatype> & nzbxat_row_i2 = nzbxat.row_vektor(i + 2);
+            const vektor<datatype> & nzbxat_row_i3 = nzbxat.row_vektor(i + 3);
             datatype triangle[10] = { datatype() };
             for (unsigned k = 0; k < hk; k += 4) {
                 triangle[0] += xb_row_i0[k + 0] * nzbxat_row_i0[k + 0] 
@@ -2656,14 +2829,14 @@ public:
 
             }
 
-            vektor<datatype> & row_i0 = rows[i + 0];
-            vektor<datatype> & row_i1 = rows[i + 1];
-            vektor<datatype> & row_i2 = rows[i + 2];
-            vektor<datatype> & row_i3 = rows[i + 3];
-            const vektor<datatype> & ya_row_i0 = ya.rows[i + 0];
-            const vektor<datatype> & ya_row_i1 = ya.rows[i + 1];
-            const vektor<datatype> & ya_row_i2 = ya.rows[i + 2];
-            const vektor<datatype> & ya_row_i3 = ya.rows[i + 3];
+            vektor<datatype> row_i0 = row_vektor(i + 0);
+            vektor<datatype> row_i1 = row_vektor(i + 1);
+            vektor<datatype> row_i2 = row_vektor(i + 2);
+            vektor<datatype> row_i3 = row_vektor(i + 3);
+            const vektor<datatype> & ya_row_i0 = ya.row_vektor(i + 0);
+            const vektor<datatype> & ya_row_i1 = ya.row_vektor(i + 1);
+            const vektor<datatype> & ya_row_i2 = ya.row_vektor(i + 2);
+            const vektor<datatype> & ya_row_i3 = ya.row_vektor(i + 3);
 
             row_i0[i + 0] = triangle[0] + ya_row_i0[i + 0];
             row_i0[i + 1] = triangle[1] + ya_row_i0[i + 1];
@@ -2680,10 +2853,10 @@ public:
             row_i3[i + 3] = triangle[9] + ya_row_i3[i + 3];
 
             for (unsigned j = i + 4; j < hj; j += 4) {
-                const vektor<datatype> & nzbxat_row_j0 = nzbxat.rows[j + 0];
-                const vektor<datatype> & nzbxat_row_j1 = nzbxat.rows[j + 1];
-                const vektor<datatype> & nzbxat_row_j2 = nzbxat.rows[j + 2];
-                const vektor<datatype> & nzbxat_row_j3 = nzbxat.rows[j + 3];
+                const vektor<datatype> & nzbxat_row_j0 = nzbxat.row_vektor(j + 0);
+                const vektor<datatype> & nzbxat_row_j1 = nzbxat.row_vektor(j + 1);
+                const vektor<datatype> & nzbxat_row_j2 = nzbxat.row_vektor(j + 2);
+                const vektor<datatype> & nzbxat_row_j3 = nzbxat.row_vektor(j + 3);
                 datatype square[16] = { datatype() };
                 for (unsigned k = 0; k < hk; k += 4) {
                     square[0] += xb_row_i0[k + 0] * nzbxat_row_j0[k + 0] 
@@ -2797,7 +2970,7 @@ public:
                 row_i3[j + 3] = square[15] + ya_row_i3[j + 3];
             }
             for (unsigned j = hj; j < nj; j++) {
-                const vektor<datatype> & nzbxat_row_j0 = nzbxat.rows[j];
+                const vektor<datatype> & nzbxat_row_j0 = nzbxat.row_vektor(j);
                 datatype quad[4] = { datatype() };
                 for (unsigned k = 0; k < nk; k++) {
                     quad[0] += xb_row_i0[k] * nzbxat_row_j0[k];
@@ -2812,18 +2985,172 @@ public:
             }
 	    }
         for (unsigned i = hi; i < ni; i++) {
-            const vektor<datatype> & xb_row_i = xb.rows[i];
+            const vektor<datatype> & xb_row_i = xb.row_vektor(i);
             for (unsigned j = i; j < nj; j++) {
-                const vektor<datatype> & nzbxat_sor_j = nzbxat.rows[j];
+                const vektor<datatype> & nzbxat_sor_j = nzbxat.row_vektor(j);
                 datatype sum = datatype();
                 for (unsigned k = 0; k < nk; k++) {
                     sum += xb_row_i[k] * nzbxat_sor_j[k];
                 }
-                rows[i][j] = sum + ya.rows[i][j];
+                row_vektor(i)[j] = sum + ya.row_vektor(i)[j];
             }
         }
     }
 
+    //***********************************************************************
+    void math_symm_ldlt() noexcept(!hmgVErrorCheck) {
+    // In-place LDLT factorization of a symmetrically stored matrix without pivoting.
+    // Result: U = LT without its unit diagonal above the diagonal, 1/D in the diagonal
+    // (with the 1e-20 guard of math_symm_ninv_of_nonsymm). n^3/3 flops instead of the 2n^3 of the inversion.
+    //***********************************************************************
+        if (col == 0 || row == 0)
+            return;
+        is_true_error(!is_symm, "matrix::math_symm_ldlt", "symmetrical matrix required");
+        for (unsigned k = 0; k < row; k++) {
+            datatype * const row_k = row_vektor(k).data();
+            const datatype divisor = abs(row_k[k]) < 1e-20 ? datatype(1e20) : datatype(1.0) / row_k[k];
+            auto updateRows = [&](unsigned begin, unsigned end) {
+                for (unsigned i = k + 1 + begin; i < k + 1 + end; i++) {
+                    const datatype C = row_k[i] * divisor;
+                    if (C == datatype())
+                        continue;
+                    datatype * const row_i = row_vektor(i).data();
+                    for (unsigned j = i; j < row; j++)
+                        row_i[j] -= C * row_k[j];
+                }
+            };
+            if (MatrixKernels::isBlockedInvSize(row - k))
+                ThreadPool::getInstance().parallelFor(row - k - 1, updateRows);
+            else
+                updateRows(0, row - k - 1);
+            for (unsigned j = k + 1; j < row; j++)
+                row_k[j] *= divisor;
+            row_k[k] = divisor;
+        }
+    }
+
+    //***********************************************************************
+    void math_ldlt_solve_rows(const matrix & ldlt, const matrix & src) noexcept(!hmgVErrorCheck) {
+    // this = src * L^-T (every row is solved with L), ldlt is the result of math_symm_ldlt
+    //***********************************************************************
+        if (col == 0 || row == 0)
+            return;
+        is_true_error(is_symm || src.is_symm, "matrix::math_ldlt_solve_rows", "nonsymmetrical matrix required");
+        is_true_error(!ldlt.is_symm, "matrix::math_ldlt_solve_rows", "symmetrical ldlt required");
+        is_equal_error(src.row, row, "math_ldlt_solve_rows row");
+        is_equal_error(src.col, col, "math_ldlt_solve_rows col");
+        is_equal_error(ldlt.row, col, "math_ldlt_solve_rows ldlt");
+        auto solveRows = [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; i++) {
+                datatype * const z = row_vektor(i).data();
+                const datatype * const s = src.row_vektor(i).data();
+                for (unsigned j = 0; j < col; j++)
+                    z[j] = s[j];
+                for (unsigned k = 0; k + 1 < col; k++) {
+                    const datatype zk = z[k];
+                    if (zk == datatype()) // the X blocks of the lower levels are sparse
+                        continue;
+                    const datatype * const u_k = ldlt.row_vektor(k).data();
+                    for (unsigned j = k + 1; j < col; j++)
+                        z[j] -= zk * u_k[j];
+                }
+            }
+        };
+        if (MatrixKernels::isParallelSize(row, col, col))
+            ThreadPool::getInstance().parallelFor(row, solveRows);
+        else
+            solveRows(0, row);
+    }
+
+    //***********************************************************************
+    void math_sub_mul_ldlt_symm(const matrix & ya, const matrix & z, const matrix & ldlt) noexcept(!hmgVErrorCheck) {
+    // this = ya - z * D^-1 * zT, symmetrical; z is from math_ldlt_solve_rows, so this = ya - xb * YB^-1 * xbT
+    //***********************************************************************
+        if (col == 0 || row == 0)
+            return;
+        is_true_error(!is_symm || !ya.is_symm, "matrix::math_sub_mul_ldlt_symm", "symmetrical matrix required");
+        is_true_error(z.is_symm || !ldlt.is_symm, "matrix::math_sub_mul_ldlt_symm", "nonsymmetrical z and symmetrical ldlt required");
+        is_equal_error(ya.col, col, "math_sub_mul_ldlt_symm col");
+        is_equal_error(z.row, row, "math_sub_mul_ldlt_symm row row");
+        is_equal_error(z.col, ldlt.col, "math_sub_mul_ldlt_symm col col");
+
+        const unsigned nk = z.col;
+        auto updateRows = [&](unsigned begin, unsigned end) {
+            static thread_local vektor<datatype> w; // -D^-1 * the ith row of z, kept between the calls (no allocation per chunk)
+            w.resize_if_needed(nk);
+            for (unsigned i = begin; i < end; i++) {
+                const datatype * const z_i = z.row_vektor(i).data();
+                for (unsigned k = 0; k < nk; k++)
+                    w[k] = -z_i[k] * ldlt.row_vektor(k)[k];
+                if constexpr (hasRealMatrixKernel<datatype>) {
+                    MatrixKernels::mul_t(row_vektor(i).data() + i, 0, ya.row_vektor(i).data() + i, 0, w.data(), 0,
+                        z.kernel_data() + i * z.kernel_stride(), z.kernel_stride(), 1, col - i, nk, mtmAdd);
+                }
+                else {
+                    for (unsigned j = i; j < col; j++)
+                        row_vektor(i)[j] = ya.row_vektor(i)[j] + math_mul(w, z.row_vektor(j));
+                }
+            }
+        };
+        if (MatrixKernels::isParallelSize(row, col, nk))
+            ThreadPool::getInstance().parallelFor(row, updateRows);
+        else
+            updateRows(0, row);
+    }
+
+    //***********************************************************************
+    friend inline void math_ldlt_nsolve(vektor<datatype> & dest, const matrix & ldlt, const vektor<datatype> & src) noexcept(!hmgVErrorCheck) {
+    // dest = -YB^-1 * src, where ldlt = math_symm_ldlt(YB); dest can be src
+    //***********************************************************************
+        const unsigned n = ldlt.row;
+        if (n == 0)
+            return;
+        is_true_error(!ldlt.is_symm, "math_ldlt_nsolve", "symmetrical ldlt required");
+        is_equal_error(dest.size(), n, "math_ldlt_nsolve dest");
+        is_equal_error(src.size(), n, "math_ldlt_nsolve src");
+        if (&dest != &src)
+            for (unsigned i = 0; i < n; i++)
+                dest[i] = src[i];
+        for (unsigned k = 0; k < n; k++) { // L * y = src
+            const datatype yk = dest[k];
+            const datatype * const u_k = ldlt.row_vektor(k).data();
+            for (unsigned j = k + 1; j < n; j++)
+                dest[j] -= yk * u_k[j];
+        }
+        for (unsigned k = 0; k < n; k++) // y = -D^-1 * y
+            dest[k] *= -ldlt.row_vektor(k)[k];
+        for (unsigned k = n - 1; k != ~0u; k--) { // LT * dest = y
+            const datatype * const u_k = ldlt.row_vektor(k).data();
+            datatype sum = dest[k];
+            for (unsigned j = k + 1; j < n; j++)
+                sum -= u_k[j] * dest[j];
+            dest[k] = sum;
+        }
+    }
+
+    //***********************************************************************
+    friend inline void math_ldlt_add_nsolve_ub(vektor<datatype> & ub, const vektor<datatype> & nzbjb, const matrix & ldlt, const matrix & xb, const vektor<datatype> & UA) noexcept(!hmgVErrorCheck) {
+    // ub = nzbjb - YB^-1 * xbT * UA, the symmetrical backsubs without NZBXA
+    //***********************************************************************
+        if (ub.size() == 0)
+            return;
+        is_true_error(xb.is_symm, "math_ldlt_add_nsolve_ub", "nonsymmetrical xb required");
+        is_equal_error(ub.size(), xb.col, "math_ldlt_add_nsolve_ub xb col");
+        is_equal_error(UA.size(), xb.row, "math_ldlt_add_nsolve_ub xb row");
+        ub.zero();
+        for (unsigned i = 0; i < xb.row; i++) {
+            const datatype ua = UA[i];
+            if (ua == datatype())
+                continue;
+            const datatype * const xb_i = xb.row_vektor(i).data();
+            for (unsigned j = 0; j < xb.col; j++)
+                ub[j] += xb_i[j] * ua;
+        }
+        math_ldlt_nsolve(ub, ldlt, ub);
+        for (unsigned j = 0; j < ub.size(); j++)
+            ub[j] += nzbjb[j];
+    }
+
     //***********************************************************************
     void math_sub_mul_t_symm_in_nonsymm(const matrix & c, const matrix & a, const matrix & b, bool is_symmetrize_needed) noexcept(!hmgVErrorCheck) {
     //***********************************************************************
@@ -2839,14 +3166,14 @@ public:
         const unsigned di = row % 4, dj = col % 4, dk = a.col % 4;
         const unsigned hi = ni - di, hj = nj - dj, hk = nk - dk;
         for (unsigned i = 0; i < hi; i += 4) {
-            const vektor<datatype> & xb_row_i0 = a.rows[i + 0];
-            const vektor<datatype> & xb_row_i1 = a.rows[i + 1];
-            const vektor<datatype> & xb_row_i2 = a.rows[i + 2];
-            const vektor<datatype> & xb_row_i3 = a.rows[i + 3];
-            const vektor<datatype> & nzbxat_row_i0 = b.rows[i + 0];
-            const vektor<datatype> & nzbxat_row_i1 = b.rows[i + 1];
-            const vektor<datatype> & nzbxat_row_i2 = b.rows[i + 2];
-            const vektor<datatype> & nzbxat_row_i3 = b.rows[i + 3];
+            const vektor<datatype> & xb_row_i0 = a.row_vektor(i + 0);
+            const vektor<datatype> & xb_row_i1 = a.row_vektor(i + 1);
+            const vektor<datatype> & xb_row_i2 = a.row_vektor(i + 2);
+            const vektor<datatype> & xb_row_i3 = a.row_vektor(i + 3);
+            const vektor<datatype> & nzbxat_row_i0 = b.row_vektor(i + 0);
+            const vektor<datatype> & nzbxat_row_i1 = b.row_vektor(i + 1);
+            const vektor<datatype> & nzbxat_row_i2 = b.row_vektor(i + 2);
+            const vektor<datatype> & nzbxat_row_i3 = b.row_vektor(i + 3);
             datatype triangle[10] = { datatype() };
             for (unsigned k = 0; k < hk; k += 4) {
                 triangle[0] += xb_row_i0[k + 0] * nzbxat_row_i0[k + 0] 
@@ -2910,14 +3237,14 @@ public:
 
             }
 
-            vektor<datatype> & row_i0 = rows[i + 0];
-            vektor<datatype> & row_i1 = rows[i + 1];
-            vektor<datatype> & row_i2 = rows[i + 2];
-            vektor<datatype> & row_i3 = rows[i + 3];
-            const vektor<datatype> & ya_row_i0 = c.rows[i + 0];
-            const vektor<datatype> & ya_row_i1 = c.rows[i + 1];
-            const vektor<datatype> & ya_row_i2 = c.rows[i + 2];
-            const vektor<datatype> & ya_row_i3 = c.rows[i + 3];
+            vektor<datatype> row_i0 = row_vektor(i + 0);
+            vektor<datatype> row_i1 = row_vektor(i + 1);
+            vektor<datatype> row_i2 = row_vektor(i + 2);
+            vektor<datatype> row_i3 = row_vektor(i + 3);
+            const vektor<datatype> & ya_row_i0 = c.row_vektor(i + 0);
+            const vektor<datatype> & ya_row_i1 = c.row_vektor(i + 1);
+            const vektor<datatype> & ya_row_i2 = c.row_vektor(i + 2);
+            const vektor<datatype> & ya_row_i3 = c.row_vektor(i + 3);
 
             row_i0[i + 0] = -triangle[0] + ya_row_i0[i + 0];
             row_i0[i + 1] = -triangle[1] + ya_row_i0[i + 1];
@@ -2934,10 +3261,10 @@ public:
             row_i3[i + 3] = -triangle[9] + ya_row_i3[i + 3];
 
             for (unsigned j = i + 4; j < hj; j += 4) {
-                const vektor<datatype> & nzbxat_row_j0 = b.rows[j + 0];
-                const vektor<datatype> & nzbxat_row_j1 = b.rows[j + 1];
-                const vektor<datatype> & nzbxat_row_j2 = b.rows[j + 2];
-                const vektor<datatype> & nzbxat_row_j3 = b.rows[j + 3];
+                const vektor<datatype> & nzbxat_row_j0 = b.row_vektor(j + 0);
+                const vektor<datatype> & nzbxat_row_j1 = b.row_vektor(j + 1);
+                const vektor<datatype> & nzbxat_row_j2 = b.row_vektor(j + 2);
+                const vektor<datatype> & nzbxat_row_j3 = b.row_vektor(j + 3);
                 datatype square[16] = { datatype() };
                 for (unsigned k = 0; k < hk; k += 4) {
                     square[0] += xb_row_i0[k + 0] * nzbxat_row_j0[k + 0] 
@@ -3051,7 +3378,7 @@ public:
                 row_i3[j + 3] = -square[15] + ya_row_i3[j + 3];
             }
             for (unsigned j = hj; j < nj; j++) {
-                const vektor<datatype> & nzbxat_row_j0 = b.rows[j];
+                const vektor<datatype> & nzbxat_row_j0 = b.row_vektor(j);
                 datatype quad[4] = { datatype() };
                 for (unsigned k = 0; k < nk; k++) {
                     quad[0] += xb_row_i0[k] * nzbxat_row_j0[k];
@@ -3066,14 +3393,14 @@ public:
             }
 	    }
         for (unsigned i = hi; i < ni; i++) {
-            const vektor<datatype> & xb_row_i = a.rows[i];
+            const vektor<datatype> & xb_row_i = a.row_vektor(i);
             for (unsigned j = i; j < nj; j++) {
-                const vektor<datatype> & nzbxat_sor_j = b.rows[j];
+                const vektor<datatype> & nzbxat_sor_j = b.row_vektor(j);
                 datatype sum = datatype();
                 for (unsigned k = 0; k < nk; k++) {
                     sum += xb_row_i[k] * nzbxat_sor_j[k];
                 }
-                rows[i][j] = -sum + c.rows[i][j];
+                row_vektor(i)[j] = -sum + c.row_vektor(i)[j];
             }
         }
         if(is_symmetrize_needed)
@@ -3082,6 +3409,86 @@ public:
 };
 
 
+//***********************************************************************
+template<typename datatype>
+inline void math_add_mul(vektor<datatype> & dest, const vektor<datatype> & tobeadded, std::type_identity_t<matrix_view<const datatype>> src1, const vektor<datatype> & src2) noexcept(!hmgVErrorCheck) {
+// dest = tobeadded + src1 * src2, e.g. with a transposed view: dest = tobeadded + NZBXAT^T * UA
+//***********************************************************************
+    if (dest.size() == 0)
+        return;
+    is_equal_error(dest.size(), tobeadded.size(), "vektor math_add_mul view size");
+    is_equal_error(dest.size(), src1.get_row(), "vektor math_add_mul view row");
+    is_equal_error(src2.size(), src1.get_col(), "vektor math_add_mul view col");
+    datatype* d = dest.data();
+    const datatype* s2 = src2.data();
+    if (src1.row_stride != 1) { // row by row, dot products
+        for (unsigned i = 0; i < src1.row; i++) {
+            const datatype* src_row = src1.arr + i * src1.row_stride;
+            datatype sum = tobeadded[i];
+            if (src1.col_stride == 1)
+                for (unsigned j = 0; j < src1.col; j++)
+                    sum += src_row[j] * s2[j];
+            else
+                for (unsigned j = 0; j < src1.col; j++)
+                    sum += src_row[j * src1.col_stride] * s2[j];
+            d[i] = sum;
+        }
+    }
+    else { // the columns are continuous (transposed view): column by column
+        for (unsigned i = 0; i < src1.row; i++)
+            d[i] = tobeadded[i];
+        for (unsigned j = 0; j < src1.col; j++) {
+            const datatype* src_col = src1.arr + j * src1.col_stride;
+            const datatype factor = s2[j];
+            for (unsigned i = 0; i < src1.row; i++)
+                d[i] += src_col[i] * factor;
+        }
+    }
+}
+
+
+//***********************************************************************
+struct MixedPrecisionReduction {
+// The O(n^3) steps of a reduction in float, on the cache of the thread. The results are converted
+// back into the double matrices, so the forward and backward substitutions do not change, but
+// the factors are float accurate: the DC iteration with its double defects refines the solution.
+//***********************************************************************
+    //***********************************************************************
+    static void reduceSymm(matrix<double>& yb_ldlt, matrix<double>& nzbxat, matrix<double>& yred, const matrix<double>& ya, const matrix<double>& xb) {
+    // yb_ldlt: symmetrical YB => LDLT factor, nzbxat = xb * L^-T, yred = ya - xb * YB^-1 * xbT; ya can be yred
+    //***********************************************************************
+        static thread_local matrix<float> fYB, fXB, fZ, fYRED;
+        fYB.convert_unsafe(yb_ldlt);
+        fXB.convert_unsafe(xb);
+        fYRED.convert_unsafe(ya);
+        fZ.resize_if_needed(xb.get_row(), xb.get_col(), false);
+        fYB.math_symm_ldlt();
+        fZ.math_ldlt_solve_rows(fYB, fXB);
+        fYRED.math_sub_mul_ldlt_symm(fYRED, fZ, fYB);
+        yb_ldlt.convert_unsafe(fYB);
+        nzbxat.convert_unsafe(fZ);
+        yred.convert_unsafe(fYRED);
+    }
+    //***********************************************************************
+    static void reduceNonSymm(matrix<double>& yb_nzb, matrix<double>& nzbxat, matrix<double>& yred, const matrix<double>& ya, const matrix<double>& xat, const matrix<double>& xb) {
+    // yb_nzb: YB => -YB^-1, nzbxat = xat * NZB^T, yred = ya + xb * nzbxat^T; ya can be yred
+    //***********************************************************************
+        static thread_local matrix<float> fYB, fXAT, fXB, fNZBXAT, fYRED;
+        fYB.convert_unsafe(yb_nzb);
+        fXAT.convert_unsafe(xat);
+        fXB.convert_unsafe(xb);
+        fYRED.convert_unsafe(ya);
+        fNZBXAT.resize_if_needed(xat.get_row(), xat.get_col(), false);
+        fYB.math_ninv_np();
+        fNZBXAT.math_mul_t_unsafe(fXAT, fYB);
+        fYRED.math_add_mul_t_unsafe(fYRED, fXB, fNZBXAT);
+        yb_nzb.convert_unsafe(fYB);
+        nzbxat.convert_unsafe(fNZBXAT);
+        yred.convert_unsafe(fYRED);
+    }
+    //***********************************************************************
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,293 @@
+//***********************************************************************
+// HexMG Fixed Size Matrix Header
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_MATRIX_FIXED_HEADER
+#define	HMG_MATRIX_FIXED_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgMatrix.hpp"
+#include <utility>
+#include <vector>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+constexpr unsigned matrixFixedMaxSize = 8; // the symmetrical reductions with 3 <= Bsiz <= matrixFixedMaxSize use matrix_fixed
+//***********************************************************************
+
+
+//***********************************************************************
+constexpr bool isMatrixFixedNonsymmFaster(unsigned n) noexcept {
+// the nonsymmetrical reductions use matrix_fixed only where it is measurably faster than the general
+// path with the AVX2 / AVX-512 mul_t kernels (-bench fixed, medians of 6 runs):
+// n = 3: 1.42x, 4: 1.11x, 5: 0.98x, 6: 1.03x, 7: 0.79x, 8: 1.15x
+//***********************************************************************
+    return n == 3 || n == 4 || n == 8;
+}
+
+
+//***********************************************************************
+template<unsigned N, typename Body>
+inline void fixed_for(Body&& body) {
+// body(i) for i = 0...N-1 with i as std::integral_constant: the loop is unrolled by the fold
+// expression (the compilers do not unroll the nested loops of the tiny matrices by themselves).
+// The innermost loops that run along a row remain normal loops, so they can be vectorized.
+//***********************************************************************
+    [&]<unsigned... I>(std::integer_sequence<unsigned, I...>) {
+        (body(std::integral_constant<unsigned, I>{}), ...);
+    }(std::make_integer_sequence<unsigned, N>{});
+}
+
+
+//***********************************************************************
+template<typename datatype, unsigned N> class matrix_fixed {
+// N x N matrix with compile-time dimensions for the small YB blocks of the lowest reduction levels.
+// The outer loops are unrolled by fixed_for, the row loops have constant trip counts;
+// the arithmetic is the same as in the matrix class (no pivoting, 1e-20 guard).
+//***********************************************************************
+    static_assert(N > 0 && N <= matrixFixedMaxSize, "matrix_fixed: 1 <= N <= matrixFixedMaxSize");
+    datatype e[N][N];
+public:
+    //***********************************************************************
+    static constexpr unsigned size = N;
+    //***********************************************************************
+    datatype* operator[](unsigned i) noexcept { return e[i]; }
+    //***********************************************************************
+    const datatype* operator[](unsigned i) const noexcept { return e[i]; }
+    //***********************************************************************
+    void load(const matrix<datatype>& src) noexcept(!hmgVErrorCheck) {
+    // src is an N x N nonsymmetrical matrix
+    //***********************************************************************
+        is_true_error(src.get_is_symm(), "matrix_fixed::load", "symmetrical matrix not allowed");
+        is_equal_error(src.get_row(), N, "matrix_fixed::load row");
+        const datatype* p = src.kernel_data();
+        const size_t ld = src.kernel_stride();
+        for (unsigned i = 0; i < N; i++)
+            for (unsigned j = 0; j < N; j++)
+                e[i][j] = p[i * ld + j];
+    }
+    //***********************************************************************
+    void store(matrix<datatype>& dest) const noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        is_true_error(dest.get_is_symm(), "matrix_fixed::store", "symmetrical matrix not allowed");
+        is_equal_error(dest.get_row(), N, "matrix_fixed::store row");
+        datatype* p = dest.kernel_data();
+        const size_t ld = dest.kernel_stride();
+        for (unsigned i = 0; i < N; i++)
+            for (unsigned j = 0; j < N; j++)
+                p[i * ld + j] = e[i][j];
+    }
+    //***********************************************************************
+    void load_symm(const matrix<datatype>& src) noexcept(!hmgVErrorCheck) {
+    // src is an N x N symmetrical matrix, only the upper triangle is loaded
+    //***********************************************************************
+        is_true_error(!src.get_is_symm(), "matrix_fixed::load_symm", "symmetrical matrix required");
+        is_equal_error(src.get_row(), N, "matrix_fixed::load_symm row");
+        for (unsigned i = 0; i < N; i++) {
+            const datatype* row_i = src[i].data();
+            for (unsigned j = i; j < N; j++)
+                e[i][j] = row_i[j];
+        }
+    }
+    //***********************************************************************
+    void store_symm(matrix<datatype>& dest) const noexcept(!hmgVErrorCheck) {
+    //***********************************************************************
+        is_true_error(!dest.get_is_symm(), "matrix_fixed::store_symm", "symmetrical matrix required");
+        is_equal_error(dest.get_row(), N, "matrix_fixed::store_symm row");
+        for (unsigned i = 0; i < N; i++) {
+            datatype* row_i = dest[i].data();
+            for (unsigned j = i; j < N; j++)
+                row_i[j] = e[i][j];
+        }
+    }
+    //***********************************************************************
+    void symm_ldlt() noexcept {
+    // see matrix::math_symm_ldlt, the upper triangle is used
+    //***********************************************************************
+        fixed_for<N>([&](auto k) {
+            const datatype divisor = abs(e[k][k]) < 1e-20 ? datatype(1e20) : datatype(1.0) / e[k][k];
+            fixed_for<N>([&](auto i) {
+                if constexpr (i > k) {
+                    const datatype C = e[k][i] * divisor;
+                    for (unsigned j = i; j < N; j++)
+                        e[i][j] -= C * e[k][j];
+                }
+            });
+            for (unsigned j = k + 1; j < N; j++)
+                e[k][j] *= divisor;
+            e[k][k] = divisor;
+        });
+    }
+    //***********************************************************************
+    void ninv_np() noexcept {
+    // this = -this^-1, see matrix::math_ninv_np_
+    //***********************************************************************
+        fixed_for<N>([&](auto i) {
+            const datatype divisor = abs(e[i][i]) < 1e-20 ? datatype(1e20) : datatype(1.0) / e[i][i];
+            fixed_for<N>([&](auto j) {
+                if constexpr (j != i) {
+                    const datatype C = e[j][i] * divisor;
+                    for (unsigned k = 0; k < N; k++)
+                        e[j][k] -= C * e[i][k];
+                    e[j][i] = C; // in case of non-negating inv = -C;
+                }
+            });
+            for (unsigned j = 0; j < N; j++)
+                e[i][j] *= divisor;
+            e[i][i] = -divisor; // in case of non-negating inv = divisor;
+        });
+    }
+    //***********************************************************************
+};
+
+
+//***********************************************************************
+template<typename datatype, unsigned N>
+inline void math_fixed_add_mul_row(datatype* dest, const datatype* a, const datatype* b, size_t ldb, unsigned j0, unsigned j1) noexcept {
+// dest[j] += sum(a[k] * b[k * ldb + j]), k = 0...N-1, j = j0...j1-1; the sums of four neighbouring
+// j are in registers, the inner loops have constant trip counts, so they can be vectorized
+//***********************************************************************
+    datatype ak[N]; // local copy, the stores into dest cannot modify it
+    fixed_for<N>([&](auto k) { ak[k] = a[k]; });
+    unsigned j = j0;
+    for (; j + 4 <= j1; j += 4) {
+        datatype sum[4] = {};
+        fixed_for<N>([&](auto k) {
+            const datatype* const b_k = b + k * ldb + j;
+            for (unsigned q = 0; q < 4; q++)
+                sum[q] += ak[k] * b_k[q];
+        });
+        for (unsigned q = 0; q < 4; q++)
+            dest[j + q] += sum[q];
+    }
+    for (; j < j1; j++) {
+        datatype sum = datatype();
+        fixed_for<N>([&](auto k) { sum += ak[k] * b[k * ldb + j]; });
+        dest[j] += sum;
+    }
+}
+
+
+//***********************************************************************
+template<typename datatype, unsigned N>
+void math_fixed_reduce_symm(matrix<datatype>& yb_ldlt, matrix<datatype>& nzbxat, matrix<datatype>& yred, const matrix<datatype>& xb) noexcept(!hmgVErrorCheck) {
+// The symmetrical reduction of the SUNRED nodes with N x N YB, it computes the same matrices as
+// the general path: yb_ldlt = LDLT(YB), nzbxat = xb * L^-T, yred -= xb * YB^-1 * xbT
+//***********************************************************************
+    matrix_fixed<datatype, N> ldlt;
+    ldlt.load_symm(yb_ldlt);
+    ldlt.symm_ldlt();
+    ldlt.store_symm(yb_ldlt);
+
+    const unsigned na = xb.get_row();
+    is_equal_error(xb.get_col(), N, "math_fixed_reduce_symm xb col");
+    is_equal_error(nzbxat.get_row(), na, "math_fixed_reduce_symm nzbxat row");
+    is_equal_error(yred.get_row(), na, "math_fixed_reduce_symm yred row");
+    static thread_local std::vector<datatype> zt; // the transpose of z, the update of YRED runs along its rows
+    if (zt.size() < size_t(N) * na)
+        zt.resize(size_t(N) * na);
+    for (unsigned i = 0; i < na; i++) {
+        const datatype* const s = xb[i].data();
+        datatype z[N];
+        fixed_for<N>([&](auto j) { z[j] = s[j]; });
+        fixed_for<N>([&](auto k) {
+            fixed_for<N>([&](auto j) { if constexpr (j > k) z[j] -= z[k] * ldlt[k][j]; });
+        });
+        datatype* const d = nzbxat[i].data();
+        fixed_for<N>([&](auto j) { d[j] = z[j]; zt[j * na + i] = z[j]; });
+    }
+    for (unsigned i = 0; i < na; i++) {
+        datatype w[N]; // -D^-1 * the ith row of z
+        fixed_for<N>([&](auto k) { w[k] = -zt[k * na + i] * ldlt[k][k]; });
+        math_fixed_add_mul_row<datatype, N>(yred[i].data(), w, zt.data(), na, i, na);
+    }
+}
+
+
+//***********************************************************************
+template<typename datatype, unsigned N>
+void math_fixed_reduce_nonsymm(matrix<datatype>& yb_nzb, matrix<datatype>& nzbxa, matrix<datatype>& nzbxat, matrix<datatype>& yred,
+    const matrix<datatype>& xat, const matrix<datatype>& xb) noexcept(!hmgVErrorCheck) {
+// The nonsymmetrical reduction of the SUNRED nodes with N x N YB, it computes the same matrices as
+// the general path: yb_nzb = -YB^-1, nzbxa = NZB * xa, nzbxat = nzbxaT, yred += xb * nzbxa
+//***********************************************************************
+    matrix_fixed<datatype, N> nzb;
+    nzb.load(yb_nzb);
+    nzb.ninv_np();
+    nzb.store(yb_nzb);
+
+    const unsigned na = xat.get_row();
+    is_equal_error(xat.get_col(), N, "math_fixed_reduce_nonsymm xat col");
+    is_equal_error(xb.get_row(), na, "math_fixed_reduce_nonsymm xb row");
+    is_equal_error(nzbxat.get_row(), na, "math_fixed_reduce_nonsymm nzbxat row");
+    is_equal_error(nzbxa.get_col(), na, "math_fixed_reduce_nonsymm nzbxa col");
+    matrix_fixed<datatype, N> nzbt; // the columns of nzb are the rows of nzbt
+    fixed_for<N>([&](auto i) { fixed_for<N>([&](auto k) { nzbt[k][i] = nzb[i][k]; }); });
+    datatype* const pnzbxa = nzbxa.kernel_data();
+    const size_t ldnzbxa = nzbxa.kernel_stride();
+    for (unsigned j = 0; j < na; j++) {
+        const datatype* const xa_j = xat[j].data();
+        datatype sum[N] = {};
+        fixed_for<N>([&](auto k) {
+            const datatype xa_jk = xa_j[k];
+            for (unsigned i = 0; i < N; i++)
+                sum[i] += nzbt[k][i] * xa_jk;
+        });
+        datatype* const d = nzbxat[j].data();
+        fixed_for<N>([&](auto i) { d[i] = sum[i]; pnzbxa[i * ldnzbxa + j] = sum[i]; });
+    }
+    for (unsigned i = 0; i < na; i++)
+        math_fixed_add_mul_row<datatype, N>(yred[i].data(), xb[i].data(), pnzbxa, ldnzbxa, 0, na);
+}
+
+
+//***********************************************************************
+template<typename datatype>
+void math_fixed_reduce_symm(unsigned n, matrix<datatype>& yb_ldlt, matrix<datatype>& nzbxat, matrix<datatype>& yred, const matrix<datatype>& xb) {
+// dispatcher, 3 <= n <= matrixFixedMaxSize
+//***********************************************************************
+    switch (n) {
+        case 3: math_fixed_reduce_symm<datatype, 3>(yb_ldlt, nzbxat, yred, xb); break;
+        case 4: math_fixed_reduce_symm<datatype, 4>(yb_ldlt, nzbxat, yred, xb); break;
+        case 5: math_fixed_reduce_symm<datatype, 5>(yb_ldlt, nzbxat, yred, xb); break;
+        case 6: math_fixed_reduce_symm<datatype, 6>(yb_ldlt, nzbxat, yred, xb); break;
+        case 7: math_fixed_reduce_symm<datatype, 7>(yb_ldlt, nzbxat, yred, xb); break;
+        case 8: math_fixed_reduce_symm<datatype, 8>(yb_ldlt, nzbxat, yred, xb); break;
+        default: throw hmgExcept("math_fixed_reduce_symm", "unsupported size: %u", n);
+    }
+}
+
+
+//***********************************************************************
+template<typename datatype>
+void math_fixed_reduce_nonsymm(unsigned n, matrix<datatype>& yb_nzb, matrix<datatype>& nzbxa, matrix<datatype>& nzbxat, matrix<datatype>& yred,
+    const matrix<datatype>& xat, const matrix<datatype>& xb) {
+// dispatcher, 3 <= n <= matrixFixedMaxSize
+//***********************************************************************
+    switch (n) {
+        case 3: math_fixed_reduce_nonsymm<datatype, 3>(yb_nzb, nzbxa, nzbxat, yred, xat, xb); break;
+        case 4: math_fixed_reduce_nonsymm<datatype, 4>(yb_nzb, nzbxa, nzbxat, yred, xat, xb); break;
+        case 5: math_fixed_reduce_nonsymm<datatype, 5>(yb_nzb, nzbxa, nzbxat, yred, xat, xb); break;
+        case 6: math_fixed_reduce_nonsymm<datatype, 6>(yb_nzb, nzbxa, nzbxat, yred, xat, xb); break;
+        case 7: math_fixed_reduce_nonsymm<datatype, 7>(yb_nzb, nzbxa, nzbxat, yred, xat, xb); break;
+        case 8: math_fixed_reduce_nonsymm<datatype, 8>(yb_nzb, nzbxa, nzbxat, yred, xat, xb); break;
+        default: throw hmgExcept("math_fixed_reduce_nonsymm", "unsupported size: %u", n);
+    }
+}
+
+
+}
+
+#endif
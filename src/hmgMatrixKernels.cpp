@@ -0,0 +1,1648 @@
+//***********************************************************************
+// HexMG Matrix Kernels CPP
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgMatrixKernels.h"
+#include "hmgThreadPool.h"
+//***********************************************************************
+#if defined(_M_X64) || defined(__x86_64__)
+#define HMG_KERNELS_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+//***********************************************************************
+#if defined(_MSC_VER) && !defined(__clang__)
+#define HMG_TARGET_AVX2
+#define HMG_TARGET_AVX512
+#else
+#define HMG_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define HMG_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx2,fma")))
+#endif
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+template<typename T>
+inline void storeMulTResult(T* d, const T* c, T sum, MulTMode mode) noexcept {
+//***********************************************************************
+    switch (mode) {
+        case mtmSet: *d =  sum;      break;
+        case mtmNeg: *d = -sum;      break;
+        case mtmAdd: *d = *c + sum;  break;
+        case mtmSub: *d = *c - sum;  break;
+    }
+}
+
+
+//***********************************************************************
+template<typename T>
+static void mulTScalar(T* d, size_t ldd, const T* c, size_t ldc, const T* a, size_t lda,
+    const T* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+// The original 4x4 register blocked loop of matrix::math_mul_t_unsafe with strides, double and float.
+//***********************************************************************
+    if (nk == 0) {
+        for (unsigned i = 0; i < ni; i++)
+            for (unsigned j = 0; j < nj; j++)
+                storeMulTResult(d + i * ldd + j, c + i * ldc + j, T(0), mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 4, hj = nj - nj % 4;
+    for (unsigned i = 0; i < hi; i += 4) {
+        const T *a0 = a + i * lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+        for (unsigned j = 0; j < hj; j += 4) {
+            const T *b0 = b_t + j * ldb, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+            T s[16] = {};
+            for (unsigned k = 0; k < nk; k++) {
+                s[0]  += a0[k] * b0[k];	s[1]  += a0[k] * b1[k];	s[2]  += a0[k] * b2[k];	s[3]  += a0[k] * b3[k];
+                s[4]  += a1[k] * b0[k];	s[5]  += a1[k] * b1[k];	s[6]  += a1[k] * b2[k];	s[7]  += a1[k] * b3[k];
+                s[8]  += a2[k] * b0[k];	s[9]  += a2[k] * b1[k];	s[10] += a2[k] * b2[k];	s[11] += a2[k] * b3[k];
+                s[12] += a3[k] * b0[k];	s[13] += a3[k] * b1[k];	s[14] += a3[k] * b2[k];	s[15] += a3[k] * b3[k];
+            }
+            for (unsigned r = 0; r < 4; r++)
+                for (unsigned q = 0; q < 4; q++)
+                    storeMulTResult(d + (i + r) * ldd + j + q, c + (i + r) * ldc + j + q, s[4 * r + q], mode);
+        }
+        for (unsigned j = hj; j < nj; j++) {
+            const T *b0 = b_t + j * ldb;
+            T s[4] = {};
+            for (unsigned k = 0; k < nk; k++) {
+                s[0] += a0[k] * b0[k]; s[1] += a1[k] * b0[k]; s[2] += a2[k] * b0[k]; s[3] += a3[k] * b0[k];
+            }
+            for (unsigned r = 0; r < 4; r++)
+                storeMulTResult(d + (i + r) * ldd + j, c + (i + r) * ldc + j, s[r], mode);
+        }
+    }
+    for (unsigned i = hi; i < ni; i++) {
+        const T *a0 = a + i * lda;
+        for (unsigned j = 0; j < nj; j++) {
+            const T *b0 = b_t + j * ldb;
+            T sum = T(0);
+            for (unsigned k = 0; k < nk; k++)
+                sum += a0[k] * b0[k];
+            storeMulTResult(d + i * ldd + j, c + i * ldc + j, sum, mode);
+        }
+    }
+}
+
+
+//***********************************************************************
+inline void storeMulTResult(std::complex<double>* d, const std::complex<double>* c, const std::complex<double>& sum, MulTMode mode) noexcept {
+//***********************************************************************
+    switch (mode) {
+        case mtmSet: *d =  sum;      break;
+        case mtmNeg: *d = -sum;      break;
+        case mtmAdd: *d = *c + sum;  break;
+        case mtmSub: *d = *c - sum;  break;
+    }
+}
+
+
+//***********************************************************************
+static void cmulTSplitScalar(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+    const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb,
+    unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    for (unsigned i = 0; i < ni; i++) {
+        const double *ar = aRe + i * lda, *ai = aIm + i * lda;
+        for (unsigned j = 0; j < nj; j++) {
+            const double *br = bRe + j * ldb, *bi = bIm + j * ldb;
+            double re = 0.0, im = 0.0;
+            for (unsigned k = 0; k < nk; k++) {
+                re += ar[k] * br[k] - ai[k] * bi[k];
+                im += ar[k] * bi[k] + ai[k] * br[k];
+            }
+            storeMulTResult(d + i * ldd + j, c + i * ldc + j, std::complex<double>(re, im), mode);
+        }
+    }
+}
+
+
+//***********************************************************************
+static void cRowUpdateScalar(double* rowRe, double* rowIm, const double* const* pivRe, const double* const* pivIm,
+    const double* CRe, const double* CIm, unsigned bs, unsigned n) noexcept {
+//***********************************************************************
+    for (unsigned q = 0; q < bs; q++) {
+        const double cr = CRe[q], ci = CIm[q];
+        const double *pr = pivRe[q], *pi = pivIm[q];
+        for (unsigned k = 0; k < n; k++) {
+            rowRe[k] -= cr * pr[k] - ci * pi[k];
+            rowIm[k] -= cr * pi[k] + ci * pr[k];
+        }
+    }
+}
+
+
+//***********************************************************************
+// Packed panel path of the large products (Goto / BLIS blocking).
+// For every NC column block of d and KC long k block, the NC x KC part of b_t is packed
+// into NR wide k-major panels (kept in L3), then for every MC row block the MC x KC part
+// of a is packed into MR high k-major panels (kept in L2). The micro-kernel updates an
+// MR x NR register tile with kc outer products, its NR x KC b panel stays in L1.
+// The micro-kernel stores d = src +/- tile, src can be nullptr (d = +/- tile).
+template<typename T>
+using PackedMicroKernel = void (*)(unsigned kc, const T* ap, const T* bp, T* d, size_t ldd,
+    const T* src, size_t lds, bool negative);
+//***********************************************************************
+
+
+//***********************************************************************
+template<typename T, unsigned MR>
+static void packPanelsA(T* dest, const T* a, size_t lda, unsigned mc, unsigned kc) noexcept {
+// panel p, element (r, k) => dest[p * MR * kc + k * MR + r], the missing rows of the last panel are 0
+//***********************************************************************
+    for (unsigned ir = 0; ir < mc; ir += MR, dest += MR * kc)
+        for (unsigned r = 0; r < MR; r++) {
+            if (ir + r < mc) {
+                const T* src = a + (ir + r) * lda;
+                for (unsigned k = 0; k < kc; k++)
+                    dest[k * MR + r] = src[k];
+            }
+            else {
+                for (unsigned k = 0; k < kc; k++)
+                    dest[k * MR + r] = T(0);
+            }
+        }
+}
+
+
+//***********************************************************************
+template<unsigned MR, unsigned NR, unsigned MC, unsigned KC, unsigned NC, typename T>
+static void mulTPacked(PackedMicroKernel<T> micro, T* d, size_t ldd, const T* c, size_t ldc, const T* a, size_t lda,
+    const T* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+// the first k block applies mode with c, the next ones accumulate in d
+//***********************************************************************
+    static_assert(MC % MR == 0 && NC % NR == 0, "mulTPacked: the cache blocks must be multiples of the register tile");
+    // the pack buffers are sized to the blocks of the actual product (the partial panels are padded to MR / NR),
+    // not to MC x KC and KC x NC: a small product on a pool thread does not pin the full blocks
+    static thread_local std::vector<T> aPack, bPack;
+    const size_t kcMax = nk < KC ? nk : KC;
+    const size_t mcMax = ni < MC ? (ni + MR - 1) / MR * MR : MC, ncMax = nj < NC ? (nj + NR - 1) / NR * NR : NC;
+    if (aPack.size() < mcMax * kcMax)
+        aPack.resize(mcMax * kcMax);
+    if (bPack.size() < ncMax * kcMax)
+        bPack.resize(ncMax * kcMax);
+    const bool negative = mode == mtmNeg || mode == mtmSub;
+    const bool readC = mode == mtmAdd || mode == mtmSub;
+
+    for (unsigned jc = 0; jc < nj; jc += NC) {
+        const unsigned nc = nj - jc < NC ? nj - jc : NC;
+        for (unsigned pc = 0; pc < nk; pc += KC) {
+            const unsigned kc = nk - pc < KC ? nk - pc : KC;
+            const T* src = pc == 0 ? (readC ? c : nullptr) : d;
+            const size_t lds = pc == 0 ? ldc : ldd;
+            packPanelsA<T, NR>(bPack.data(), b_t + jc * ldb + pc, ldb, nc, kc); // the rows of b_t are the columns of d
+            for (unsigned ic = 0; ic < ni; ic += MC) {
+                const unsigned mc = ni - ic < MC ? ni - ic : MC;
+                packPanelsA<T, MR>(aPack.data(), a + ic * lda + pc, lda, mc, kc);
+                for (unsigned jr = 0; jr < nc; jr += NR) {
+                    const T* bp = bPack.data() + jr * kc;
+                    const unsigned nr = nc - jr < NR ? nc - jr : NR;
+                    for (unsigned ir = 0; ir < mc; ir += MR) {
+                        const T* ap = aPack.data() + ir * kc;
+                        const unsigned mr = mc - ir < MR ? mc - ir : MR;
+                        T* dt = d + (ic + ir) * ldd + jc + jr;
+                        const T* st = src == nullptr ? nullptr : src + (ic + ir) * lds + jc + jr;
+                        if (mr == MR && nr == NR) {
+                            micro(kc, ap, bp, dt, ldd, st, lds, negative);
+                        }
+                        else { // edge tile: the padded panels are computed into a local tile
+                            alignas(64) T tile[MR * NR];
+                            micro(kc, ap, bp, tile, NR, nullptr, 0, false);
+                            for (unsigned r = 0; r < mr; r++)
+                                for (unsigned q = 0; q < nr; q++) {
+                                    const T v = negative ? -tile[r * NR + q] : tile[r * NR + q];
+                                    dt[r * ldd + q] = st == nullptr ? v : st[r * lds + q] + v;
+                                }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+#ifdef HMG_KERNELS_X64
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline double hsumAVX2(__m256d v) noexcept {
+//***********************************************************************
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline __m256d hsum4AVX2(__m256d v0, __m256d v1, __m256d v2, __m256d v3) noexcept {
+// { hsum(v0), hsum(v1), hsum(v2), hsum(v3) }
+//***********************************************************************
+    __m256d t0 = _mm256_hadd_pd(v0, v1);
+    __m256d t1 = _mm256_hadd_pd(v2, v3);
+    return _mm256_add_pd(_mm256_permute2f128_pd(t0, t1, 0x20), _mm256_permute2f128_pd(t0, t1, 0x31));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void store4AVX2(double* d, const double* c, __m256d sum, MulTMode mode) noexcept {
+//***********************************************************************
+    switch (mode) {
+        case mtmSet: _mm256_storeu_pd(d, sum); break;
+        case mtmNeg: _mm256_storeu_pd(d, _mm256_sub_pd(_mm256_setzero_pd(), sum)); break;
+        case mtmAdd: _mm256_storeu_pd(d, _mm256_add_pd(_mm256_loadu_pd(c), sum)); break;
+        case mtmSub: _mm256_storeu_pd(d, _mm256_sub_pd(_mm256_loadu_pd(c), sum)); break;
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline __m256i tailMaskAVX2(unsigned dk) noexcept {
+// 1 <= dk <= 3 valid elements
+//***********************************************************************
+    return _mm256_set_epi64x(0, dk > 2 ? -1 : 0, dk > 1 ? -1 : 0, -1);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void block2x4AVX2(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+// 2 x 4 dot products vectorized along k: 8 accumulators + 6 operands of the 16 ymm registers
+//***********************************************************************
+    const double *a0 = a, *a1 = a + lda;
+    const double *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m256d s00 = _mm256_setzero_pd(), s01 = _mm256_setzero_pd(), s02 = _mm256_setzero_pd(), s03 = _mm256_setzero_pd();
+    __m256d s10 = _mm256_setzero_pd(), s11 = _mm256_setzero_pd(), s12 = _mm256_setzero_pd(), s13 = _mm256_setzero_pd();
+    const unsigned hk = nk - nk % 4;
+    for (unsigned k = 0; k < hk; k += 4) {
+        const __m256d va0 = _mm256_loadu_pd(a0 + k), va1 = _mm256_loadu_pd(a1 + k);
+        __m256d vb = _mm256_loadu_pd(b0 + k);
+        s00 = _mm256_fmadd_pd(va0, vb, s00); s10 = _mm256_fmadd_pd(va1, vb, s10);
+        vb = _mm256_loadu_pd(b1 + k);
+        s01 = _mm256_fmadd_pd(va0, vb, s01); s11 = _mm256_fmadd_pd(va1, vb, s11);
+        vb = _mm256_loadu_pd(b2 + k);
+        s02 = _mm256_fmadd_pd(va0, vb, s02); s12 = _mm256_fmadd_pd(va1, vb, s12);
+        vb = _mm256_loadu_pd(b3 + k);
+        s03 = _mm256_fmadd_pd(va0, vb, s03); s13 = _mm256_fmadd_pd(va1, vb, s13);
+    }
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2(nk - hk);
+        const __m256d va0 = _mm256_maskload_pd(a0 + hk, m), va1 = _mm256_maskload_pd(a1 + hk, m);
+        __m256d vb = _mm256_maskload_pd(b0 + hk, m);
+        s00 = _mm256_fmadd_pd(va0, vb, s00); s10 = _mm256_fmadd_pd(va1, vb, s10);
+        vb = _mm256_maskload_pd(b1 + hk, m);
+        s01 = _mm256_fmadd_pd(va0, vb, s01); s11 = _mm256_fmadd_pd(va1, vb, s11);
+        vb = _mm256_maskload_pd(b2 + hk, m);
+        s02 = _mm256_fmadd_pd(va0, vb, s02); s12 = _mm256_fmadd_pd(va1, vb, s12);
+        vb = _mm256_maskload_pd(b3 + hk, m);
+        s03 = _mm256_fmadd_pd(va0, vb, s03); s13 = _mm256_fmadd_pd(va1, vb, s13);
+    }
+    store4AVX2(d, c, hsum4AVX2(s00, s01, s02, s03), mode);
+    store4AVX2(d + ldd, c + ldc, hsum4AVX2(s10, s11, s12, s13), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void block1x4AVX2(double* d, const double* c, const double* a,
+    const double* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    const double *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    const unsigned hk = nk - nk % 4;
+    for (unsigned k = 0; k < hk; k += 4) {
+        const __m256d va = _mm256_loadu_pd(a + k);
+        s0 = _mm256_fmadd_pd(va, _mm256_loadu_pd(b0 + k), s0);
+        s1 = _mm256_fmadd_pd(va, _mm256_loadu_pd(b1 + k), s1);
+        s2 = _mm256_fmadd_pd(va, _mm256_loadu_pd(b2 + k), s2);
+        s3 = _mm256_fmadd_pd(va, _mm256_loadu_pd(b3 + k), s3);
+    }
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2(nk - hk);
+        const __m256d va = _mm256_maskload_pd(a + hk, m);
+        s0 = _mm256_fmadd_pd(va, _mm256_maskload_pd(b0 + hk, m), s0);
+        s1 = _mm256_fmadd_pd(va, _mm256_maskload_pd(b1 + hk, m), s1);
+        s2 = _mm256_fmadd_pd(va, _mm256_maskload_pd(b2 + hk, m), s2);
+        s3 = _mm256_fmadd_pd(va, _mm256_maskload_pd(b3 + hk, m), s3);
+    }
+    store4AVX2(d, c, hsum4AVX2(s0, s1, s2, s3), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline double dotAVX2(const double* a, const double* b, unsigned nk) noexcept {
+//***********************************************************************
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    const unsigned hk = nk - nk % 8;
+    unsigned k = 0;
+    for (; k < hk; k += 8) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k + 4), _mm256_loadu_pd(b + k + 4), s1);
+    }
+    if (k + 4 <= nk) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k), s0);
+        k += 4;
+    }
+    if (k < nk) {
+        const __m256i m = tailMaskAVX2(nk - k);
+        s1 = _mm256_fmadd_pd(_mm256_maskload_pd(a + k, m), _mm256_maskload_pd(b + k, m), s1);
+    }
+    return hsumAVX2(_mm256_add_pd(s0, s1));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void storeTileRowAVX2(double* d, const double* src, __m256d v, bool negative) noexcept {
+//***********************************************************************
+    if (negative)
+        v = _mm256_sub_pd(_mm256_setzero_pd(), v);
+    if (src != nullptr)
+        v = _mm256_add_pd(_mm256_loadu_pd(src), v);
+    _mm256_storeu_pd(d, v);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 static void microTile6x8AVX2(unsigned kc, const double* ap, const double* bp, double* d, size_t ldd,
+    const double* src, size_t lds, bool negative) noexcept {
+// 12 accumulators + 2 b vectors + 1 broadcast a of the 16 ymm registers
+//***********************************************************************
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(), c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd(), c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd(), c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (unsigned k = 0; k < kc; k++, ap += 6, bp += 8) {
+        const __m256d b0 = _mm256_loadu_pd(bp), b1 = _mm256_loadu_pd(bp + 4);
+        __m256d av = _mm256_broadcast_sd(ap);
+        c00 = _mm256_fmadd_pd(av, b0, c00); c01 = _mm256_fmadd_pd(av, b1, c01);
+        av = _mm256_broadcast_sd(ap + 1);
+        c10 = _mm256_fmadd_pd(av, b0, c10); c11 = _mm256_fmadd_pd(av, b1, c11);
+        av = _mm256_broadcast_sd(ap + 2);
+        c20 = _mm256_fmadd_pd(av, b0, c20); c21 = _mm256_fmadd_pd(av, b1, c21);
+        av = _mm256_broadcast_sd(ap + 3);
+        c30 = _mm256_fmadd_pd(av, b0, c30); c31 = _mm256_fmadd_pd(av, b1, c31);
+        av = _mm256_broadcast_sd(ap + 4);
+        c40 = _mm256_fmadd_pd(av, b0, c40); c41 = _mm256_fmadd_pd(av, b1, c41);
+        av = _mm256_broadcast_sd(ap + 5);
+        c50 = _mm256_fmadd_pd(av, b0, c50); c51 = _mm256_fmadd_pd(av, b1, c51);
+    }
+    const __m256d acc[6][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+    for (unsigned r = 0; r < 6; r++, d += ldd) {
+        storeTileRowAVX2(d,     src == nullptr ? nullptr : src + r * lds,     acc[r][0], negative);
+        storeTileRowAVX2(d + 4, src == nullptr ? nullptr : src + r * lds + 4, acc[r][1], negative);
+    }
+}
+
+
+//***********************************************************************
+static void mulTPackedAVX2(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+// 6 x 256 a micro-panel (12 kB) + 8 x 256 b micro-panel (16 kB) in L1, 120 x 256 a block (240 kB) in L2
+//***********************************************************************
+    mulTPacked<6, 8, 120, 256, 4096>(microTile6x8AVX2, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 static void mulTAVX2(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    if (nk < 4) { // the masked tail would be the whole work
+        mulTScalar(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    if (MatrixKernels::isPackedSize(ni, nj, nk)) {
+        mulTPackedAVX2(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 2, hj = nj - nj % 4;
+    for (unsigned i = 0; i < hi; i += 2) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block2x4AVX2(d + i * ldd + j, ldd, c + i * ldc + j, ldc, a + i * lda, lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++) {
+            storeMulTResult(d + i * ldd + j, c + i * ldc + j, dotAVX2(a + i * lda, b_t + j * ldb, nk), mode);
+            storeMulTResult(d + (i + 1) * ldd + j, c + (i + 1) * ldc + j, dotAVX2(a + (i + 1) * lda, b_t + j * ldb, nk), mode);
+        }
+    }
+    if (hi < ni) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block1x4AVX2(d + hi * ldd + j, c + hi * ldc + j, a + hi * lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++)
+            storeMulTResult(d + hi * ldd + j, c + hi * ldc + j, dotAVX2(a + hi * lda, b_t + j * ldb, nk), mode);
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline __m256d halfAVX512(__m512d v, int half) noexcept {
+// the low (0) or high (1) 256 bits; GCC 12 implements _mm512_castpd512_pd256 and _mm512_extractf64x4_pd
+// with an undefined merge source (-Wuninitialized), the zero-masking form with an all-ones mask is the
+// same vextractf64x4 (the low half: no instruction)
+//***********************************************************************
+    return half == 0 ? _mm512_maskz_extractf64x4_pd((__mmask8)0xFF, v, 0) : _mm512_maskz_extractf64x4_pd((__mmask8)0xFF, v, 1);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline double hsumAVX512(__m512d v) noexcept {
+// instead of _mm512_reduce_add_pd, which is built on the undefined merge source extract in GCC 12
+//***********************************************************************
+    return hsumAVX2(_mm256_add_pd(halfAVX512(v, 0), halfAVX512(v, 1)));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline __m256d hsum4AVX512(__m512d v0, __m512d v1, __m512d v2, __m512d v3) noexcept {
+//***********************************************************************
+    return hsum4AVX2(
+        _mm256_add_pd(halfAVX512(v0, 0), halfAVX512(v0, 1)),
+        _mm256_add_pd(halfAVX512(v1, 0), halfAVX512(v1, 1)),
+        _mm256_add_pd(halfAVX512(v2, 0), halfAVX512(v2, 1)),
+        _mm256_add_pd(halfAVX512(v3, 0), halfAVX512(v3, 1)));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline __mmask8 kMaskAVX512(unsigned k, unsigned nk) noexcept {
+//***********************************************************************
+    return nk - k >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (nk - k)) - 1);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void block4x4AVX512(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+// 4 x 4 dot products vectorized along k: 16 accumulators + 8 operands of the 32 zmm registers,
+// the k remainder is loaded with zero masking
+//***********************************************************************
+    const double *a0 = a, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+    const double *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m512d s00 = _mm512_setzero_pd(), s01 = _mm512_setzero_pd(), s02 = _mm512_setzero_pd(), s03 = _mm512_setzero_pd();
+    __m512d s10 = _mm512_setzero_pd(), s11 = _mm512_setzero_pd(), s12 = _mm512_setzero_pd(), s13 = _mm512_setzero_pd();
+    __m512d s20 = _mm512_setzero_pd(), s21 = _mm512_setzero_pd(), s22 = _mm512_setzero_pd(), s23 = _mm512_setzero_pd();
+    __m512d s30 = _mm512_setzero_pd(), s31 = _mm512_setzero_pd(), s32 = _mm512_setzero_pd(), s33 = _mm512_setzero_pd();
+    for (unsigned k = 0; k < nk; k += 8) {
+        const __mmask8 m = kMaskAVX512(k, nk);
+        const __m512d va0 = _mm512_maskz_loadu_pd(m, a0 + k), va1 = _mm512_maskz_loadu_pd(m, a1 + k);
+        const __m512d va2 = _mm512_maskz_loadu_pd(m, a2 + k), va3 = _mm512_maskz_loadu_pd(m, a3 + k);
+        __m512d vb = _mm512_maskz_loadu_pd(m, b0 + k);
+        s00 = _mm512_fmadd_pd(va0, vb, s00); s10 = _mm512_fmadd_pd(va1, vb, s10);
+        s20 = _mm512_fmadd_pd(va2, vb, s20); s30 = _mm512_fmadd_pd(va3, vb, s30);
+        vb = _mm512_maskz_loadu_pd(m, b1 + k);
+        s01 = _mm512_fmadd_pd(va0, vb, s01); s11 = _mm512_fmadd_pd(va1, vb, s11);
+        s21 = _mm512_fmadd_pd(va2, vb, s21); s31 = _mm512_fmadd_pd(va3, vb, s31);
+        vb = _mm512_maskz_loadu_pd(m, b2 + k);
+        s02 = _mm512_fmadd_pd(va0, vb, s02); s12 = _mm512_fmadd_pd(va1, vb, s12);
+        s22 = _mm512_fmadd_pd(va2, vb, s22); s32 = _mm512_fmadd_pd(va3, vb, s32);
+        vb = _mm512_maskz_loadu_pd(m, b3 + k);
+        s03 = _mm512_fmadd_pd(va0, vb, s03); s13 = _mm512_fmadd_pd(va1, vb, s13);
+        s23 = _mm512_fmadd_pd(va2, vb, s23); s33 = _mm512_fmadd_pd(va3, vb, s33);
+    }
+    store4AVX2(d, c, hsum4AVX512(s00, s01, s02, s03), mode);
+    store4AVX2(d + ldd, c + ldc, hsum4AVX512(s10, s11, s12, s13), mode);
+    store4AVX2(d + 2 * ldd, c + 2 * ldc, hsum4AVX512(s20, s21, s22, s23), mode);
+    store4AVX2(d + 3 * ldd, c + 3 * ldc, hsum4AVX512(s30, s31, s32, s33), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void block1x4AVX512(double* d, const double* c, const double* a,
+    const double* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    const double *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+    for (unsigned k = 0; k < nk; k += 8) {
+        const __mmask8 m = kMaskAVX512(k, nk);
+        const __m512d va = _mm512_maskz_loadu_pd(m, a + k);
+        s0 = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, b0 + k), s0);
+        s1 = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, b1 + k), s1);
+        s2 = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, b2 + k), s2);
+        s3 = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, b3 + k), s3);
+    }
+    store4AVX2(d, c, hsum4AVX512(s0, s1, s2, s3), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline double dotAVX512(const double* a, const double* b, unsigned nk) noexcept {
+//***********************************************************************
+    __m512d s = _mm512_setzero_pd();
+    for (unsigned k = 0; k < nk; k += 8) {
+        const __mmask8 m = kMaskAVX512(k, nk);
+        s = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + k), _mm512_maskz_loadu_pd(m, b + k), s);
+    }
+    return hsumAVX512(s);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void storeTileRowAVX512(double* d, const double* src, __m512d v, bool negative) noexcept {
+//***********************************************************************
+    if (negative)
+        v = _mm512_sub_pd(_mm512_setzero_pd(), v);
+    if (src != nullptr)
+        v = _mm512_add_pd(_mm512_loadu_pd(src), v);
+    _mm512_storeu_pd(d, v);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 static void microTile8x16AVX512(unsigned kc, const double* ap, const double* bp, double* d, size_t ldd,
+    const double* src, size_t lds, bool negative) noexcept {
+// 16 accumulators + 2 b vectors + 1 broadcast a of the 32 zmm registers
+//***********************************************************************
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd(), c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd(), c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    __m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd(), c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+    __m512d c60 = _mm512_setzero_pd(), c61 = _mm512_setzero_pd(), c70 = _mm512_setzero_pd(), c71 = _mm512_setzero_pd();
+    for (unsigned k = 0; k < kc; k++, ap += 8, bp += 16) {
+        const __m512d b0 = _mm512_loadu_pd(bp), b1 = _mm512_loadu_pd(bp + 8);
+        __m512d av = _mm512_set1_pd(ap[0]);
+        c00 = _mm512_fmadd_pd(av, b0, c00); c01 = _mm512_fmadd_pd(av, b1, c01);
+        av = _mm512_set1_pd(ap[1]);
+        c10 = _mm512_fmadd_pd(av, b0, c10); c11 = _mm512_fmadd_pd(av, b1, c11);
+        av = _mm512_set1_pd(ap[2]);
+        c20 = _mm512_fmadd_pd(av, b0, c20); c21 = _mm512_fmadd_pd(av, b1, c21);
+        av = _mm512_set1_pd(ap[3]);
+        c30 = _mm512_fmadd_pd(av, b0, c30); c31 = _mm512_fmadd_pd(av, b1, c31);
+        av = _mm512_set1_pd(ap[4]);
+        c40 = _mm512_fmadd_pd(av, b0, c40); c41 = _mm512_fmadd_pd(av, b1, c41);
+        av = _mm512_set1_pd(ap[5]);
+        c50 = _mm512_fmadd_pd(av, b0, c50); c51 = _mm512_fmadd_pd(av, b1, c51);
+        av = _mm512_set1_pd(ap[6]);
+        c60 = _mm512_fmadd_pd(av, b0, c60); c61 = _mm512_fmadd_pd(av, b1, c61);
+        av = _mm512_set1_pd(ap[7]);
+        c70 = _mm512_fmadd_pd(av, b0, c70); c71 = _mm512_fmadd_pd(av, b1, c71);
+    }
+    const __m512d acc[8][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 },
+                                { c40, c41 }, { c50, c51 }, { c60, c61 }, { c70, c71 } };
+    for (unsigned r = 0; r < 8; r++, d += ldd) {
+        storeTileRowAVX512(d,     src == nullptr ? nullptr : src + r * lds,     acc[r][0], negative);
+        storeTileRowAVX512(d + 8, src == nullptr ? nullptr : src + r * lds + 8, acc[r][1], negative);
+    }
+}
+
+
+//***********************************************************************
+static void mulTPackedAVX512(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+// 8 x 192 a micro-panel (12 kB) + 16 x 192 b micro-panel (24 kB) in L1, 192 x 192 a block (288 kB) in L2
+//***********************************************************************
+    mulTPacked<8, 16, 192, 192, 4096>(microTile8x16AVX512, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 static void mulTAVX512(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    if (nk < 8) { // half of the zmm lanes would be empty
+        mulTAVX2(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    if (MatrixKernels::isPackedSize(ni, nj, nk)) {
+        mulTPackedAVX512(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 4, hj = nj - nj % 4;
+    for (unsigned i = 0; i < hi; i += 4) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block4x4AVX512(d + i * ldd + j, ldd, c + i * ldc + j, ldc, a + i * lda, lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++)
+            for (unsigned r = i; r < i + 4; r++)
+                storeMulTResult(d + r * ldd + j, c + r * ldc + j, dotAVX512(a + r * lda, b_t + j * ldb, nk), mode);
+    }
+    for (unsigned i = hi; i < ni; i++) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block1x4AVX512(d + i * ldd + j, c + i * ldc + j, a + i * lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++)
+            storeMulTResult(d + i * ldd + j, c + i * ldc + j, dotAVX512(a + i * lda, b_t + j * ldb, nk), mode);
+    }
+}
+
+
+//***********************************************************************
+// Single precision kernels of the mixed precision reduction, the same structure
+// as the double ones with twice as many lanes.
+//***********************************************************************
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline __m128 hsum4AVX2F(__m256 v0, __m256 v1, __m256 v2, __m256 v3) noexcept {
+// { hsum(v0), hsum(v1), hsum(v2), hsum(v3) }
+//***********************************************************************
+    const __m256 t = _mm256_hadd_ps(_mm256_hadd_ps(v0, v1), _mm256_hadd_ps(v2, v3));
+    return _mm_add_ps(_mm256_castps256_ps128(t), _mm256_extractf128_ps(t, 1));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline float hsumAVX2F(__m256 v) noexcept {
+//***********************************************************************
+    return _mm_cvtss_f32(hsum4AVX2F(v, v, v, v));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void store4AVX2F(float* d, const float* c, __m128 sum, MulTMode mode) noexcept {
+//***********************************************************************
+    switch (mode) {
+        case mtmSet: _mm_storeu_ps(d, sum); break;
+        case mtmNeg: _mm_storeu_ps(d, _mm_sub_ps(_mm_setzero_ps(), sum)); break;
+        case mtmAdd: _mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(c), sum)); break;
+        case mtmSub: _mm_storeu_ps(d, _mm_sub_ps(_mm_loadu_ps(c), sum)); break;
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline __m256i tailMaskAVX2F(unsigned dk) noexcept {
+// 1 <= dk <= 7 valid elements
+//***********************************************************************
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)dk), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void block2x4AVX2F(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+    const float* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+// 2 x 4 dot products vectorized along k, the tail is loaded with a mask
+//***********************************************************************
+    const float *a0 = a, *a1 = a + lda;
+    const float *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m256 s00 = _mm256_setzero_ps(), s01 = _mm256_setzero_ps(), s02 = _mm256_setzero_ps(), s03 = _mm256_setzero_ps();
+    __m256 s10 = _mm256_setzero_ps(), s11 = _mm256_setzero_ps(), s12 = _mm256_setzero_ps(), s13 = _mm256_setzero_ps();
+    const unsigned hk = nk - nk % 8;
+    for (unsigned k = 0; k < hk; k += 8) {
+        const __m256 va0 = _mm256_loadu_ps(a0 + k), va1 = _mm256_loadu_ps(a1 + k);
+        __m256 vb = _mm256_loadu_ps(b0 + k);
+        s00 = _mm256_fmadd_ps(va0, vb, s00); s10 = _mm256_fmadd_ps(va1, vb, s10);
+        vb = _mm256_loadu_ps(b1 + k);
+        s01 = _mm256_fmadd_ps(va0, vb, s01); s11 = _mm256_fmadd_ps(va1, vb, s11);
+        vb = _mm256_loadu_ps(b2 + k);
+        s02 = _mm256_fmadd_ps(va0, vb, s02); s12 = _mm256_fmadd_ps(va1, vb, s12);
+        vb = _mm256_loadu_ps(b3 + k);
+        s03 = _mm256_fmadd_ps(va0, vb, s03); s13 = _mm256_fmadd_ps(va1, vb, s13);
+    }
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2F(nk - hk);
+        const __m256 va0 = _mm256_maskload_ps(a0 + hk, m), va1 = _mm256_maskload_ps(a1 + hk, m);
+        __m256 vb = _mm256_maskload_ps(b0 + hk, m);
+        s00 = _mm256_fmadd_ps(va0, vb, s00); s10 = _mm256_fmadd_ps(va1, vb, s10);
+        vb = _mm256_maskload_ps(b1 + hk, m);
+        s01 = _mm256_fmadd_ps(va0, vb, s01); s11 = _mm256_fmadd_ps(va1, vb, s11);
+        vb = _mm256_maskload_ps(b2 + hk, m);
+        s02 = _mm256_fmadd_ps(va0, vb, s02); s12 = _mm256_fmadd_ps(va1, vb, s12);
+        vb = _mm256_maskload_ps(b3 + hk, m);
+        s03 = _mm256_fmadd_ps(va0, vb, s03); s13 = _mm256_fmadd_ps(va1, vb, s13);
+    }
+    store4AVX2F(d, c, hsum4AVX2F(s00, s01, s02, s03), mode);
+    store4AVX2F(d + ldd, c + ldc, hsum4AVX2F(s10, s11, s12, s13), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void block1x4AVX2F(float* d, const float* c, const float* a,
+    const float* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    const float *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+    const unsigned hk = nk - nk % 8;
+    for (unsigned k = 0; k < hk; k += 8) {
+        const __m256 va = _mm256_loadu_ps(a + k);
+        s0 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b0 + k), s0);
+        s1 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b1 + k), s1);
+        s2 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b2 + k), s2);
+        s3 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b3 + k), s3);
+    }
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2F(nk - hk);
+        const __m256 va = _mm256_maskload_ps(a + hk, m);
+        s0 = _mm256_fmadd_ps(va, _mm256_maskload_ps(b0 + hk, m), s0);
+        s1 = _mm256_fmadd_ps(va, _mm256_maskload_ps(b1 + hk, m), s1);
+        s2 = _mm256_fmadd_ps(va, _mm256_maskload_ps(b2 + hk, m), s2);
+        s3 = _mm256_fmadd_ps(va, _mm256_maskload_ps(b3 + hk, m), s3);
+    }
+    store4AVX2F(d, c, hsum4AVX2F(s0, s1, s2, s3), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline float dotAVX2F(const float* a, const float* b, unsigned nk) noexcept {
+//***********************************************************************
+    __m256 s = _mm256_setzero_ps();
+    const unsigned hk = nk - nk % 8;
+    for (unsigned k = 0; k < hk; k += 8)
+        s = _mm256_fmadd_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k), s);
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2F(nk - hk);
+        s = _mm256_fmadd_ps(_mm256_maskload_ps(a + hk, m), _mm256_maskload_ps(b + hk, m), s);
+    }
+    return hsumAVX2F(s);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void storeTileRowAVX2F(float* d, const float* src, __m256 v, bool negative) noexcept {
+//***********************************************************************
+    if (negative)
+        v = _mm256_sub_ps(_mm256_setzero_ps(), v);
+    if (src != nullptr)
+        v = _mm256_add_ps(_mm256_loadu_ps(src), v);
+    _mm256_storeu_ps(d, v);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 static void microTile6x16AVX2F(unsigned kc, const float* ap, const float* bp, float* d, size_t ldd,
+    const float* src, size_t lds, bool negative) noexcept {
+// 12 accumulators + 2 b vectors + 1 broadcast a of the 16 ymm registers
+//***********************************************************************
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for (unsigned k = 0; k < kc; k++, ap += 6, bp += 16) {
+        const __m256 b0 = _mm256_loadu_ps(bp), b1 = _mm256_loadu_ps(bp + 8);
+        __m256 av = _mm256_broadcast_ss(ap);
+        c00 = _mm256_fmadd_ps(av, b0, c00); c01 = _mm256_fmadd_ps(av, b1, c01);
+        av = _mm256_broadcast_ss(ap + 1);
+        c10 = _mm256_fmadd_ps(av, b0, c10); c11 = _mm256_fmadd_ps(av, b1, c11);
+        av = _mm256_broadcast_ss(ap + 2);
+        c20 = _mm256_fmadd_ps(av, b0, c20); c21 = _mm256_fmadd_ps(av, b1, c21);
+        av = _mm256_broadcast_ss(ap + 3);
+        c30 = _mm256_fmadd_ps(av, b0, c30); c31 = _mm256_fmadd_ps(av, b1, c31);
+        av = _mm256_broadcast_ss(ap + 4);
+        c40 = _mm256_fmadd_ps(av, b0, c40); c41 = _mm256_fmadd_ps(av, b1, c41);
+        av = _mm256_broadcast_ss(ap + 5);
+        c50 = _mm256_fmadd_ps(av, b0, c50); c51 = _mm256_fmadd_ps(av, b1, c51);
+    }
+    const __m256 acc[6][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+    for (unsigned r = 0; r < 6; r++, d += ldd) {
+        storeTileRowAVX2F(d,     src == nullptr ? nullptr : src + r * lds,     acc[r][0], negative);
+        storeTileRowAVX2F(d + 8, src == nullptr ? nullptr : src + r * lds + 8, acc[r][1], negative);
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 static void mulTAVX2F(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+    const float* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    if (nk < 8) {
+        mulTScalar(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    if (MatrixKernels::isPackedSize(ni, nj, nk)) { // 6 x 16 micro-tiles, the a and b micro-panels are 6 kB and 16 kB
+        mulTPacked<6, 16, 120, 256, 4096>(microTile6x16AVX2F, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 2, hj = nj - nj % 4;
+    for (unsigned i = 0; i < hi; i += 2) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block2x4AVX2F(d + i * ldd + j, ldd, c + i * ldc + j, ldc, a + i * lda, lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++) {
+            storeMulTResult(d + i * ldd + j, c + i * ldc + j, dotAVX2F(a + i * lda, b_t + j * ldb, nk), mode);
+            storeMulTResult(d + (i + 1) * ldd + j, c + (i + 1) * ldc + j, dotAVX2F(a + (i + 1) * lda, b_t + j * ldb, nk), mode);
+        }
+    }
+    if (hi < ni) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block1x4AVX2F(d + hi * ldd + j, c + hi * ldc + j, a + hi * lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++)
+            storeMulTResult(d + hi * ldd + j, c + hi * ldc + j, dotAVX2F(a + hi * lda, b_t + j * ldb, nk), mode);
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline __m128 hsum4AVX512F(__m512 v0, __m512 v1, __m512 v2, __m512 v3) noexcept {
+//***********************************************************************
+    return hsum4AVX2F(
+        _mm256_add_ps(_mm512_extractf32x8_ps(v0, 0), _mm512_extractf32x8_ps(v0, 1)), // extractf32x8 has a zero merge source, see halfAVX512
+        _mm256_add_ps(_mm512_extractf32x8_ps(v1, 0), _mm512_extractf32x8_ps(v1, 1)),
+        _mm256_add_ps(_mm512_extractf32x8_ps(v2, 0), _mm512_extractf32x8_ps(v2, 1)),
+        _mm256_add_ps(_mm512_extractf32x8_ps(v3, 0), _mm512_extractf32x8_ps(v3, 1)));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline float hsumAVX512F(__m512 v) noexcept {
+// instead of _mm512_reduce_add_ps, see hsumAVX512
+//***********************************************************************
+    return hsumAVX2F(_mm256_add_ps(_mm512_extractf32x8_ps(v, 0), _mm512_extractf32x8_ps(v, 1)));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline __mmask16 kMaskAVX512F(unsigned k, unsigned nk) noexcept {
+//***********************************************************************
+    return nk - k >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (nk - k)) - 1);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void block4x4AVX512F(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+    const float* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+// 4 x 4 dot products vectorized along k, the k remainder is loaded with zero masking
+//***********************************************************************
+    const float *a0 = a, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+    const float *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m512 s00 = _mm512_setzero_ps(), s01 = _mm512_setzero_ps(), s02 = _mm512_setzero_ps(), s03 = _mm512_setzero_ps();
+    __m512 s10 = _mm512_setzero_ps(), s11 = _mm512_setzero_ps(), s12 = _mm512_setzero_ps(), s13 = _mm512_setzero_ps();
+    __m512 s20 = _mm512_setzero_ps(), s21 = _mm512_setzero_ps(), s22 = _mm512_setzero_ps(), s23 = _mm512_setzero_ps();
+    __m512 s30 = _mm512_setzero_ps(), s31 = _mm512_setzero_ps(), s32 = _mm512_setzero_ps(), s33 = _mm512_setzero_ps();
+    for (unsigned k = 0; k < nk; k += 16) {
+        const __mmask16 m = kMaskAVX512F(k, nk);
+        const __m512 va0 = _mm512_maskz_loadu_ps(m, a0 + k), va1 = _mm512_maskz_loadu_ps(m, a1 + k);
+        const __m512 va2 = _mm512_maskz_loadu_ps(m, a2 + k), va3 = _mm512_maskz_loadu_ps(m, a3 + k);
+        __m512 vb = _mm512_maskz_loadu_ps(m, b0 + k);
+        s00 = _mm512_fmadd_ps(va0, vb, s00); s10 = _mm512_fmadd_ps(va1, vb, s10);
+        s20 = _mm512_fmadd_ps(va2, vb, s20); s30 = _mm512_fmadd_ps(va3, vb, s30);
+        vb = _mm512_maskz_loadu_ps(m, b1 + k);
+        s01 = _mm512_fmadd_ps(va0, vb, s01); s11 = _mm512_fmadd_ps(va1, vb, s11);
+        s21 = _mm512_fmadd_ps(va2, vb, s21); s31 = _mm512_fmadd_ps(va3, vb, s31);
+        vb = _mm512_maskz_loadu_ps(m, b2 + k);
+        s02 = _mm512_fmadd_ps(va0, vb, s02); s12 = _mm512_fmadd_ps(va1, vb, s12);
+        s22 = _mm512_fmadd_ps(va2, vb, s22); s32 = _mm512_fmadd_ps(va3, vb, s32);
+        vb = _mm512_maskz_loadu_ps(m, b3 + k);
+        s03 = _mm512_fmadd_ps(va0, vb, s03); s13 = _mm512_fmadd_ps(va1, vb, s13);
+        s23 = _mm512_fmadd_ps(va2, vb, s23); s33 = _mm512_fmadd_ps(va3, vb, s33);
+    }
+    store4AVX2F(d, c, hsum4AVX512F(s00, s01, s02, s03), mode);
+    store4AVX2F(d + ldd, c + ldc, hsum4AVX512F(s10, s11, s12, s13), mode);
+    store4AVX2F(d + 2 * ldd, c + 2 * ldc, hsum4AVX512F(s20, s21, s22, s23), mode);
+    store4AVX2F(d + 3 * ldd, c + 3 * ldc, hsum4AVX512F(s30, s31, s32, s33), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void block1x4AVX512F(float* d, const float* c, const float* a,
+    const float* b_t, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    const float *b0 = b_t, *b1 = b0 + ldb, *b2 = b1 + ldb, *b3 = b2 + ldb;
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps(), s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+    for (unsigned k = 0; k < nk; k += 16) {
+        const __mmask16 m = kMaskAVX512F(k, nk);
+        const __m512 va = _mm512_maskz_loadu_ps(m, a + k);
+        s0 = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, b0 + k), s0);
+        s1 = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, b1 + k), s1);
+        s2 = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, b2 + k), s2);
+        s3 = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, b3 + k), s3);
+    }
+    store4AVX2F(d, c, hsum4AVX512F(s0, s1, s2, s3), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline float dotAVX512F(const float* a, const float* b, unsigned nk) noexcept {
+//***********************************************************************
+    __m512 s = _mm512_setzero_ps();
+    for (unsigned k = 0; k < nk; k += 16) {
+        const __mmask16 m = kMaskAVX512F(k, nk);
+        s = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + k), _mm512_maskz_loadu_ps(m, b + k), s);
+    }
+    return hsumAVX512F(s);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void storeTileRowAVX512F(float* d, const float* src, __m512 v, bool negative) noexcept {
+//***********************************************************************
+    if (negative)
+        v = _mm512_sub_ps(_mm512_setzero_ps(), v);
+    if (src != nullptr)
+        v = _mm512_add_ps(_mm512_loadu_ps(src), v);
+    _mm512_storeu_ps(d, v);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 static void microTile8x32AVX512F(unsigned kc, const float* ap, const float* bp, float* d, size_t ldd,
+    const float* src, size_t lds, bool negative) noexcept {
+// 16 accumulators + 2 b vectors + 1 broadcast a of the 32 zmm registers
+//***********************************************************************
+    __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps(), c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps(), c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+    __m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps(), c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+    __m512 c60 = _mm512_setzero_ps(), c61 = _mm512_setzero_ps(), c70 = _mm512_setzero_ps(), c71 = _mm512_setzero_ps();
+    for (unsigned k = 0; k < kc; k++, ap += 8, bp += 32) {
+        const __m512 b0 = _mm512_loadu_ps(bp), b1 = _mm512_loadu_ps(bp + 16);
+        __m512 av = _mm512_set1_ps(ap[0]);
+        c00 = _mm512_fmadd_ps(av, b0, c00); c01 = _mm512_fmadd_ps(av, b1, c01);
+        av = _mm512_set1_ps(ap[1]);
+        c10 = _mm512_fmadd_ps(av, b0, c10); c11 = _mm512_fmadd_ps(av, b1, c11);
+        av = _mm512_set1_ps(ap[2]);
+        c20 = _mm512_fmadd_ps(av, b0, c20); c21 = _mm512_fmadd_ps(av, b1, c21);
+        av = _mm512_set1_ps(ap[3]);
+        c30 = _mm512_fmadd_ps(av, b0, c30); c31 = _mm512_fmadd_ps(av, b1, c31);
+        av = _mm512_set1_ps(ap[4]);
+        c40 = _mm512_fmadd_ps(av, b0, c40); c41 = _mm512_fmadd_ps(av, b1, c41);
+        av = _mm512_set1_ps(ap[5]);
+        c50 = _mm512_fmadd_ps(av, b0, c50); c51 = _mm512_fmadd_ps(av, b1, c51);
+        av = _mm512_set1_ps(ap[6]);
+        c60 = _mm512_fmadd_ps(av, b0, c60); c61 = _mm512_fmadd_ps(av, b1, c61);
+        av = _mm512_set1_ps(ap[7]);
+        c70 = _mm512_fmadd_ps(av, b0, c70); c71 = _mm512_fmadd_ps(av, b1, c71);
+    }
+    const __m512 acc[8][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 },
+                               { c40, c41 }, { c50, c51 }, { c60, c61 }, { c70, c71 } };
+    for (unsigned r = 0; r < 8; r++, d += ldd) {
+        storeTileRowAVX512F(d,      src == nullptr ? nullptr : src + r * lds,      acc[r][0], negative);
+        storeTileRowAVX512F(d + 16, src == nullptr ? nullptr : src + r * lds + 16, acc[r][1], negative);
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 static void mulTAVX512F(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+    const float* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    if (nk < 16) { // half of the zmm lanes would be empty
+        mulTAVX2F(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    if (MatrixKernels::isPackedSize(ni, nj, nk)) { // 8 x 32 micro-tiles, the a and b micro-panels are 6 kB and 24 kB
+        mulTPacked<8, 32, 192, 192, 4096>(microTile8x32AVX512F, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 4, hj = nj - nj % 4;
+    for (unsigned i = 0; i < hi; i += 4) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block4x4AVX512F(d + i * ldd + j, ldd, c + i * ldc + j, ldc, a + i * lda, lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++)
+            for (unsigned r = i; r < i + 4; r++)
+                storeMulTResult(d + r * ldd + j, c + r * ldc + j, dotAVX512F(a + r * lda, b_t + j * ldb, nk), mode);
+    }
+    for (unsigned i = hi; i < ni; i++) {
+        for (unsigned j = 0; j < hj; j += 4)
+            block1x4AVX512F(d + i * ldd + j, c + i * ldc + j, a + i * lda, b_t + j * ldb, ldb, nk, mode);
+        for (unsigned j = hj; j < nj; j++)
+            storeMulTResult(d + i * ldd + j, c + i * ldc + j, dotAVX512F(a + i * lda, b_t + j * ldb, nk), mode);
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline void cblock2x2AVX2(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+    const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+// 2 x 2 complex dot products on split panels: 8 accumulators + 6 operands,
+// the {re, im, re, im} horizontal sums are already interleaved complex numbers
+//***********************************************************************
+    const double *a0r = aRe, *a0i = aIm, *a1r = aRe + lda, *a1i = aIm + lda;
+    const double *b0r = bRe, *b0i = bIm, *b1r = bRe + ldb, *b1i = bIm + ldb;
+    __m256d re00 = _mm256_setzero_pd(), im00 = _mm256_setzero_pd(), re01 = _mm256_setzero_pd(), im01 = _mm256_setzero_pd();
+    __m256d re10 = _mm256_setzero_pd(), im10 = _mm256_setzero_pd(), re11 = _mm256_setzero_pd(), im11 = _mm256_setzero_pd();
+    const unsigned hk = nk - nk % 4;
+    for (unsigned k = 0; k < hk; k += 4) {
+        const __m256d ar0 = _mm256_loadu_pd(a0r + k), ai0 = _mm256_loadu_pd(a0i + k);
+        const __m256d ar1 = _mm256_loadu_pd(a1r + k), ai1 = _mm256_loadu_pd(a1i + k);
+        __m256d br = _mm256_loadu_pd(b0r + k), bi = _mm256_loadu_pd(b0i + k);
+        re00 = _mm256_fnmadd_pd(ai0, bi, _mm256_fmadd_pd(ar0, br, re00)); im00 = _mm256_fmadd_pd(ai0, br, _mm256_fmadd_pd(ar0, bi, im00));
+        re10 = _mm256_fnmadd_pd(ai1, bi, _mm256_fmadd_pd(ar1, br, re10)); im10 = _mm256_fmadd_pd(ai1, br, _mm256_fmadd_pd(ar1, bi, im10));
+        br = _mm256_loadu_pd(b1r + k); bi = _mm256_loadu_pd(b1i + k);
+        re01 = _mm256_fnmadd_pd(ai0, bi, _mm256_fmadd_pd(ar0, br, re01)); im01 = _mm256_fmadd_pd(ai0, br, _mm256_fmadd_pd(ar0, bi, im01));
+        re11 = _mm256_fnmadd_pd(ai1, bi, _mm256_fmadd_pd(ar1, br, re11)); im11 = _mm256_fmadd_pd(ai1, br, _mm256_fmadd_pd(ar1, bi, im11));
+    }
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2(nk - hk);
+        const __m256d ar0 = _mm256_maskload_pd(a0r + hk, m), ai0 = _mm256_maskload_pd(a0i + hk, m);
+        const __m256d ar1 = _mm256_maskload_pd(a1r + hk, m), ai1 = _mm256_maskload_pd(a1i + hk, m);
+        __m256d br = _mm256_maskload_pd(b0r + hk, m), bi = _mm256_maskload_pd(b0i + hk, m);
+        re00 = _mm256_fnmadd_pd(ai0, bi, _mm256_fmadd_pd(ar0, br, re00)); im00 = _mm256_fmadd_pd(ai0, br, _mm256_fmadd_pd(ar0, bi, im00));
+        re10 = _mm256_fnmadd_pd(ai1, bi, _mm256_fmadd_pd(ar1, br, re10)); im10 = _mm256_fmadd_pd(ai1, br, _mm256_fmadd_pd(ar1, bi, im10));
+        br = _mm256_maskload_pd(b1r + hk, m); bi = _mm256_maskload_pd(b1i + hk, m);
+        re01 = _mm256_fnmadd_pd(ai0, bi, _mm256_fmadd_pd(ar0, br, re01)); im01 = _mm256_fmadd_pd(ai0, br, _mm256_fmadd_pd(ar0, bi, im01));
+        re11 = _mm256_fnmadd_pd(ai1, bi, _mm256_fmadd_pd(ar1, br, re11)); im11 = _mm256_fmadd_pd(ai1, br, _mm256_fmadd_pd(ar1, bi, im11));
+    }
+    store4AVX2((double*)d, (const double*)c, hsum4AVX2(re00, im00, re01, im01), mode);
+    store4AVX2((double*)(d + ldd), (const double*)(c + ldc), hsum4AVX2(re10, im10, re11, im11), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 inline std::complex<double> cdotAVX2(const double* aRe, const double* aIm, const double* bRe, const double* bIm, unsigned nk) noexcept {
+//***********************************************************************
+    __m256d re = _mm256_setzero_pd(), im = _mm256_setzero_pd();
+    const unsigned hk = nk - nk % 4;
+    for (unsigned k = 0; k < hk; k += 4) {
+        const __m256d ar = _mm256_loadu_pd(aRe + k), ai = _mm256_loadu_pd(aIm + k);
+        const __m256d br = _mm256_loadu_pd(bRe + k), bi = _mm256_loadu_pd(bIm + k);
+        re = _mm256_fnmadd_pd(ai, bi, _mm256_fmadd_pd(ar, br, re));
+        im = _mm256_fmadd_pd(ai, br, _mm256_fmadd_pd(ar, bi, im));
+    }
+    if (hk < nk) {
+        const __m256i m = tailMaskAVX2(nk - hk);
+        const __m256d ar = _mm256_maskload_pd(aRe + hk, m), ai = _mm256_maskload_pd(aIm + hk, m);
+        const __m256d br = _mm256_maskload_pd(bRe + hk, m), bi = _mm256_maskload_pd(bIm + hk, m);
+        re = _mm256_fnmadd_pd(ai, bi, _mm256_fmadd_pd(ar, br, re));
+        im = _mm256_fmadd_pd(ai, br, _mm256_fmadd_pd(ar, bi, im));
+    }
+    return std::complex<double>(hsumAVX2(re), hsumAVX2(im));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 static void cmulTSplitAVX2(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+    const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb,
+    unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    if (nk < 2) {
+        cmulTSplitScalar(d, ldd, c, ldc, aRe, aIm, lda, bRe, bIm, ldb, ni, nj, nk, mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 2, hj = nj - nj % 2;
+    for (unsigned i = 0; i < hi; i += 2) {
+        for (unsigned j = 0; j < hj; j += 2)
+            cblock2x2AVX2(d + i * ldd + j, ldd, c + i * ldc + j, ldc, aRe + i * lda, aIm + i * lda, lda, bRe + j * ldb, bIm + j * ldb, ldb, nk, mode);
+        if (hj < nj) {
+            storeMulTResult(d + i * ldd + hj, c + i * ldc + hj, cdotAVX2(aRe + i * lda, aIm + i * lda, bRe + hj * ldb, bIm + hj * ldb, nk), mode);
+            storeMulTResult(d + (i + 1) * ldd + hj, c + (i + 1) * ldc + hj, cdotAVX2(aRe + (i + 1) * lda, aIm + (i + 1) * lda, bRe + hj * ldb, bIm + hj * ldb, nk), mode);
+        }
+    }
+    if (hi < ni)
+        for (unsigned j = 0; j < nj; j++)
+            storeMulTResult(d + hi * ldd + j, c + hi * ldc + j, cdotAVX2(aRe + hi * lda, aIm + hi * lda, bRe + j * ldb, bIm + j * ldb, nk), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX2 static void cRowUpdateAVX2(double* rowRe, double* rowIm, const double* const* pivRe, const double* const* pivIm,
+    const double* CRe, const double* CIm, unsigned bs, unsigned n) noexcept {
+//***********************************************************************
+    const unsigned hn = n - n % 4;
+    for (unsigned q = 0; q < bs; q++) {
+        const __m256d cr = _mm256_set1_pd(CRe[q]), ci = _mm256_set1_pd(CIm[q]);
+        const double *pr = pivRe[q], *pi = pivIm[q];
+        for (unsigned k = 0; k < hn; k += 4) {
+            const __m256d vr = _mm256_loadu_pd(pr + k), vi = _mm256_loadu_pd(pi + k);
+            _mm256_storeu_pd(rowRe + k, _mm256_fmadd_pd(ci, vi, _mm256_fnmadd_pd(cr, vr, _mm256_loadu_pd(rowRe + k))));
+            _mm256_storeu_pd(rowIm + k, _mm256_fnmadd_pd(ci, vr, _mm256_fnmadd_pd(cr, vi, _mm256_loadu_pd(rowIm + k))));
+        }
+        for (unsigned k = hn; k < n; k++) {
+            rowRe[k] -= CRe[q] * pr[k] - CIm[q] * pi[k];
+            rowIm[k] -= CRe[q] * pi[k] + CIm[q] * pr[k];
+        }
+    }
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline void cblock2x2AVX512(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+    const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    const double *a0r = aRe, *a0i = aIm, *a1r = aRe + lda, *a1i = aIm + lda;
+    const double *b0r = bRe, *b0i = bIm, *b1r = bRe + ldb, *b1i = bIm + ldb;
+    __m512d re00 = _mm512_setzero_pd(), im00 = _mm512_setzero_pd(), re01 = _mm512_setzero_pd(), im01 = _mm512_setzero_pd();
+    __m512d re10 = _mm512_setzero_pd(), im10 = _mm512_setzero_pd(), re11 = _mm512_setzero_pd(), im11 = _mm512_setzero_pd();
+    for (unsigned k = 0; k < nk; k += 8) {
+        const __mmask8 m = kMaskAVX512(k, nk);
+        const __m512d ar0 = _mm512_maskz_loadu_pd(m, a0r + k), ai0 = _mm512_maskz_loadu_pd(m, a0i + k);
+        const __m512d ar1 = _mm512_maskz_loadu_pd(m, a1r + k), ai1 = _mm512_maskz_loadu_pd(m, a1i + k);
+        __m512d br = _mm512_maskz_loadu_pd(m, b0r + k), bi = _mm512_maskz_loadu_pd(m, b0i + k);
+        re00 = _mm512_fnmadd_pd(ai0, bi, _mm512_fmadd_pd(ar0, br, re00)); im00 = _mm512_fmadd_pd(ai0, br, _mm512_fmadd_pd(ar0, bi, im00));
+        re10 = _mm512_fnmadd_pd(ai1, bi, _mm512_fmadd_pd(ar1, br, re10)); im10 = _mm512_fmadd_pd(ai1, br, _mm512_fmadd_pd(ar1, bi, im10));
+        br = _mm512_maskz_loadu_pd(m, b1r + k); bi = _mm512_maskz_loadu_pd(m, b1i + k);
+        re01 = _mm512_fnmadd_pd(ai0, bi, _mm512_fmadd_pd(ar0, br, re01)); im01 = _mm512_fmadd_pd(ai0, br, _mm512_fmadd_pd(ar0, bi, im01));
+        re11 = _mm512_fnmadd_pd(ai1, bi, _mm512_fmadd_pd(ar1, br, re11)); im11 = _mm512_fmadd_pd(ai1, br, _mm512_fmadd_pd(ar1, bi, im11));
+    }
+    store4AVX2((double*)d, (const double*)c, hsum4AVX512(re00, im00, re01, im01), mode);
+    store4AVX2((double*)(d + ldd), (const double*)(c + ldc), hsum4AVX512(re10, im10, re11, im11), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 inline std::complex<double> cdotAVX512(const double* aRe, const double* aIm, const double* bRe, const double* bIm, unsigned nk) noexcept {
+//***********************************************************************
+    __m512d re = _mm512_setzero_pd(), im = _mm512_setzero_pd();
+    for (unsigned k = 0; k < nk; k += 8) {
+        const __mmask8 m = kMaskAVX512(k, nk);
+        const __m512d ar = _mm512_maskz_loadu_pd(m, aRe + k), ai = _mm512_maskz_loadu_pd(m, aIm + k);
+        const __m512d br = _mm512_maskz_loadu_pd(m, bRe + k), bi = _mm512_maskz_loadu_pd(m, bIm + k);
+        re = _mm512_fnmadd_pd(ai, bi, _mm512_fmadd_pd(ar, br, re));
+        im = _mm512_fmadd_pd(ai, br, _mm512_fmadd_pd(ar, bi, im));
+    }
+    return std::complex<double>(hsumAVX512(re), hsumAVX512(im));
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 static void cmulTSplitAVX512(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+    const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb,
+    unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    if (nk < 8) {
+        cmulTSplitAVX2(d, ldd, c, ldc, aRe, aIm, lda, bRe, bIm, ldb, ni, nj, nk, mode);
+        return;
+    }
+    const unsigned hi = ni - ni % 2, hj = nj - nj % 2;
+    for (unsigned i = 0; i < hi; i += 2) {
+        for (unsigned j = 0; j < hj; j += 2)
+            cblock2x2AVX512(d + i * ldd + j, ldd, c + i * ldc + j, ldc, aRe + i * lda, aIm + i * lda, lda, bRe + j * ldb, bIm + j * ldb, ldb, nk, mode);
+        if (hj < nj) {
+            storeMulTResult(d + i * ldd + hj, c + i * ldc + hj, cdotAVX512(aRe + i * lda, aIm + i * lda, bRe + hj * ldb, bIm + hj * ldb, nk), mode);
+            storeMulTResult(d + (i + 1) * ldd + hj, c + (i + 1) * ldc + hj, cdotAVX512(aRe + (i + 1) * lda, aIm + (i + 1) * lda, bRe + hj * ldb, bIm + hj * ldb, nk), mode);
+        }
+    }
+    if (hi < ni)
+        for (unsigned j = 0; j < nj; j++)
+            storeMulTResult(d + hi * ldd + j, c + hi * ldc + j, cdotAVX512(aRe + hi * lda, aIm + hi * lda, bRe + j * ldb, bIm + j * ldb, nk), mode);
+}
+
+
+//***********************************************************************
+HMG_TARGET_AVX512 static void cRowUpdateAVX512(double* rowRe, double* rowIm, const double* const* pivRe, const double* const* pivIm,
+    const double* CRe, const double* CIm, unsigned bs, unsigned n) noexcept {
+//***********************************************************************
+    for (unsigned q = 0; q < bs; q++) {
+        const __m512d cr = _mm512_set1_pd(CRe[q]), ci = _mm512_set1_pd(CIm[q]);
+        const double *pr = pivRe[q], *pi = pivIm[q];
+        for (unsigned k = 0; k < n; k += 8) {
+            const __mmask8 m = kMaskAVX512(k, n);
+            const __m512d vr = _mm512_maskz_loadu_pd(m, pr + k), vi = _mm512_maskz_loadu_pd(m, pi + k);
+            _mm512_mask_storeu_pd(rowRe + k, m, _mm512_fmadd_pd(ci, vi, _mm512_fnmadd_pd(cr, vr, _mm512_maskz_loadu_pd(m, rowRe + k))));
+            _mm512_mask_storeu_pd(rowIm + k, m, _mm512_fnmadd_pd(ci, vr, _mm512_fnmadd_pd(cr, vi, _mm512_maskz_loadu_pd(m, rowIm + k))));
+        }
+    }
+}
+
+
+//***********************************************************************
+static void cpuid(int regs[4], int leaf, int subleaf) noexcept {
+//***********************************************************************
+#ifdef _MSC_VER
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned r[4] = { 0, 0, 0, 0 };
+    __cpuid_count(leaf, subleaf, r[0], r[1], r[2], r[3]);
+    for (int i = 0; i < 4; i++)
+        regs[i] = (int)r[i];
+#endif
+}
+
+
+//***********************************************************************
+static unsigned long long xgetbv0() noexcept {
+//***********************************************************************
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned lo = 0, hi = 0;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+
+//***********************************************************************
+static KernelLevel detectKernelLevel() noexcept {
+// the CPU has to support the instructions and the OS has to save the registers
+//***********************************************************************
+    int regs[4];
+    cpuid(regs, 0, 0);
+    if (regs[0] < 7)
+        return klScalar;
+    cpuid(regs, 1, 0);
+    const bool isOSXSAVE = (regs[2] & (1 << 27)) != 0;
+    const bool isFMA     = (regs[2] & (1 << 12)) != 0;
+    if (!isOSXSAVE || !isFMA)
+        return klScalar;
+    const unsigned long long xcr0 = xgetbv0();
+    if ((xcr0 & 0x6) != 0x6) // XMM and YMM state
+        return klScalar;
+    cpuid(regs, 7, 0);
+    const bool isAVX2     = (regs[1] & (1 << 5))  != 0;
+    const bool isAVX512F  = (regs[1] & (1 << 16)) != 0;
+    const bool isAVX512DQ = (regs[1] & (1 << 17)) != 0;
+    if (!isAVX2)
+        return klScalar;
+    if (isAVX512F && isAVX512DQ && (xcr0 & 0xE0) == 0xE0) // opmask and ZMM state
+        return klAVX512;
+    return klAVX2;
+}
+
+
+#else
+
+
+//***********************************************************************
+static KernelLevel detectKernelLevel() noexcept { return klScalar; }
+//***********************************************************************
+
+
+#endif
+
+
+//***********************************************************************
+MulTKernel MatrixKernels::mulT = mulTScalar<double>;
+MulTKernelF MatrixKernels::mulTF = mulTScalar<float>;
+CMulTSplitKernel MatrixKernels::cmulTSplit = cmulTSplitScalar;
+CRowUpdateKernel MatrixKernels::cRowUpdate = cRowUpdateScalar;
+KernelLevel MatrixKernels::level = klScalar;
+KernelLevel MatrixKernels::maxLevel = klScalar;
+unsigned MatrixKernels::packedMinSize = 64;
+unsigned MatrixKernels::blockedInvMinSize = 256;
+unsigned MatrixKernels::parallelMinSize = 128;
+bool MatrixKernels::isInitialized = MatrixKernels::init();
+//***********************************************************************
+
+
+//***********************************************************************
+bool MatrixKernels::init() noexcept {
+//***********************************************************************
+    maxLevel = detectKernelLevel();
+    setLevel(maxLevel);
+    return true;
+}
+
+
+//***********************************************************************
+void MatrixKernels::setLevel(KernelLevel newLevel) noexcept {
+//***********************************************************************
+    level = newLevel > maxLevel ? maxLevel : newLevel;
+    mulT = getMulTKernel(level);
+    mulTF = getMulTKernelF(level);
+#ifdef HMG_KERNELS_X64
+    switch (level) {
+        case klAVX2:   cmulTSplit = cmulTSplitAVX2;   cRowUpdate = cRowUpdateAVX2;   break;
+        case klAVX512: cmulTSplit = cmulTSplitAVX512; cRowUpdate = cRowUpdateAVX512; break;
+        default:       cmulTSplit = cmulTSplitScalar; cRowUpdate = cRowUpdateScalar; break;
+    }
+#endif
+}
+
+
+//***********************************************************************
+MulTKernel MatrixKernels::getMulTKernel(KernelLevel kernelLevel) noexcept {
+//***********************************************************************
+    if (kernelLevel > maxLevel)
+        return mulTScalar<double>;
+#ifdef HMG_KERNELS_X64
+    switch (kernelLevel) {
+        case klAVX2:   return mulTAVX2;
+        case klAVX512: return mulTAVX512;
+        default:       return mulTScalar<double>;
+    }
+#else
+    return mulTScalar<double>;
+#endif
+}
+
+
+//***********************************************************************
+MulTKernelF MatrixKernels::getMulTKernelF(KernelLevel kernelLevel) noexcept {
+//***********************************************************************
+    if (kernelLevel > maxLevel)
+        return mulTScalar<float>;
+#ifdef HMG_KERNELS_X64
+    switch (kernelLevel) {
+        case klAVX2:   return mulTAVX2F;
+        case klAVX512: return mulTAVX512F;
+        default:       return mulTScalar<float>;
+    }
+#else
+    return mulTScalar<float>;
+#endif
+}
+
+
+//***********************************************************************
+void MatrixKernels::setPackedMinSize(unsigned newSize) noexcept {
+//***********************************************************************
+    packedMinSize = newSize == 0 ? 1 : newSize;
+}
+
+
+//***********************************************************************
+void MatrixKernels::setBlockedInvMinSize(unsigned newSize) noexcept {
+//***********************************************************************
+    blockedInvMinSize = newSize < 8 ? 8 : newSize;
+}
+
+
+//***********************************************************************
+void MatrixKernels::setParallelMinSize(unsigned newSize) noexcept {
+//***********************************************************************
+    parallelMinSize = newSize < 8 ? 8 : newSize;
+}
+
+
+//***********************************************************************
+template<typename Real, typename Kernel>
+static void mulTRowBlocks(Kernel kernel, Real* d, size_t ldd, const Real* c, size_t ldc, const Real* a, size_t lda,
+    const Real* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) {
+// the rows of d are independent, every thread gets a contiguous range of row blocks; the last block
+// takes the remaining rows, so every block is large enough for the packed kernel, as the whole product,
+// and the result does not depend on the number of threads
+//***********************************************************************
+    const unsigned rowBlock = MatrixKernels::getPackedMinSize() < 16 ? 16 : MatrixKernels::getPackedMinSize();
+    const unsigned nBlocks = ni < 2 * rowBlock ? 1 : ni / rowBlock;
+    ThreadPool::getInstance().parallelFor(nBlocks, [&](unsigned begin, unsigned end) {
+        const unsigned i0 = begin * rowBlock, i1 = end == nBlocks ? ni : end * rowBlock;
+        kernel(d + i0 * ldd, ldd, c == nullptr ? nullptr : c + i0 * ldc, ldc, a + i0 * lda, lda, b_t, ldb, i1 - i0, nj, nk, mode);
+    });
+}
+
+
+//***********************************************************************
+void MatrixKernels::mul_t_parallel(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    mulTRowBlocks(mulT, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+}
+
+
+//***********************************************************************
+void MatrixKernels::mul_t_parallel(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+    const float* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+//***********************************************************************
+    mulTRowBlocks(mulTF, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+}
+
+
+//***********************************************************************
+const char* MatrixKernels::getLevelName(KernelLevel kernelLevel) noexcept {
+//***********************************************************************
+    switch (kernelLevel) {
+        case klAVX2:   return "AVX2";
+        case klAVX512: return "AVX-512";
+        default:       return "scalar";
+    }
+}
+
+
+
+//***********************************************************************
+void SplitComplexPanel::pack(const std::complex<double>* src, size_t ld, unsigned new_rows, unsigned new_cols) {
+//***********************************************************************
+    rows = new_rows;
+    cols = new_cols;
+    re.resize((size_t)rows * cols);
+    im.resize((size_t)rows * cols);
+    for (unsigned i = 0; i < rows; i++) {
+        const std::complex<double>* src_row = src + i * ld;
+        double *re_row = re.data() + (size_t)i * cols, *im_row = im.data() + (size_t)i * cols;
+        for (unsigned j = 0; j < cols; j++) {
+            re_row[j] = src_row[j].real();
+            im_row[j] = src_row[j].imag();
+        }
+    }
+}
+
+
+//***********************************************************************
+void SplitComplexPanel::unpack(std::complex<double>* dest, size_t ld) const noexcept {
+//***********************************************************************
+    for (unsigned i = 0; i < rows; i++) {
+        std::complex<double>* dest_row = dest + i * ld;
+        const double *re_row = re.data() + (size_t)i * cols, *im_row = im.data() + (size_t)i * cols;
+        for (unsigned j = 0; j < cols; j++)
+            dest_row[j] = std::complex<double>(re_row[j], im_row[j]);
+    }
+}
+
+
+//***********************************************************************
+void MatrixKernels::mul_t(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc, const std::complex<double>* a, size_t lda,
+    const std::complex<double>* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) {
+//***********************************************************************
+    static thread_local SplitComplexPanel aPanel, bPanel;
+    bPanel.pack(b_t, ldb, nj, nk);
+    if (isParallelSize(ni, nj, nk)) { // b_t is packed once, the row blocks of a are packed by the threads
+        const SplitComplexPanel& bShared = bPanel;
+        mulTRowBlocks([&bShared](std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc, const std::complex<double>* a, size_t lda,
+            const std::complex<double>*, size_t, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) {
+                aPanel.pack(a, lda, ni, nk);
+                cmulTSplit(d, ldd, c, ldc, aPanel.getRe(), aPanel.getIm(), nk, bShared.getRe(), bShared.getIm(), nk, ni, nj, nk, mode);
+            }, d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        return;
+    }
+    aPanel.pack(a, lda, ni, nk);
+    cmulTSplit(d, ldd, c, ldc, aPanel.getRe(), aPanel.getIm(), nk, bPanel.getRe(), bPanel.getIm(), nk, ni, nj, nk, mode);
+}
+
+
+//***********************************************************************
+template<typename Real>
+static void invBlock(Real* a, size_t ld, unsigned n) noexcept {
+// in-place inverse of the n x n block without pivoting, with the 1e-20 guard of matrix::math_ninv_np
+//***********************************************************************
+    for (unsigned i = 0; i < n; i++) {
+        Real* row_i = a + i * ld;
+        const Real divisor = std::abs(row_i[i]) < Real(1e-20) ? Real(1e20) : Real(1) / row_i[i];
+        for (unsigned j = 0; j < n; j++) {
+            if (j == i)
+                continue;
+            Real* row_j = a + j * ld;
+            const Real C = row_j[i] * divisor;
+            for (unsigned k = 0; k < n; k++)
+                row_j[k] -= C * row_i[k];
+            row_j[i] = -C;
+        }
+        for (unsigned k = 0; k < n; k++)
+            row_i[k] *= divisor;
+        row_i[i] = divisor;
+    }
+}
+
+
+//***********************************************************************
+template<typename Real>
+static void ninvBlocked(Real* m, size_t ld, unsigned n, void (*mulT)(Real* d, size_t ldd, const Real* c, size_t ldc, const Real* a, size_t lda,
+    const Real* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode)) {
+// Blocked Gauss-Jordan elimination without pivoting. For every pivot block K (i, j are not in K):
+//     P = inv(A_KK),  A_Kj = P * A_Kj,  A_ij -= A_iK * A_Kj,  A_iK = -A_iK * P,  A_KK = P,
+// finally the result is negated. The A_ij update is 2 * n^2 * nb flops of mul_t per block,
+// the rows are distributed among the threads of the pool.
+//***********************************************************************
+    constexpr unsigned nb = 64;
+    ThreadPool& pool = ThreadPool::getInstance();
+    std::vector<Real> rowPanelT((size_t)n * nb), pivotT(nb * nb); // (P * A_K*)T, PT
+    Real* const T = rowPanelT.data();
+
+    for (unsigned k0 = 0; k0 < n; k0 += nb) {
+        const unsigned kb = n - k0 < nb ? n - k0 : nb;
+        const unsigned k1 = k0 + kb;
+        Real* const P = m + k0 * ld + k0;
+        invBlock(P, ld, kb);
+        for (unsigned q = 0; q < kb; q++)
+            for (unsigned p = 0; p < kb; p++)
+                pivotT[q * kb + p] = P[p * ld + q];
+
+        // A_Kj = P * A_Kj, the columns are distributed
+
+        pool.parallelFor(n, [&](unsigned begin, unsigned end) {
+            static thread_local std::vector<Real> work;
+            work.resize((size_t)(end - begin) * kb);
+            for (unsigned j = begin; j < end; j++)
+                for (unsigned p = 0; p < kb; p++)
+                    work[(j - begin) * kb + p] = m[(k0 + p) * ld + j];
+            mulT(T + begin * kb, kb, nullptr, 0, work.data(), kb, P, ld, end - begin, kb, kb, mtmSet);
+            for (unsigned j = begin; j < end; j++)
+                if (j < k0 || j >= k1)
+                    for (unsigned q = 0; q < kb; q++)
+                        m[(k0 + q) * ld + j] = T[j * kb + q];
+        });
+
+        // A_ij -= A_iK * A_Kj and A_iK = -A_iK * P, the rows are distributed
+
+        pool.parallelFor(n, [&](unsigned begin, unsigned end) {
+            static thread_local std::vector<Real> work;
+            const unsigned ranges[2][2] = { { begin, end < k0 ? end : k0 }, { begin > k1 ? begin : k1, end } };
+            for (const auto& range : ranges) {
+                if (range[0] >= range[1])
+                    continue;
+                const unsigned ni = range[1] - range[0];
+                Real* const row = m + range[0] * ld;
+                if (k0 > 0)
+                    mulT(row, ld, row, ld, row + k0, ld, T, kb, ni, k0, kb, mtmSub);
+                if (k1 < n)
+                    mulT(row + k1, ld, row + k1, ld, row + k0, ld, T + k1 * kb, kb, ni, n - k1, kb, mtmSub);
+                work.resize((size_t)ni * kb);
+                mulT(work.data(), kb, nullptr, 0, row + k0, ld, pivotT.data(), kb, ni, kb, kb, mtmNeg);
+                for (unsigned i = 0; i < ni; i++)
+                    for (unsigned q = 0; q < kb; q++)
+                        row[i * ld + k0 + q] = work[i * kb + q];
+            }
+        });
+    }
+
+    pool.parallelFor(n, [&](unsigned begin, unsigned end) {
+        for (unsigned i = begin; i < end; i++)
+            for (unsigned j = 0; j < n; j++)
+                m[i * ld + j] = -m[i * ld + j];
+    });
+}
+
+
+//***********************************************************************
+void MatrixKernels::ninv_np(double* m, size_t ld, unsigned n) {
+//***********************************************************************
+    ninvBlocked(m, ld, n, mulT);
+}
+
+
+//***********************************************************************
+void MatrixKernels::ninv_np(float* m, size_t ld, unsigned n) {
+//***********************************************************************
+    ninvBlocked(m, ld, n, mulTF);
+}
+
+
+//***********************************************************************
+inline std::complex<double> cmulPlain(const std::complex<double>& a, const std::complex<double>& b) noexcept {
+// without the inf/nan handling of the library operator
+//***********************************************************************
+    return std::complex<double>(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+
+//***********************************************************************
+static void cinvBlock(std::complex<double> (&a)[4][4], unsigned bs) noexcept {
+// in-place inverse of the bs x bs block without pivoting, the Gauss-Jordan steps of matrix::math_inv_4x4_fv
+//***********************************************************************
+    for (unsigned i = 0; i < bs; i++) {
+        const std::complex<double> divisor = abs(a[i][i]) < 1e-20 ? std::complex<double>(1e20) : 1.0 / a[i][i];
+        for (unsigned j = 0; j < bs; j++) {
+            if (j == i)
+                continue;
+            const std::complex<double> C = cmulPlain(a[j][i], divisor);
+            for (unsigned k = 0; k < bs; k++)
+                if (k != i)
+                    a[j][k] -= cmulPlain(C, a[i][k]);
+            a[j][i] = -C;
+        }
+        for (unsigned k = 0; k < bs; k++)
+            if (k != i)
+                a[i][k] = cmulPlain(a[i][k], divisor);
+        a[i][i] = divisor;
+    }
+}
+
+
+//***********************************************************************
+void MatrixKernels::cninv_np(std::complex<double>* m, size_t ld, unsigned n) {
+// The block Gauss-Jordan elimination of matrix::math_ninv_np: 4x4 pivot blocks, then 1x1 pivots
+// for the remaining n % 4 rows. The O(n^3) part is the row update, that runs on split storage.
+//***********************************************************************
+    static thread_local SplitComplexPanel panel;
+    panel.pack(m, ld, n, n);
+    double *re = panel.getRe(), *im = panel.getIm();
+    const unsigned hn = n - n % 4;
+    for (unsigned p = 0; p < n;) {
+        const unsigned bs = p < hn ? 4 : 1;
+        std::complex<double> inv[4][4];
+        const double *pivRe[4], *pivIm[4];
+        for (unsigned r = 0; r < bs; r++) {
+            pivRe[r] = re + (size_t)(p + r) * n;
+            pivIm[r] = im + (size_t)(p + r) * n;
+            for (unsigned q = 0; q < bs; q++)
+                inv[r][q] = std::complex<double>(pivRe[r][p + q], pivIm[r][p + q]);
+        }
+        cinvBlock(inv, bs);
+
+        // the other rows, distributed among the threads for the large matrices
+
+        auto updateRows = [&](unsigned begin, unsigned end) {
+            for (unsigned j = begin; j < end; j++) {
+                if (j >= p && j < p + bs)
+                    continue;
+                double *rowRe = re + (size_t)j * n, *rowIm = im + (size_t)j * n;
+                double CRe[4], CIm[4];
+                for (unsigned q = 0; q < bs; q++) {
+                    std::complex<double> C = 0.0;
+                    for (unsigned r = 0; r < bs; r++)
+                        C += cmulPlain(std::complex<double>(rowRe[p + r], rowIm[p + r]), inv[r][q]);
+                    CRe[q] = C.real();
+                    CIm[q] = C.imag();
+                }
+                cRowUpdate(rowRe, rowIm, pivRe, pivIm, CRe, CIm, bs, n);
+                for (unsigned q = 0; q < bs; q++) {
+                    rowRe[p + q] = CRe[q]; // in case of non-negating inv = -C;
+                    rowIm[p + q] = CIm[q];
+                }
+            }
+        };
+        if (isBlockedInvSize(n))
+            ThreadPool::getInstance().parallelFor(n, updateRows);
+        else
+            updateRows(0, n);
+
+        // the pivot rows
+
+        for (unsigned k = 0; k < n; k++) {
+            if (k == p) {
+                k += bs - 1;
+                continue;
+            }
+            std::complex<double> old[4];
+            for (unsigned q = 0; q < bs; q++)
+                old[q] = std::complex<double>(pivRe[q][k], pivIm[q][k]);
+            for (unsigned r = 0; r < bs; r++) {
+                std::complex<double> sum = 0.0;
+                for (unsigned q = 0; q < bs; q++)
+                    sum += cmulPlain(inv[r][q], old[q]);
+                re[(size_t)(p + r) * n + k] = sum.real();
+                im[(size_t)(p + r) * n + k] = sum.imag();
+            }
+        }
+        for (unsigned r = 0; r < bs; r++)
+            for (unsigned q = 0; q < bs; q++) {
+                re[(size_t)(p + r) * n + p + q] = -inv[r][q].real(); // in case of non-negating inv = inv;
+                im[(size_t)(p + r) * n + p + q] = -inv[r][q].imag();
+            }
+        p += bs;
+    }
+    panel.unpack(m, ld);
+}
+
+}
@@ -0,0 +1,187 @@
+//***********************************************************************
+// HexMG Matrix Kernels Header
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_MATRIX_KERNELS_HEADER
+#define	HMG_MATRIX_KERNELS_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include <cstddef>
+#include <complex>
+#include <vector>
+#include <type_traits>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+enum MulTMode {
+// d = op(c, a * b_t), where the rows of b_t are the columns of b
+//***********************************************************************
+    mtmSet, // d =  a * b_t, c is not read
+    mtmNeg, // d = -a * b_t, c is not read
+    mtmAdd, // d =  c + a * b_t
+    mtmSub  // d =  c - a * b_t
+};
+
+
+//***********************************************************************
+enum KernelLevel {
+//***********************************************************************
+    klScalar, klAVX2, klAVX512
+};
+
+
+//***********************************************************************
+// ni x nk a, nj x nk b_t, ni x nj c and d, row-major with ld* row strides
+// d can be the same as c, but cannot overlap a or b_t
+// if nk == 0, a and b_t are not read
+using MulTKernel = void (*)(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+    const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode);
+//***********************************************************************
+
+
+//***********************************************************************
+// Single precision real kernel of the mixed precision reduction, same parameters as MulTKernel.
+using MulTKernelF = void (*)(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+    const float* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode);
+//***********************************************************************
+
+
+//***********************************************************************
+// Complex kernels. The matrices remain interleaved std::complex<double>, the a and b_t
+// operands are repacked into split real / imaginary panels (see SplitComplexPanel),
+// so the vectorized loops do not need any shuffle or the generic complex multiplication.
+using CMulTSplitKernel = void (*)(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+    const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb,
+    unsigned ni, unsigned nj, unsigned nk, MulTMode mode);
+// row -= sum(C[q] * pivot[q]), q = 0...bs-1, on n split complex elements
+using CRowUpdateKernel = void (*)(double* rowRe, double* rowIm, const double* const* pivRe, const double* const* pivIm,
+    const double* CRe, const double* CIm, unsigned bs, unsigned n);
+//***********************************************************************
+
+
+//***********************************************************************
+template<typename T>
+inline constexpr bool hasMatrixKernel = std::is_same<T, double>::value || std::is_same<T, float>::value || std::is_same<T, std::complex<double>>::value;
+template<typename T>
+inline constexpr bool hasRealMatrixKernel = std::is_same<T, double>::value || std::is_same<T, float>::value;
+//***********************************************************************
+
+
+//***********************************************************************
+class SplitComplexPanel {
+// rows x cols complex matrix in two row-major double arrays, the row stride is cols
+//***********************************************************************
+    std::vector<double> re, im;
+    unsigned rows = 0, cols = 0;
+public:
+    //***********************************************************************
+    void pack(const std::complex<double>* src, size_t ld, unsigned new_rows, unsigned new_cols);
+    void unpack(std::complex<double>* dest, size_t ld) const noexcept;
+    double* getRe() noexcept { return re.data(); }
+    double* getIm() noexcept { return im.data(); }
+    const double* getRe() const noexcept { return re.data(); }
+    const double* getIm() const noexcept { return im.data(); }
+    unsigned getRows() const noexcept { return rows; }
+    unsigned getCols() const noexcept { return cols; }
+    //***********************************************************************
+};
+
+
+//***********************************************************************
+class MatrixKernels {
+// The kernel set is selected by CPUID when the program starts,
+// setLevel is for benchmarking and debugging.
+//***********************************************************************
+    static MulTKernel mulT;
+    static MulTKernelF mulTF;
+    static CMulTSplitKernel cmulTSplit;
+    static CRowUpdateKernel cRowUpdate;
+    static KernelLevel level;
+    static KernelLevel maxLevel;
+    static unsigned packedMinSize;
+    static unsigned blockedInvMinSize;
+    static unsigned parallelMinSize;
+    static bool init() noexcept;
+    static void mul_t_parallel(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+        const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept;
+    static void mul_t_parallel(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+        const float* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept;
+    static bool isInitialized;
+public:
+    //***********************************************************************
+    static void mul_t(double* d, size_t ldd, const double* c, size_t ldc, const double* a, size_t lda,
+        const double* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+    //***********************************************************************
+        if (isParallelSize(ni, nj, nk))
+            mul_t_parallel(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        else
+            mulT(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+    }
+    //***********************************************************************
+    static void mul_t(float* d, size_t ldd, const float* c, size_t ldc, const float* a, size_t lda,
+        const float* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+    //***********************************************************************
+        if (isParallelSize(ni, nj, nk))
+            mul_t_parallel(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+        else
+            mulTF(d, ldd, c, ldc, a, lda, b_t, ldb, ni, nj, nk, mode);
+    }
+    //***********************************************************************
+    static void cmul_t_split(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc,
+        const double* aRe, const double* aIm, size_t lda, const double* bRe, const double* bIm, size_t ldb,
+        unsigned ni, unsigned nj, unsigned nk, MulTMode mode) noexcept {
+    //***********************************************************************
+        cmulTSplit(d, ldd, c, ldc, aRe, aIm, lda, bRe, bIm, ldb, ni, nj, nk, mode);
+    }
+    //***********************************************************************
+    static void mul_t(std::complex<double>* d, size_t ldd, const std::complex<double>* c, size_t ldc, const std::complex<double>* a, size_t lda,
+        const std::complex<double>* b_t, size_t ldb, unsigned ni, unsigned nj, unsigned nk, MulTMode mode); // packs a and b_t, parallel as the real one
+    static void ninv_np(double* m, size_t ld, unsigned n); // blocked and multithreaded -inverse without pivoting, like matrix::math_ninv_np
+    static void ninv_np(float* m, size_t ld, unsigned n);
+    static void cninv_np(std::complex<double>* m, size_t ld, unsigned n); // -inverse without pivoting, like matrix::math_ninv_np
+    //***********************************************************************
+    static KernelLevel getLevel() noexcept { return level; }
+    static KernelLevel getMaxLevel() noexcept { return maxLevel; }
+    static void setLevel(KernelLevel newLevel) noexcept; // limited to getMaxLevel()
+    static MulTKernel getMulTKernel(KernelLevel kernelLevel) noexcept; // scalar if kernelLevel is not supported
+    static MulTKernelF getMulTKernelF(KernelLevel kernelLevel) noexcept;
+    static const char* getLevelName(KernelLevel kernelLevel) noexcept;
+    //***********************************************************************
+    // The SIMD levels switch to the packed, cache blocked product if every dimension reaches packedMinSize.
+    static bool isPackedSize(unsigned ni, unsigned nj, unsigned nk) noexcept {
+        return ni >= packedMinSize && nj >= packedMinSize && nk >= packedMinSize;
+    }
+    static unsigned getPackedMinSize() noexcept { return packedMinSize; }
+    static void setPackedMinSize(unsigned newSize) noexcept; // for benchmarking, 0 is taken as 1
+    //***********************************************************************
+    // The inversions above blockedInvMinSize run blocked (real) and on the threads of ThreadPool.
+    static bool isBlockedInvSize(unsigned n) noexcept { return n >= blockedInvMinSize; }
+    static unsigned getBlockedInvMinSize() noexcept { return blockedInvMinSize; }
+    static void setBlockedInvMinSize(unsigned newSize) noexcept; // for benchmarking, at least 8
+    //***********************************************************************
+    // The products above parallelMinSize in every dimension are split into row blocks on the threads
+    // of ThreadPool. In a pool job (e.g. in the wide levels of a SUNRED tree) they run in one thread.
+    static bool isParallelSize(unsigned ni, unsigned nj, unsigned nk) noexcept {
+        return ni >= parallelMinSize && nj >= parallelMinSize && nk >= parallelMinSize;
+    }
+    static unsigned getParallelMinSize() noexcept { return parallelMinSize; }
+    static void setParallelMinSize(unsigned newSize) noexcept; // for benchmarking, at least 8
+    //***********************************************************************
+};
+
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+//***********************************************************************
+// HexMG Reduction Cache CPP
+// Creation date:  2026. 10. 18.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgReductionCache.h"
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+void ReductionCache::erase(std::list<Entry>::iterator it) {
+// the mutex is locked by the caller
+//***********************************************************************
+    auto range = byHash.equal_range(it->key.hash);
+    for (auto h = range.first; h != range.second; ++h)
+        if (h->second == it) {
+            byHash.erase(h);
+            break;
+        }
+    bytes -= it->bytes;
+    entries.erase(it);
+}
+
+
+//***********************************************************************
+bool ReductionCache::load(const Key& key, matrix<rvt>& YRED, matrix<rvt>& NZB, matrix<rvt>& NZBXAT) {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = byHash.equal_range(key.hash);
+    for (auto h = range.first; h != range.second; ++h) {
+        const Entry& entry = *h->second;
+        if (!(entry.key == key) || entry.YRED.size() != YRED.size() || entry.NZB.size() != NZB.size() || entry.NZBXAT.size() != NZBXAT.size())
+            continue;
+        YRED.copy_unsafe(entry.YRED);
+        NZB.copy_unsafe(entry.NZB);
+        NZBXAT.copy_unsafe(entry.NZBXAT);
+        entries.splice(entries.begin(), entries, h->second);
+        return true;
+    }
+    return false;
+}
+
+
+//***********************************************************************
+void ReductionCache::store(const Key& key, const matrix<rvt>& YRED, const matrix<rvt>& NZB, const matrix<rvt>& NZBXAT) {
+//***********************************************************************
+    const size_t entryBytes = sizeof(Entry) + (key.admittances.size() + YRED.size() + NZB.size() + NZBXAT.size()) * sizeof(rvt);
+    if (entryBytes > memoryCap)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = byHash.equal_range(key.hash);
+    for (auto h = range.first; h != range.second; ++h)
+        if (h->second->key == key) // stored by another instance
+            return;
+    while (!entries.empty() && bytes + entryBytes > memoryCap)
+        erase(std::prev(entries.end()));
+    entries.emplace_front();
+    Entry& entry = entries.front();
+    entry.key = key;
+    entry.YRED.resize_if_needed(YRED.get_row(), YRED.get_col(), YRED.get_is_symm());
+    entry.YRED.copy_unsafe(YRED);
+    entry.NZB.resize_if_needed(NZB.get_row(), NZB.get_col(), NZB.get_is_symm());
+    entry.NZB.copy_unsafe(NZB);
+    entry.NZBXAT.resize_if_needed(NZBXAT.get_row(), NZBXAT.get_col(), NZBXAT.get_is_symm());
+    entry.NZBXAT.copy_unsafe(NZBXAT);
+    entry.bytes = entryBytes;
+    bytes += entryBytes;
+    byHash.emplace(key.hash, entries.begin());
+}
+
+
+//***********************************************************************
+void ReductionCache::eraseModel(uns modelIndex) {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto next = std::next(it);
+        if (it->key.modelIndex == modelIndex)
+            erase(it);
+        it = next;
+    }
+}
+
+
+//***********************************************************************
+void ReductionCache::clear() {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(mutex);
+    byHash.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+
+}
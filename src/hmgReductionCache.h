@@ -0,0 +1,80 @@
+//***********************************************************************
+// HexMG Reduction Cache Header
+// Creation date:  2026. 10. 18.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_REDUCTION_CACHE_HEADER
+#define	HMG_REDUCTION_CACHE_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgCommon.h"
+#include "hmgMatrix.hpp"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+class ReductionCache {
+// Process-wide cache of the full matrix DC reductions (YRED, NZB, NZBXAT) of linear subcircuits, e.g. for
+// the .SET + .RUN sweeps. The key is the model (index and version), the symmetry, the precision and the
+// stamped admittances, which contain the effect of every parameter. The least recently used entries are
+// evicted if the stored matrices exceed memoryCap.
+//***********************************************************************
+public:
+    //***********************************************************************
+    struct Key {
+        uns modelIndex = 0;     // in CircuitStorage::models
+        uns modelVersion = 0;
+        bool isSymm = false;
+        bool isFloat = false;   // mixed precision reduction
+        size_t hash = 0;        // of all the above and the admittances
+        std::vector<rvt> admittances;
+        bool operator==(const Key& other) const noexcept {
+            return hash == other.hash && modelIndex == other.modelIndex && modelVersion == other.modelVersion
+                && isSymm == other.isSymm && isFloat == other.isFloat && admittances == other.admittances;
+        }
+    };
+    //***********************************************************************
+private:
+    //***********************************************************************
+    struct Entry {
+        Key key;
+        matrix<rvt> YRED, NZB, NZBXAT;
+        size_t bytes = 0;
+    };
+    std::list<Entry> entries; // the most recently used first
+    std::unordered_multimap<size_t, std::list<Entry>::iterator> byHash;
+    size_t bytes = 0;
+    std::mutex mutex; // the subcircuits can be built parallel
+    //***********************************************************************
+    void erase(std::list<Entry>::iterator it);
+    //***********************************************************************
+public:
+    //***********************************************************************
+    inline static size_t memoryCap = 64 * 1048576; // hexmg -redcache <MB>, 0: off
+    //***********************************************************************
+    bool load(const Key& key, matrix<rvt>& YRED, matrix<rvt>& NZB, matrix<rvt>& NZBXAT); // false if not cached
+    void store(const Key& key, const matrix<rvt>& YRED, const matrix<rvt>& NZB, const matrix<rvt>& NZBXAT);
+    void eraseModel(uns modelIndex); // the model is redefined
+    void clear();
+    size_t getBytes() const noexcept { return bytes; }
+    //***********************************************************************
+};
+
+
+}
+
+#endif
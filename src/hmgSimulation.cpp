@@ -89,7 +89,9 @@ void Simulation::runDC() {
     bench_now("first iterations");
 */
     rvt max_error = 1000.0;
-    for (uns i = 0; /*max_error > 1.0e-006 &&*/ i < 5; i++) {
+    cuns nIter = SimControl::isMixedPrecisionDC ? 5 + SimControl::mixedPrecisionMaxRefinement : 5; // mixed precision: refinement steps
+    for (uns i = 0; /*max_error > 1.0e-006 &&*/ i < nIter; i++) {
+        crvt prevError = max_error;
         CircuitStorage::ForwsubsBacksubsDC(fullCircuitID);
       //printf("ForwsubsBacksubs\n");
       //gc.fullCircuitInstances[0].component->printNodeValue();
@@ -113,6 +115,8 @@ void Simulation::runDC() {
         gc.fullCircuitInstances[fullCircuitID].component->printNodeValueDC(0);
 #endif
         bench_now("iteration");
+        if (i >= 4 && !(max_error < 0.5 * prevError)) // the refinement has stopped converging
+            break;
     }
 /*
     CircuitStorage::ForwsubsBacksubsDC(fullCircuitID);
@@ -133,7 +137,12 @@ void Simulation::runDC() {
 //***********************************************************************
 void Simulation::runTimeStep() {
 //***********************************************************************
-    if (SimControl::nNonlinComponents == 10) {
+    // Linear network: one solution per time step. The admittances do not change while dt does not change,
+    // so the SUNRED nodes keep their reduced matrices (isChangedDC == false), and after the first step
+    // forwsubs / backsubs run only the current vector path (JAUA, JBUB, NZBJB, JRED, UA).
+    // A controller is not a nonlinear component, but its output is a feedback that is only updated by the iteration,
+    // and a mixed precision solution needs the defect-checked refinement, otherwise the float error accumulates.
+    if (SimControl::nNonlinComponents == 0 && SimControl::nControllers == 0 && !SimControl::isMixedPrecisionDC) {
         CircuitStorage& gc = CircuitStorage::getInstance();
         CircuitStorage::CalculateControllersDC(fullCircuitID);
         CircuitStorage::CalculateValuesAndCurrentsDC(fullCircuitID);
@@ -202,6 +211,7 @@ void Simulation::run(const RunData& runData) {
     err = runData.err;
     fullCircuitID = runData.fullCircuitID;
     dtValue = rvt0;
+    SimControl::isMixedPrecisionDC = runData.isFloat;
 
     // ******************************************************************
     // MULTIGRID
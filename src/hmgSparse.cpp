@@ -0,0 +1,130 @@
+//***********************************************************************
+// HexMG Sparse Direct Solver CPP
+// Creation date:  2026. 10. 18.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgSparse.h"
+#include <algorithm>
+#include <set>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+void SparseSymbolic::build(std::vector<std::vector<uns>>& adjacency, bool isSymm_) {
+// minimum degree: the node with the fewest uneliminated neighbours is eliminated, its
+// neighbours become a clique (exact elimination graph, ties are broken by the node index)
+//***********************************************************************
+    n = (uns)adjacency.size();
+    isSymm = isSymm_;
+    perm.assign(n, unsMax);
+    iperm.resize(n);
+
+    // symmetrical pattern without self loops
+
+    std::vector<std::vector<uns>> adj(n);
+    for (uns i = 0; i < n; i++)
+        for (uns j : adjacency[i])
+            if (j != i && j < n) {
+                adj[i].push_back(j);
+                adj[j].push_back(i);
+            }
+    adjacency.clear();
+    for (auto& list : adj) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    // elimination
+
+    std::set<std::pair<uns, uns>> byDegree; // (degree, node)
+    for (uns i = 0; i < n; i++)
+        byDegree.emplace((uns)adj[i].size(), i);
+    std::vector<std::vector<uns>> structOriginal(n);
+    std::vector<uns> merged;
+    for (uns k = 0; k < n; k++) {
+        cuns p = byDegree.begin()->second;
+        byDegree.erase(byDegree.begin());
+        perm[p] = k;
+        iperm[k] = p;
+        std::vector<uns>& nb = adj[p];
+        for (uns u : nb) {
+            std::vector<uns>& list = adj[u];
+            byDegree.erase({ (uns)list.size(), u });
+            merged.clear();
+            auto itU = list.begin(), itNb = nb.begin();
+            while (itU != list.end() || itNb != nb.end()) { // list - p + nb - u
+                uns next;
+                if (itNb == nb.end() || (itU != list.end() && *itU < *itNb)) next = *itU++;
+                else if (itU == list.end() || *itNb < *itU) next = *itNb++;
+                else { next = *itU++; itNb++; }
+                if (next != p && next != u)
+                    merged.push_back(next);
+            }
+            list.swap(merged);
+            byDegree.emplace((uns)list.size(), u);
+        }
+        structOriginal[p].swap(nb);
+    }
+
+    // struct(k) in pivot indices
+
+    structStart.resize(n + 1);
+    structStart[0] = 0;
+    for (uns k = 0; k < n; k++)
+        structStart[k + 1] = structStart[k] + (uns)structOriginal[iperm[k]].size();
+    structIndex.resize(structStart[n]);
+    for (uns k = 0; k < n; k++) {
+        uns* dest = structIndex.data() + structStart[k];
+        for (uns i : structOriginal[iperm[k]])
+            *dest++ = perm[i];
+        std::sort(structIndex.data() + structStart[k], dest);
+    }
+
+    // row structure: for j the pivots k < j with j in struct(k), ascending k
+
+    rowStart.assign(n + 1, 0);
+    for (uns i : structIndex)
+        rowStart[i + 1]++;
+    for (uns j = 0; j < n; j++)
+        rowStart[j + 1] += rowStart[j];
+    rowPivot.resize(structIndex.size());
+    rowPos.resize(structIndex.size());
+    std::vector<uns> fill(rowStart.begin(), rowStart.end() - 1);
+    for (uns k = 0; k < n; k++)
+        for (uns idx = structStart[k]; idx < structStart[k + 1]; idx++) {
+            cuns dest = fill[structIndex[idx]]++;
+            rowPivot[dest] = k;
+            rowPos[dest] = idx;
+        }
+}
+
+
+//***********************************************************************
+uns SparseSymbolic::getSlot(uns row, uns col) const noexcept {
+//***********************************************************************
+    if (row >= n || col >= n)
+        return unsMax;
+    cuns p = perm[row], q = perm[col];
+    if (p == q)
+        return p;
+    cuns k = p < q ? p : q;
+    cuns i = p < q ? q : p;
+    const uns* begin = structIndex.data() + structStart[k];
+    const uns* end = structIndex.data() + structStart[k + 1];
+    const uns* it = std::lower_bound(begin, end, i);
+    if (it == end || *it != i)
+        return unsMax;
+    cuns idx = (uns)(it - structIndex.data());
+    return (p < q || isSymm) ? n + idx : n + getNNZ() + idx; // U row: p < q, L column: p > q
+}
+
+
+}
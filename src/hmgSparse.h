@@ -0,0 +1,167 @@
+//***********************************************************************
+// HexMG Sparse Direct Solver Header
+// Creation date:  2026. 10. 18.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_SPARSE_HEADER
+#define	HMG_SPARSE_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgCommon.h"
+#include <vector>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+class SparseSymbolic {
+// The structure of a sparse LU (nonsymmetrical) or LDLT (symmetrical) factor without pivoting.
+// The pattern of the matrix is made symmetrical, the pivot order is minimum degree on the
+// elimination graph; the neighbours of a pivot at its elimination are the nonzeros of its
+// L column and U row (struct(k)), so the symbolic factorization is a byproduct of the ordering.
+// The values are stored in slots: [0, n) diagonal, then the U rows, then the L columns
+// (nonsymmetrical only), in the order of structIndex. The original matrix is loaded into
+// the same slots (getSlot), the factorization is in place, the diagonal slots get 1/D
+// (with the 1e-20 guard of the dense factorizations).
+//***********************************************************************
+    uns n = 0;
+    bool isSymm = false;
+    std::vector<uns> perm;          // perm[original index] = pivot index
+    std::vector<uns> iperm;         // iperm[pivot index] = original index
+    std::vector<uns> structStart;   // struct(k) = structIndex[structStart[k] ... structStart[k + 1] - 1], ascending pivot indices > k
+    std::vector<uns> structIndex;
+    std::vector<uns> rowStart;      // the pivots k < j with j in struct(k): rowPivot[rowStart[j] ... rowStart[j + 1] - 1]
+    std::vector<uns> rowPivot;
+    std::vector<uns> rowPos;        // the index of j in structIndex for rowPivot
+    //***********************************************************************
+    template<typename T> friend class SparseFactor;
+    //***********************************************************************
+public:
+    //***********************************************************************
+    // adjacency[i]: the nodes coupled with node i (any order, duplicates and i itself allowed), it is destroyed
+    void build(std::vector<std::vector<uns>>& adjacency, bool isSymm);
+    void clear() { n = 0; perm.clear(); iperm.clear(); structStart.clear(); structIndex.clear(); rowStart.clear(); rowPivot.clear(); rowPos.clear(); }
+    //***********************************************************************
+    uns getN() const noexcept { return n; }
+    uns getNNZ() const noexcept { return (uns)structIndex.size(); } // in the U (or L) part
+    uns getNSlots() const noexcept { return n + (isSymm ? 1 : 2) * getNNZ(); }
+    uns getSlot(uns row, uns col) const noexcept; // unsMax if (row, col) is not in the pattern; symmetrical: (row, col) and (col, row) are the same slot
+    //***********************************************************************
+};
+
+
+//***********************************************************************
+template<typename T>
+class SparseFactor {
+// left-looking factorization: the U row and L column of pivot j are computed in dense work
+// vectors from the pivots of the row structure of j; every update hits struct(j) only
+//***********************************************************************
+    std::vector<T> values; // slots, see SparseSymbolic
+    std::vector<T> workU, workL;
+    //***********************************************************************
+public:
+    //***********************************************************************
+    void factor(const SparseSymbolic& sym, const std::vector<T>& src) {
+    // src: the original matrix in the slots
+    //***********************************************************************
+        cuns n = sym.n;
+        cuns nnz = sym.getNNZ();
+        values = src;
+        workU.resize(n);
+        if (!sym.isSymm)
+            workL.resize(n);
+        T* const D = values.data();
+        T* const U = D + n;
+        T* const L = U + nnz;
+        for (uns j = 0; j < n; j++) {
+            cuns sBegin = sym.structStart[j], sEnd = sym.structStart[j + 1];
+            for (uns idx = sBegin; idx < sEnd; idx++)
+                workU[sym.structIndex[idx]] = U[idx];
+            if (!sym.isSymm)
+                for (uns idx = sBegin; idx < sEnd; idx++)
+                    workL[sym.structIndex[idx]] = L[idx];
+            T d = D[j];
+            for (uns r = sym.rowStart[j]; r < sym.rowStart[j + 1]; r++) {
+                cuns k = sym.rowPivot[r];
+                cuns pos = sym.rowPos[r];
+                cuns kEnd = sym.structStart[k + 1];
+                const T ukj = U[pos];
+                if (sym.isSymm) {
+                    const T lkj = ukj * D[k];
+                    d -= lkj * ukj;
+                    for (uns idx = pos + 1; idx < kEnd; idx++)
+                        workU[sym.structIndex[idx]] -= lkj * U[idx];
+                }
+                else {
+                    const T ljk = L[pos];
+                    d -= ljk * ukj;
+                    for (uns idx = pos + 1; idx < kEnd; idx++) {
+                        cuns i = sym.structIndex[idx];
+                        workU[i] -= ljk * U[idx];
+                        workL[i] -= L[idx] * ukj;
+                    }
+                }
+            }
+            const T rd = std::abs(d) < 1e-20 ? T(1e20) : T(1) / d;
+            D[j] = rd;
+            for (uns idx = sBegin; idx < sEnd; idx++)
+                U[idx] = workU[sym.structIndex[idx]];
+            if (!sym.isSymm) {
+                for (uns idx = sBegin; idx < sEnd; idx++)
+                    L[idx] = workL[sym.structIndex[idx]] * rd;
+            }
+        }
+    }
+    //***********************************************************************
+    void nsolve(const SparseSymbolic& sym, T* dest, const T* src, T* work) const noexcept {
+    // dest = -A^-1 * src, work: n elements; dest and src are in the original order, dest == src allowed
+    //***********************************************************************
+        cuns n = sym.n;
+        cuns nnz = sym.getNNZ();
+        const T* const D = values.data();
+        const T* const U = D + n;
+        const T* const L = U + nnz;
+        for (uns k = 0; k < n; k++)
+            work[k] = src[sym.iperm[k]];
+        for (uns k = 0; k < n; k++) { // L * y = b, L is unit lower triangular
+            if (work[k] == T(0))
+                continue;
+            cuns sEnd = sym.structStart[k + 1];
+            if (sym.isSymm) {
+                const T yk = work[k] * D[k];
+                for (uns idx = sym.structStart[k]; idx < sEnd; idx++)
+                    work[sym.structIndex[idx]] -= U[idx] * yk;
+            }
+            else {
+                const T yk = work[k];
+                for (uns idx = sym.structStart[k]; idx < sEnd; idx++)
+                    work[sym.structIndex[idx]] -= L[idx] * yk;
+            }
+        }
+        for (uns k = n; k-- > 0;) { // D * U * x = y, U is unit upper triangular after dividing by D
+            T s = work[k];
+            for (uns idx = sym.structStart[k]; idx < sym.structStart[k + 1]; idx++)
+                s -= U[idx] * work[sym.structIndex[idx]];
+            work[k] = s * D[k];
+        }
+        for (uns k = 0; k < n; k++)
+            dest[sym.iperm[k]] = -work[k];
+    }
+    //***********************************************************************
+    void clear() { values.clear(); workU.clear(); workL.clear(); }
+    //***********************************************************************
+};
+
+
+}
+
+#endif
@@ -7,7 +7,14 @@
 
 //***********************************************************************
 #include "hmgSunred.h"
+#include "hmgSunredTree.h"
 #include "hmgComponent.h"
+#include "hmgMatrixFixed.hpp"
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <limits>
+#include <mutex>
 //***********************************************************************
 
 
@@ -143,6 +150,223 @@ void SunredTreeNode::loadNodeDataFromTwoNodes(SunredTreeNode* src1, SunredTreeNo
             }
         }
     }
+
+    // scatter maps
+
+    constexpr size_t narrowLimit = (size_t)std::numeric_limits<ush>::max() + 1;
+    isWideMap = src1->ANodeIndex.size() > narrowLimit || src2->ANodeIndex.size() > narrowLimit
+        || ANodeIndex.size() > narrowLimit || BNodeIndex.size() > narrowLimit;
+    narrowMap1 = narrowMap2 = SunredScatterMap<ush>{};
+    wideMap1 = wideMap2 = SunredScatterMap<uns>{};
+    if (isWideMap) {
+        buildScatterMap(wideMap1, src1);
+        buildScatterMap(wideMap2, src2);
+    }
+    else {
+        buildScatterMap(narrowMap1, src1);
+        buildScatterMap(narrowMap2, src2);
+    }
+}
+
+
+//***********************************************************************
+template<typename T>
+void SunredTreeNode::buildScatterMap(SunredScatterMap<T>& dest, const SunredTreeNode* src) const {
+// the node indices are sorted in src->ANodeIndex, ANodeIndex and BNodeIndex
+//***********************************************************************
+    cuns Asiz = (uns)ANodeIndex.size();
+    cuns Bsiz = (uns)BNodeIndex.size();
+    cuns sAsiz = (uns)src->ANodeIndex.size();
+    uns dA = 0, dB = 0;
+    for (uns x = 0; x < sAsiz; x++) {
+        cuns nodeIndex = src->ANodeIndex[x].nodeIndex;
+        while (dA < Asiz && ANodeIndex[dA].nodeIndex < nodeIndex)
+            dA++;
+        while (dB < Bsiz && BNodeIndex[dB] < nodeIndex)
+            dB++;
+        if (dA < Asiz && ANodeIndex[dA].nodeIndex == nodeIndex) {
+            dest.srcA.push_back((T)x);
+            dest.dstA.push_back((T)dA);
+        }
+        else if (dB < Bsiz && BNodeIndex[dB] == nodeIndex) {
+            dest.srcB.push_back((T)x);
+            dest.dstB.push_back((T)dB);
+        }
+        else
+            throw hmgExcept("SunredTreeNode::loadNodeDataFromTwoNodes", "nodeIndex not found");
+    }
+}
+
+
+//***********************************************************************
+template<typename T, typename D>
+static void scatterAdmittances(const SunredScatterMap<T>& map, const matrix<D>& src, bool isSymm, matrix<D>& YA, matrix<D>& XAT, matrix<D>& XB, matrix<D>& YB) {
+// adds the YRED of a source cell to the blocks of the merged cell
+// isSymm: the merged cell is symmetrical, only the upper triangles are added, XB = XAT, XAT is not used
+//***********************************************************************
+    const T* srcA = map.srcA.data();
+    const T* dstA = map.dstA.data();
+    const T* srcB = map.srcB.data();
+    const T* dstB = map.dstB.data();
+    cuns nA = (uns)map.srcA.size();
+    cuns nB = (uns)map.srcB.size();
+    if (isSymm) { // src is symmetrical: src[y][x] with x >= y
+        uns kB = 0;
+        for (uns i = 0; i < nA; i++) { // A rows
+            cuns y = srcA[i];
+            while (kB < nB && srcB[kB] < y)
+                kB++;
+            const vektor<D> s = src[y];
+            vektor<D> ya = YA[dstA[i]];
+            vektor<D> xb = XB[dstA[i]];
+            for (uns k = i; k < nA; k++)
+                ya[dstA[k]] += s[srcA[k]];
+            for (uns k = kB; k < nB; k++)
+                xb[dstB[k]] += s[srcB[k]];
+        }
+        uns kA = 0;
+        for (uns i = 0; i < nB; i++) { // B rows
+            cuns y = srcB[i];
+            while (kA < nA && srcA[kA] < y)
+                kA++;
+            const vektor<D> s = src[y];
+            vektor<D> yb = YB[dstB[i]];
+            cuns dBy = dstB[i];
+            for (uns k = kA; k < nA; k++)
+                XB[dstA[k]][dBy] += s[srcA[k]];
+            for (uns k = i; k < nB; k++)
+                yb[dstB[k]] += s[srcB[k]];
+        }
+    }
+    else if (src.get_is_symm()) { // a symmetrical source in a nonsymmetrical cell: every element, get_elem
+        for (uns i = 0; i < nA; i++) { // A rows
+            cuns y = srcA[i];
+            vektor<D> ya = YA[dstA[i]];
+            vektor<D> xb = XB[dstA[i]];
+            for (uns k = 0; k < nA; k++)
+                ya[dstA[k]] += src.get_elem(y, srcA[k]);
+            for (uns k = 0; k < nB; k++)
+                xb[dstB[k]] += src.get_elem(y, srcB[k]);
+        }
+        for (uns i = 0; i < nB; i++) { // B rows
+            cuns y = srcB[i];
+            vektor<D> yb = YB[dstB[i]];
+            cuns dBy = dstB[i];
+            for (uns k = 0; k < nA; k++)
+                XAT[dstA[k]][dBy] += src.get_elem(y, srcA[k]);
+            for (uns k = 0; k < nB; k++)
+                yb[dstB[k]] += src.get_elem(y, srcB[k]);
+        }
+    }
+    else {
+        for (uns i = 0; i < nA; i++) { // A rows
+            const vektor<D> s = src[srcA[i]];
+            vektor<D> ya = YA[dstA[i]];
+            vektor<D> xb = XB[dstA[i]];
+            for (uns k = 0; k < nA; k++)
+                ya[dstA[k]] += s[srcA[k]];
+            for (uns k = 0; k < nB; k++)
+                xb[dstB[k]] += s[srcB[k]];
+        }
+        for (uns i = 0; i < nB; i++) { // B rows
+            const vektor<D> s = src[srcB[i]];
+            vektor<D> yb = YB[dstB[i]];
+            cuns dBy = dstB[i];
+            for (uns k = 0; k < nA; k++)
+                XAT[dstA[k]][dBy] += s[srcA[k]];
+            for (uns k = 0; k < nB; k++)
+                yb[dstB[k]] += s[srcB[k]];
+        }
+    }
+}
+
+
+//***********************************************************************
+template<typename T, typename D>
+static void scatterCurrents(const SunredScatterMap<T>& map, const vektor<D>& src, vektor<D>& JA, vektor<D>& JB) {
+// adds the JRED of a source cell to JA and JB of the merged cell
+//***********************************************************************
+    cuns nA = (uns)map.srcA.size();
+    cuns nB = (uns)map.srcB.size();
+    for (uns k = 0; k < nA; k++)
+        JA[map.dstA[k]] += src[map.srcA[k]];
+    for (uns k = 0; k < nB; k++)
+        JB[map.dstB[k]] += src[map.srcB[k]];
+}
+
+
+//***********************************************************************
+double SunredTreeNode::getPredictedFlopsDC() const noexcept {
+// the matrix operations of forwsubsDC in a nonleaf node, a multiply-add is 2 flops
+//***********************************************************************
+    if (srcCell1 == nullptr)
+        return 0;
+    const double A = (double)ANodeIndex.size();
+    const double B = (double)BNodeIndex.size();
+    return isSymmDC
+        ? B * B * B / 3 + A * B * B + A * A * B             // LDLT, L^-1 * XA, symmetrical YRED update
+        : 2 * B * B * B + 2 * A * B * B + 2 * A * A * B;    // inverse, NZB * XA, YRED update
+}
+
+
+//***********************************************************************
+size_t SunredTreeNode::getPredictedBytesDC() const noexcept {
+// the matrices and vectors of allocDC
+//***********************************************************************
+    if (!isEnabled())
+        return 0;
+    const size_t A = ANodeIndex.size();
+    const size_t B = BNodeIndex.size();
+    const size_t C = CNodeIndex.size();
+    auto square = [](size_t n, bool isSymm) { return isSymm ? n * (n + 1) / 2 : n * n; };
+    size_t n = square(A, isSymmDC) + A; // YRED, JRED
+    if (srcComponent != nullptr) { // leaf
+        if (A != C)
+            n += square(C, isSymmDC) + C;
+    }
+    else { // nonleaf
+        if (!isSymmDC)
+            n += A * B; // XAT
+        n += 2 * A * B + A + 2 * B; // XB, NZBXAT, JAUA, JBUB, NZBJB
+        n += isSymmDC && B > 2 ? square(B, true) : B * B + B * A; // YB_NZB (, NZBXA)
+    }
+    return n * sizeof(rvt);
+}
+
+
+//***********************************************************************
+size_t SunredTreeNode::getSpillBytesDC() const noexcept {
+//***********************************************************************
+    if (srcCell1 == nullptr)
+        return 0;
+    const size_t A = ANodeIndex.size();
+    const size_t B = BNodeIndex.size();
+    auto block = [](size_t n) { return (n * sizeof(rvt) + AlignedArena::alignment - 1) & ~(AlignedArena::alignment - 1); };
+    size_t n = (isSymmDC ? 2 : 3) * block(A * B); // (XAT,) XB, NZBXAT
+    n += isSymmDC && B > 2 ? block(B * (B + 1) / 2) : block(B * B) + block(B * A); // YB_NZB (, NZBXA)
+    return n;
+}
+
+
+//***********************************************************************
+void SunredTreeNode::evictDC() const noexcept {
+//***********************************************************************
+    if (dc == nullptr || !dc->isSpilled)
+        return;
+    const auto& calc = *dc->calc;
+    for (const matrix<rvt>* m : { &calc.XAT, &calc.XB, &calc.YB_NZB, &calc.NZBXA, &calc.NZBXAT })
+        AlignedArena::evict(m->kernel_data(), m->size() * sizeof(rvt));
+}
+
+
+//***********************************************************************
+void SunredTreeNode::prefetchDC() const noexcept {
+//***********************************************************************
+    if (dc == nullptr || !dc->isSpilled)
+        return;
+    const auto& calc = *dc->calc;
+    for (const matrix<rvt>* m : { &calc.XAT, &calc.XB, &calc.YB_NZB, &calc.NZBXA, &calc.NZBXAT })
+        AlignedArena::prefetch(m->kernel_data(), m->size() * sizeof(rvt));
 }
 
 
@@ -155,12 +379,18 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
     //***********************************************************************
     if (srcComponent != nullptr) { // leaf
     //***********************************************************************
+        // if the component reports that its admittances are the same as at the last load, they are not compared,
+        // the leaf is unchanged, and so are the nodes above it whose other source is unchanged: only their JRED is calculated
+
+        cuns YVersion = srcComponent->getYDCVersion();
+        const bool isSameY = dc->isLeafLoaded && YVersion != 0 && YVersion == dc->leafYVersion;
         bool isChanged = false;
         if (Asiz == Csiz) { // only single nodes
-            for (uns y = 0; y < Csiz; y++)
-                for (uns x = isSymmDC ? y : 0; x < Csiz; x++) {
-                    isChanged = dc->YRED.refresh_unsafe(y, x, srcComponent->getYDC(CNodeIndex[y].componentTerminalIndex, CNodeIndex[x].componentTerminalIndex)) || isChanged;
-                }
+            if (!isSameY)
+                for (uns y = 0; y < Csiz; y++)
+                    for (uns x = isSymmDC ? y : 0; x < Csiz; x++) {
+                        isChanged = dc->YRED.refresh_unsafe(y, x, srcComponent->getYDC(CNodeIndex[y].componentTerminalIndex, CNodeIndex[x].componentTerminalIndex)) || isChanged;
+                    }
             for (uns x = 0; x < Csiz; x++) {
                 dc->JRED[x] = srcComponent->getJreducedDC(CNodeIndex[x].componentTerminalIndex);
             }
@@ -169,340 +399,63 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
             
             // copy
             
-            for (uns y = 0; y < Csiz; y++)
-                for (uns x = isSymmDC ? y : 0; x < Csiz; x++) {
-                    isChanged = dc->leaf->YA.refresh_unsafe(y, x, srcComponent->getYDC(CNodeIndex[y].componentTerminalIndex, CNodeIndex[x].componentTerminalIndex)) || isChanged;
-                }
+            if (!isSameY)
+                for (uns y = 0; y < Csiz; y++)
+                    for (uns x = isSymmDC ? y : 0; x < Csiz; x++) {
+                        isChanged = dc->leaf->YA.refresh_unsafe(y, x, srcComponent->getYDC(CNodeIndex[y].componentTerminalIndex, CNodeIndex[x].componentTerminalIndex)) || isChanged;
+                    }
             for (uns x = 0; x < Csiz; x++) {
                 dc->leaf->JA[x] = srcComponent->getJreducedDC(CNodeIndex[x].componentTerminalIndex);
             }
             
             // merge
             
-            dc->YRED.zero_unsafe();
+            if (isChanged || !dc->isLeafLoaded) {
+                dc->YRED.zero_unsafe();
+                for (uns y = 0; y < Bsiz; y++)
+                    for (uns x = isSymmDC ? y : 0; x < Bsiz; x++) {
+                        dc->YRED.get_elem(BNodeIndex[y], BNodeIndex[x]) += dc->leaf->YA[y][x];
+                    }
+            }
             dc->JRED.zero();
-            for (uns y = 0; y < Bsiz; y++)
-                for (uns x = isSymmDC ? y : 0; x < Bsiz; x++) {
-                    dc->YRED.get_elem(BNodeIndex[y], BNodeIndex[x]) += dc->leaf->YA[y][x];
-                }
             for (uns x = 0; x < Bsiz; x++) {
                 dc->JRED[BNodeIndex[x]] += dc->leaf->JA[x];
             }
         }
-        isChangedDC = isChanged;
+        isChangedDC = isChanged || !dc->isLeafLoaded; // the nodes above are reduced at least once
+        dc->isLeafLoaded = true;
+        dc->leafYVersion = YVersion;
     }
     //***********************************************************************
     else if (srcCell1 != nullptr) { // nonleaf
     //***********************************************************************
 
-        cuns s1Asiz = (uns)srcCell1->ANodeIndex.size();
-        const auto& ANodeIndex1 = srcCell1->ANodeIndex;
-        cuns s2Asiz = (uns)srcCell2->ANodeIndex.size();
-        const auto& ANodeIndex2 = srcCell2->ANodeIndex;
+        prefetchDC(); // a spilled node reads its matrices back while the vectors are sorted
 
         //***********************************************************************
         // sorting of admittances
         //***********************************************************************
 
-        if (srcCell1->isChangedDC || srcCell2->isChangedDC) {
+        if (srcCell1->isChangedDC || srcCell2->isChangedDC || dc->isFloatReduced != SimControl::isFloatReductionDC(Bsiz)) {
 
             isChangedDC = true;
+            dc->isFloatReduced = SimControl::isFloatReductionDC(Bsiz);
             dc->YRED.zero_unsafe();
             dc->calc->XB.zero_unsafe();
             dc->calc->YB_NZB.zero_unsafe();
 
-            if (isSymmDC) { // src1->YRED and src2->YRED => YRED (as YA) and XB and YB_NZB (XAT is not used)
-                
-                // src1 => this
-
-                uns dAy = 0, dBy = 0;
-                for (uns y = 0; y < s1Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex1[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex1[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex1[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                dc->YRED[dAy][dAx] += srcCell1->dc->YRED[y][x];
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                dc->calc->XB[dAy][dBx] += srcCell1->dc->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 1");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex1[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                dc->calc->XB[dAx][dBy] += srcCell1->dc->YRED[y][x]; // XB = XAT
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                dc->calc->YB_NZB[dBy][dBx] += srcCell1->dc->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 2");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 3");
-                }
-
-                // src2 => this
-
-                dAy = 0;
-                dBy = 0;
-                for (uns y = 0; y < s2Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex2[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex2[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex2[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                dc->YRED[dAy][dAx] += srcCell2->dc->YRED[y][x];
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                dc->calc->XB[dAy][dBx] += srcCell2->dc->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 4");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex2[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                dc->calc->XB[dAx][dBy] += srcCell2->dc->YRED[y][x]; // XB = XAT
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                dc->calc->YB_NZB[dBy][dBx] += srcCell2->dc->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 5");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 6");
-                }
-
-                if (Bsiz != 1)
-                    dc->calc->YB_NZB.symmetrize_from_upper();
-            }
-            else { // result is nonsymm (one of the inputs can be); src1->YRED and src2->YRED => YRED (as YA) and XAT and XB and YB_NZB
-
+            if (!isSymmDC)
                 dc->calc->XAT.zero_unsafe();
-
-                // src1 => this
-
-                uns dAy = 0, dBy = 0;
-                for (uns y = 0; y < s1Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex1[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex1[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex1[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                dc->YRED[dAy][dAx] += srcCell1->dc->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                dc->calc->XB[dAy][dBx] += srcCell1->dc->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 7");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex1[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                dc->calc->XAT[dAx][dBy] += srcCell1->dc->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                dc->calc->YB_NZB[dBy][dBx] += srcCell1->dc->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 8");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 9");
-                }
-
-                // src2 => this
-
-                dAy = 0;
-                dBy = 0;
-                for (uns y = 0; y < s2Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex2[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex2[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex2[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                dc->YRED[dAy][dAx] += srcCell2->dc->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                dc->calc->XB[dAy][dBx] += srcCell2->dc->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 10");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex2[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                dc->calc->XAT[dAx][dBy] += srcCell2->dc->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                dc->calc->YB_NZB[dBy][dBx] += srcCell2->dc->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 11");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 12");
-                }
-            }
-
+            auto scatter = [&](const auto& map1, const auto& map2) {
+                scatterAdmittances(map1, srcCell1->dc->YRED, isSymmDC, dc->YRED, dc->calc->XAT, dc->calc->XB, dc->calc->YB_NZB);
+                scatterAdmittances(map2, srcCell2->dc->YRED, isSymmDC, dc->YRED, dc->calc->XAT, dc->calc->XB, dc->calc->YB_NZB);
+            };
+            if (isWideMap)
+                scatter(wideMap1, wideMap2);
+            else
+                scatter(narrowMap1, narrowMap2);
+            if (isSymmDC && Bsiz == 2)
+                dc->calc->YB_NZB.symmetrize_from_upper();
         }
         else {
             isChangedDC = false;
@@ -523,54 +476,14 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
         // sorting of defect 2: input cells
         //***********************************************************************
 
-        uns dAx = 0, dBx = 0;
-        for (uns x = 0; x < s1Asiz; x++) {
-
-            // jump
-
-            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                dAx++;
-            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                dBx++;
-
-            // merge
-
-            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => JA
-                dc->calc->JAUA[dAx] += srcCell1->dc->JRED[x];
-                dAx++;
-            }
-            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => JB
-                dc->calc->JBUB[dBx] += srcCell1->dc->JRED[x];
-                dBx++;
-            }
-            else
-                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 10");
-        }
-
-        dAx = 0;
-        dBx = 0;
-        for (uns x = 0; x < s2Asiz; x++) {
-
-            // jump
-
-            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                dAx++;
-            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                dBx++;
-
-            // merge
-
-            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => JA
-                dc->calc->JAUA[dAx] += srcCell2->dc->JRED[x];
-                dAx++;
-            }
-            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => JB
-                dc->calc->JBUB[dBx] += srcCell2->dc->JRED[x];
-                dBx++;
-            }
-            else
-                throw hmgExcept("SunredTreeNode::forwsubsDC", "nodeIndex not found / 10");
-        }
+        auto scatterJ = [&](const auto& map1, const auto& map2) {
+            scatterCurrents(map1, srcCell1->dc->JRED, dc->calc->JAUA, dc->calc->JBUB);
+            scatterCurrents(map2, srcCell2->dc->JRED, dc->calc->JAUA, dc->calc->JBUB);
+        };
+        if (isWideMap)
+            scatterJ(wideMap1, wideMap2);
+        else
+            scatterJ(narrowMap1, narrowMap2);
 
         //***********************************************************************
         // reduction
@@ -578,7 +491,10 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
 
         if (isSymmDC) {
             if (isChangedDC) {
-                if (Bsiz == 1) {
+                if (Bsiz == 0) {
+                    // no node is reduced in this cell: YRED = YA
+                }
+                else if (Bsiz == 1) {
                     dc->calc->NZBXA.math_1_ninv_mulT(dc->calc->YB_NZB, dc->calc->XB); // XA should be here but internal data structure of XB is the same
                     dc->YRED.math_1_add_mul_symm(dc->YRED, dc->calc->XB, dc->calc->NZBXA);
                 }
@@ -586,17 +502,25 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
                     dc->calc->NZBXA.math_2_ninv_mul_symmT(dc->calc->YB_NZB, dc->calc->XB);
                     dc->YRED.math_2_add_mul_symm(dc->YRED, dc->calc->XB, dc->calc->NZBXA);
                 }
-                else {
-                    dc->calc->YB_NZB.math_symm_ninv_of_nonsymm();
-                    dc->calc->NZBXA.math_mul_t_unsafe(dc->calc->YB_NZB, dc->calc->XB);
-                    dc->calc->NZBXAT.transp(dc->calc->NZBXA);
-                    dc->YRED.math_add_mul_t_symm(dc->YRED, dc->calc->XB, dc->calc->NZBXAT);
+                else if (Bsiz <= matrixFixedMaxSize) {
+                    math_fixed_reduce_symm(Bsiz, dc->calc->YB_NZB, dc->calc->NZBXAT, dc->YRED, dc->calc->XB);
+                }
+                else if (SimControl::isFloatReductionDC(Bsiz)) {
+                    MixedPrecisionReduction::reduceSymm(dc->calc->YB_NZB, dc->calc->NZBXAT, dc->YRED, dc->YRED, dc->calc->XB);
+                }
+                else { // YRED -= XB * YB^-1 * XBT with YB = L * D * LT
+                    dc->calc->YB_NZB.math_symm_ldlt();
+                    dc->calc->NZBXAT.math_ldlt_solve_rows(dc->calc->YB_NZB, dc->calc->XB);
+                    dc->YRED.math_sub_mul_ldlt_symm(dc->YRED, dc->calc->NZBXAT, dc->calc->YB_NZB);
                 }
             }
         }
         else {
             if (isChangedDC) {
-                if (Bsiz == 1) {
+                if (Bsiz == 0) {
+                    // no node is reduced in this cell: YRED = YA
+                }
+                else if (Bsiz == 1) {
                     dc->calc->NZBXA.math_1_ninv_mulT(dc->calc->YB_NZB, dc->calc->XAT);
                     dc->YRED.math_1_add_mul(dc->YRED, dc->calc->XB, dc->calc->NZBXA);
                 }
@@ -604,6 +528,13 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
                     dc->calc->NZBXA.math_2_ninv_mulT(dc->calc->YB_NZB, dc->calc->XAT); // fix: mul => mulT
                     dc->YRED.math_2_add_mul(dc->YRED, dc->calc->XB, dc->calc->NZBXA);
                 }
+                else if (isMatrixFixedNonsymmFaster(Bsiz)) {
+                    math_fixed_reduce_nonsymm(Bsiz, dc->calc->YB_NZB, dc->calc->NZBXA, dc->calc->NZBXAT, dc->YRED, dc->calc->XAT, dc->calc->XB);
+                }
+                else if (SimControl::isFloatReductionDC(Bsiz)) {
+                    MixedPrecisionReduction::reduceNonSymm(dc->calc->YB_NZB, dc->calc->NZBXAT, dc->YRED, dc->YRED, dc->calc->XAT, dc->calc->XB);
+                    dc->calc->NZBXA.transp(dc->calc->NZBXAT);
+                }
                 else {
                     dc->calc->YB_NZB.math_ninv_np();                                                // 11.2% of the runtime
                     dc->calc->NZBXA.math_mul_t_unsafe(dc->calc->YB_NZB, dc->calc->XAT);             // 16.9% of the runtime
@@ -617,7 +548,10 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
         // forwsubs
         //***********************************************************************
 
-        if (Bsiz == 1) {
+        if (Bsiz == 0) {
+            dc->JRED.copy_unsafe(dc->calc->JAUA);
+        }
+        else if (Bsiz == 1) {
             math_1x1_mul(dc->calc->NZBJB, dc->calc->YB_NZB, dc->calc->JBUB);
             math_1_add_mul_jred(dc->JRED, dc->calc->JAUA, dc->calc->XB, dc->calc->NZBJB);
         }
@@ -626,10 +560,15 @@ void SunredTreeNode::forwsubsDC(ComponentSubCircuit* pSrc) { // 94% of the runti
             math_2_add_mul_jred(dc->JRED, dc->calc->JAUA, dc->calc->XB, dc->calc->NZBJB);
         }
         else {
-            math_mul(dc->calc->NZBJB, dc->calc->YB_NZB, dc->calc->JBUB);
+            if (isSymmDC)
+                math_ldlt_nsolve(dc->calc->NZBJB, dc->calc->YB_NZB, dc->calc->JBUB);
+            else
+                math_mul(dc->calc->NZBJB, dc->calc->YB_NZB, dc->calc->JBUB);
             math_add_mul(dc->JRED, dc->calc->JAUA, dc->calc->XB, dc->calc->NZBJB);
         }
 
+        evictDC(); // not needed until the backsubs of this node
+
     } // else: empty node, belongs to a disabled component, nothing to do
 }
 
@@ -683,11 +622,6 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
     else if (srcCell1 != nullptr) { // nonleaf
     //***********************************************************************
 
-        cuns s1Asiz = (uns)srcCell1->ANodeIndex.size();
-        const auto& ANodeIndex1 = srcCell1->ANodeIndex;
-        cuns s2Asiz = (uns)srcCell2->ANodeIndex.size();
-        const auto& ANodeIndex2 = srcCell2->ANodeIndex;
-
         //***********************************************************************
         // sorting of admittances
         //***********************************************************************
@@ -699,298 +633,18 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
             ac->calc->XB.zero_unsafe();
             ac->calc->YB_NZB.zero_unsafe();
 
-            if (isSymmAC) { // src1->YRED and src2->YRED => YRED (as YA) and XB and YB_NZB (XAT is not used)
-                
-                // src1 => this
-
-                uns dAy = 0, dBy = 0;
-                for (uns y = 0; y < s1Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex1[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex1[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex1[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                ac->YRED[dAy][dAx] += srcCell1->ac->YRED[y][x];
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                ac->calc->XB[dAy][dBx] += srcCell1->ac->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 1");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex1[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                ac->calc->XB[dAx][dBy] += srcCell1->ac->YRED[y][x]; // XB = XAT
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                ac->calc->YB_NZB[dBy][dBx] += srcCell1->ac->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 2");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 3");
-                }
-
-                // src2 => this
-
-                dAy = 0;
-                dBy = 0;
-                for (uns y = 0; y < s2Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex2[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex2[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex2[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                ac->YRED[dAy][dAx] += srcCell2->ac->YRED[y][x];
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                ac->calc->XB[dAy][dBx] += srcCell2->ac->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 4");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex2[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = dAy, dBx = dBy;
-                        for (uns x = y; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                ac->calc->XB[dAx][dBy] += srcCell2->ac->YRED[y][x]; // XB = XAT
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                ac->calc->YB_NZB[dBy][dBx] += srcCell2->ac->YRED[y][x];
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 5");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 6");
-                }
-
-                if (Bsiz != 1)
-                    ac->calc->YB_NZB.symmetrize_from_upper();
-            }
-            else { // result is nonsymm (one of the inputs can be); src1->YRED and src2->YRED => YRED (as YA) and XAT and XB and YB_NZB
-
+            if (!isSymmAC)
                 ac->calc->XAT.zero_unsafe();
-
-                // src1 => this
-
-                uns dAy = 0, dBy = 0;
-                for (uns y = 0; y < s1Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex1[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex1[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex1[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                ac->YRED[dAy][dAx] += srcCell1->ac->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                ac->calc->XB[dAy][dBx] += srcCell1->ac->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 7");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex1[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s1Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                ac->calc->XAT[dAx][dBy] += srcCell1->ac->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                ac->calc->YB_NZB[dBy][dBx] += srcCell1->ac->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 8");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 9");
-                }
-
-                // src2 => this
-
-                dAy = 0;
-                dBy = 0;
-                for (uns y = 0; y < s2Asiz; y++) {
-
-                    // jump
-
-                    while (dAy < Asiz && ANodeIndex[dAy].nodeIndex < ANodeIndex2[y].nodeIndex)
-                        dAy++;
-                    while (dBy < Bsiz && BNodeIndex[dBy] < ANodeIndex2[y].nodeIndex)
-                        dBy++;
-
-                    // merge
-
-                    if (dAy < Asiz && ANodeIndex2[y].nodeIndex == ANodeIndex[dAy].nodeIndex) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => YA
-                                ac->YRED[dAy][dAx] += srcCell2->ac->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => XB
-                                ac->calc->XB[dAy][dBx] += srcCell2->ac->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 10");
-                        }
-                        dAy++;
-                    }
-                    else if (ANodeIndex2[y].nodeIndex == BNodeIndex[dBy]) {
-                        uns dAx = 0, dBx = 0;
-                        for (uns x = 0; x < s2Asiz; x++) {
-
-                            // jump
-
-                            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                                dAx++;
-                            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                                dBx++;
-
-                            // merge
-
-                            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => XA
-                                ac->calc->XAT[dAx][dBy] += srcCell2->ac->YRED.get_elem(y, x);
-                                dAx++;
-                            }
-                            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => YB
-                                ac->calc->YB_NZB[dBy][dBx] += srcCell2->ac->YRED.get_elem(y, x);
-                                dBx++;
-                            }
-                            else
-                                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 11");
-                        }
-                        dBy++;
-                    }
-                    else
-                        throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 12");
-                }
-            }
-
+            auto scatter = [&](const auto& map1, const auto& map2) {
+                scatterAdmittances(map1, srcCell1->ac->YRED, isSymmAC, ac->YRED, ac->calc->XAT, ac->calc->XB, ac->calc->YB_NZB);
+                scatterAdmittances(map2, srcCell2->ac->YRED, isSymmAC, ac->YRED, ac->calc->XAT, ac->calc->XB, ac->calc->YB_NZB);
+            };
+            if (isWideMap)
+                scatter(wideMap1, wideMap2);
+            else
+                scatter(narrowMap1, narrowMap2);
+            if (isSymmAC && Bsiz != 1)
+                ac->calc->YB_NZB.symmetrize_from_upper();
         }
         else {
             isChangedAC = false;
@@ -1011,54 +665,14 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
         // sorting of defect 2: input cells
         //***********************************************************************
 
-        uns dAx = 0, dBx = 0;
-        for (uns x = 0; x < s1Asiz; x++) {
-
-            // jump
-
-            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex1[x].nodeIndex)
-                dAx++;
-            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex1[x].nodeIndex)
-                dBx++;
-
-            // merge
-
-            if (dAx < Asiz && ANodeIndex1[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => JA
-                ac->calc->JAUA[dAx] += srcCell1->ac->JRED[x];
-                dAx++;
-            }
-            else if (ANodeIndex1[x].nodeIndex == BNodeIndex[dBx]) { // => JB
-                ac->calc->JBUB[dBx] += srcCell1->ac->JRED[x];
-                dBx++;
-            }
-            else
-                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 10");
-        }
-
-        dAx = 0;
-        dBx = 0;
-        for (uns x = 0; x < s2Asiz; x++) {
-
-            // jump
-
-            while (dAx < Asiz && ANodeIndex[dAx].nodeIndex < ANodeIndex2[x].nodeIndex)
-                dAx++;
-            while (dBx < Bsiz && BNodeIndex[dBx] < ANodeIndex2[x].nodeIndex)
-                dBx++;
-
-            // merge
-
-            if (dAx < Asiz && ANodeIndex2[x].nodeIndex == ANodeIndex[dAx].nodeIndex) { // => JA
-                ac->calc->JAUA[dAx] += srcCell2->ac->JRED[x];
-                dAx++;
-            }
-            else if (ANodeIndex2[x].nodeIndex == BNodeIndex[dBx]) { // => JB
-                ac->calc->JBUB[dBx] += srcCell2->ac->JRED[x];
-                dBx++;
-            }
-            else
-                throw hmgExcept("SunredTreeNode::forwsubsAC", "nodeIndex not found / 10");
-        }
+        auto scatterJ = [&](const auto& map1, const auto& map2) {
+            scatterCurrents(map1, srcCell1->ac->JRED, ac->calc->JAUA, ac->calc->JBUB);
+            scatterCurrents(map2, srcCell2->ac->JRED, ac->calc->JAUA, ac->calc->JBUB);
+        };
+        if (isWideMap)
+            scatterJ(wideMap1, wideMap2);
+        else
+            scatterJ(narrowMap1, narrowMap2);
 
         //***********************************************************************
         // reduction
@@ -1066,7 +680,10 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
 
         if (isSymmAC) {
             if (isChangedAC) {
-                if (Bsiz == 1) {
+                if (Bsiz == 0) {
+                    // no node is reduced in this cell: YRED = YA
+                }
+                else if (Bsiz == 1) {
                     ac->calc->NZBXA.math_1_ninv_mulT(ac->calc->YB_NZB, ac->calc->XB); // XA should be here but internal data structure of XB is the same
                     ac->YRED.math_1_add_mul_symm(ac->YRED, ac->calc->XB, ac->calc->NZBXA);
                 }
@@ -1084,7 +701,10 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
         }
         else {
             if (isChangedAC) {
-                if (Bsiz == 1) {
+                if (Bsiz == 0) {
+                    // no node is reduced in this cell: YRED = YA
+                }
+                else if (Bsiz == 1) {
                     ac->calc->NZBXA.math_1_ninv_mulT(ac->calc->YB_NZB, ac->calc->XB); // XA should be here but internal data structure of XB is the same
                     ac->YRED.math_1_add_mul(ac->YRED, ac->calc->XB, ac->calc->NZBXA);
                 }
@@ -1092,6 +712,9 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
                     ac->calc->NZBXA.math_2_ninv_mulT(ac->calc->YB_NZB, ac->calc->XAT); // fix: mul => mulT
                     ac->YRED.math_2_add_mul(ac->YRED, ac->calc->XB, ac->calc->NZBXA);
                 }
+                else if (isMatrixFixedNonsymmFaster(Bsiz)) {
+                    math_fixed_reduce_nonsymm(Bsiz, ac->calc->YB_NZB, ac->calc->NZBXA, ac->calc->NZBXAT, ac->YRED, ac->calc->XAT, ac->calc->XB);
+                }
                 else {
                     ac->calc->YB_NZB.math_ninv_np();
                     ac->calc->NZBXA.math_mul_t_unsafe(ac->calc->YB_NZB, ac->calc->XAT);
@@ -1105,7 +728,10 @@ void SunredTreeNode::forwsubsAC(ComponentSubCircuit* pSrc) {
         // forwsubs
         //***********************************************************************
 
-        if (Bsiz == 1) {
+        if (Bsiz == 0) {
+            ac->JRED.copy_unsafe(ac->calc->JAUA);
+        }
+        else if (Bsiz == 1) {
             math_1x1_mul(ac->calc->NZBJB, ac->calc->YB_NZB, ac->calc->JBUB);
             math_1_add_mul_jred(ac->JRED, ac->calc->JAUA, ac->calc->XB, ac->calc->NZBJB);
         }
@@ -1137,6 +763,12 @@ void SunredTreeNode::backsubsDC(ComponentSubCircuit* pSrc) {
     else if (srcCell1 != nullptr) { // nonleaf
     //***********************************************************************
 
+        srcCell1->prefetchDC(); // the sources are the next ones in the backsubs: reverse order of the spill
+        srcCell2->prefetchDC();
+
+        if (Bsiz == 0) // no internal node in this cell
+            return;
+
         //***********************************************************************
         // fill UA
         //***********************************************************************
@@ -1154,6 +786,7 @@ void SunredTreeNode::backsubsDC(ComponentSubCircuit* pSrc) {
 
         if (Bsiz == 1)      math_1_add_mul_ub(dc->calc->JBUB, dc->calc->NZBJB, dc->calc->NZBXA, dc->calc->JAUA);
         else if (Bsiz == 2) math_2_add_mul_ub(dc->calc->JBUB, dc->calc->NZBJB, dc->calc->NZBXA, dc->calc->JAUA);
+        else if (isSymmDC)  math_ldlt_add_nsolve_ub(dc->calc->JBUB, dc->calc->NZBJB, dc->calc->YB_NZB, dc->calc->XB, dc->calc->JAUA);
         else                math_add_mul(dc->calc->JBUB, dc->calc->NZBJB, dc->calc->NZBXA, dc->calc->JAUA);
 
         //***********************************************************************
@@ -1170,6 +803,8 @@ void SunredTreeNode::backsubsDC(ComponentSubCircuit* pSrc) {
             }
         }
 
+        evictDC();
+
     } // else: empty node, belongs to a disabled component, nothing to do
 }
 
@@ -1189,6 +824,9 @@ void SunredTreeNode::backsubsAC(ComponentSubCircuit* pSrc) {
     else if (srcCell1 != nullptr) { // nonleaf
     //***********************************************************************
 
+        if (Bsiz == 0) // no internal node in this cell
+            return;
+
         //***********************************************************************
         // fill UA
         //***********************************************************************
@@ -1228,23 +866,71 @@ void SunredTreeNode::backsubsAC(ComponentSubCircuit* pSrc) {
 
 //***********************************************************************
 void hmgSunred::buildTree(const ReductionTreeInstructions& instr, ComponentSubCircuit* pSrc_) {
-// TO PARALLEL: cells in a level can be loaded parallel
+//***********************************************************************
+    pSrc_->setNodesToComponents();
+    loadTree(instr, pSrc_);
+}
+
+
+//***********************************************************************
+void hmgSunred::loadTree(const ReductionTreeInstructions& instr, ComponentSubCircuit* pSrc_) {
+// pSrc_->setNodesToComponents() has been called; the nodes of a level depend on the lower levels only,
+// so they are loaded parallel, level by level
 //***********************************************************************
     pSrc = pSrc_;
-    pSrc->setNodesToComponents();
+
+    // the schedules need the sources of a node on lower levels; a wrong .SUNREDTREE is rejected here
+
+    for (size_t i = 0; i < instr.data.size(); i++) {
+        cuns destLevel = (uns)i + 1;
+        for (size_t j = 0; j < instr.data[i].size(); j++) {
+            const ReductionInstruction& inst = instr.data[i][j];
+            if (inst.cell1Level >= destLevel || inst.cell2Level >= destLevel)
+                throw hmgExcept("hmgSunred::loadTree", "the source level must be lower than the destination level (RED %u %u %u %u %u %u)",
+                    destLevel, (uns)j, inst.cell1Level, inst.cell1Index, inst.cell2Level, inst.cell2Index);
+            cuns size1 = inst.cell1Level == 0 ? (uns)pSrc->components.size() : (uns)instr.data[inst.cell1Level - 1].size();
+            cuns size2 = inst.cell2Level == 0 ? (uns)pSrc->components.size() : (uns)instr.data[inst.cell2Level - 1].size();
+            if (inst.cell1Index >= size1 || inst.cell2Index >= size2)
+                throw hmgExcept("hmgSunred::loadTree", "source cell index out of range (RED %u %u %u %u %u %u)",
+                    destLevel, (uns)j, inst.cell1Level, inst.cell1Index, inst.cell2Level, inst.cell2Index);
+        }
+    }
 
     levels.clear();
+    arenaDC.reset();
+    arenaAC.reset();
+    spillDC.release();
+    isAllocatedDC = isAllocatedAC = false;
     levels.resize(instr.data.size() + 1);
 
+    // the loaders can throw, the first exception is rethrown after the level
+
+    ThreadPool& pool = ThreadPool::getInstance();
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto guarded = [&](auto&& load) {
+        try {
+            load();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
     // Level 0
 
     levels[0].resize(pSrc->components.size());
     auto& level0 = levels[0];
     auto& comp = pSrc->components;
-    for (size_t i = 0; i < level0.size(); i++) {
-        if (comp[i]->isEnabled) // only the enabled componets are loaded !
-            level0[i].loadLeafDataFromSubcircuit(comp[i].get(), pSrc);
-    }
+    pool.parallelFor((uns)level0.size(), [&](unsigned begin, unsigned end) {
+        for (uns i = begin; i < end; i++)
+            if (comp[i]->isEnabled) // only the enabled componets are loaded !
+                guarded([&] { level0[i].loadLeafDataFromSubcircuit(comp[i].get(), pSrc); });
+    });
+    if (error)
+        std::rethrow_exception(error);
 
     // Levels 1..n
 
@@ -1252,11 +938,304 @@ void hmgSunred::buildTree(const ReductionTreeInstructions& instr, ComponentSubCi
         auto& level = levels[i + 1];
         const auto& instLev = instr.data[i];
         level.resize(instLev.size());
-        for (size_t j = 0; j < level.size(); j++) {
+        pool.parallelTasks((uns)level.size(), [&](unsigned j) {
             const auto& inst = instLev[j];
-            level[j].loadNodeDataFromTwoNodes(&levels[inst.cell1Level][inst.cell1Index], &levels[inst.cell2Level][inst.cell2Index]);
+            guarded([&] { level[j].loadNodeDataFromTwoNodes(&levels[inst.cell1Level][inst.cell1Index], &levels[inst.cell2Level][inst.cell2Index]); });
+        });
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    buildTasks(instr);
+
+    if (SunredTreeOptimizer::isOutputOpen()) { // hexmg -treeopt <file>
+        SunredTreeCost cost;
+        getPredictedCost(cost);
+        SunredTreeOptimizer::optimizeToOutput(instr, pSrc, cost);
+    }
+}
+
+
+//***********************************************************************
+void hmgSunred::allocDC() {
+// hexmg -membudget: the matrices of calc in the lowest levels are spilled (they are needed last in the backsubs)
+// until the rest of the predicted memory fits in the budget
+//***********************************************************************
+    if (isAllocatedDC)
+        return;
+    nSpilledLevelsDC = 0;
+    if (memoryBudget != 0) {
+        size_t bytes = 0, spillBytes = 0;
+        for (const auto& level : levels)
+            for (const auto& node : level)
+                bytes += node.getPredictedBytesDC();
+        while (bytes > memoryBudget + spillBytes && nSpilledLevelsDC < levels.size()) {
+            for (const auto& node : levels[nSpilledLevelsDC])
+                spillBytes += node.getSpillBytesDC();
+            nSpilledLevelsDC++;
+        }
+        if (spillBytes == 0)
+            nSpilledLevelsDC = 0;
+        else {
+            spillDC.setFileBacked(true);
+            spillDC.reserve(spillBytes);
+            printf("SUNRED: %u of %u levels spilled to a scratch file, %.1f MB of %.1f MB\n",
+                nSpilledLevelsDC, (uns)levels.size(), spillBytes / 1048576.0, bytes / 1048576.0);
+        }
+    }
+    for (uns i = 0; i < levels.size(); i++)
+        for (auto& node : levels[i])
+            node.allocDC(arenaDC, i < nSpilledLevelsDC ? &spillDC : nullptr);
+    isAllocatedDC = true;
+}
+
+
+//***********************************************************************
+void hmgSunred::buildAutoTree(ComponentSubCircuit* pSrc_) {
+//***********************************************************************
+    pSrc_->setNodesToComponents();
+    std::vector<bool> isLeafEnabled(pSrc_->components.size());
+    for (size_t i = 0; i < isLeafEnabled.size(); i++)
+        isLeafEnabled[i] = pSrc_->components[i]->isEnabled;
+    SunredTreeBuilder::build(pSrc_->internalNodesToComponents, isLeafEnabled, autoTree);
+    loadTree(autoTree, pSrc_);
+}
+
+
+//***********************************************************************
+void hmgSunred::getPredictedCost(SunredTreeCost& dest) const {
+//***********************************************************************
+    dest = SunredTreeCost{};
+    for (uns i = 0; i < levels.size(); i++)
+        for (const auto& node : levels[i])
+            dest.add(i, node);
+}
+
+
+//***********************************************************************
+void hmgSunred::buildTasks(const ReductionTreeInstructions& instr) {
+// the dependency graph of the dataflow scheduling: forwsubs goes from the children to the parent,
+// backsubs from the parent to the children
+//***********************************************************************
+    levelStart.assign(levels.size() + 1, 0);
+    for (size_t i = 0; i < levels.size(); i++)
+        levelStart[i + 1] = levelStart[i] + (uns)levels[i].size();
+    cuns nTasks = levelStart.back();
+    nLeafTasks = levelStart[1];
+
+    taskNodes.resize(nTasks);
+    for (size_t i = 0; i < levels.size(); i++)
+        for (size_t j = 0; j < levels[i].size(); j++)
+            taskNodes[levelStart[i] + j] = &levels[i][j];
+
+    taskLinks.assign(nTasks, TaskLinks());
+    for (size_t i = 0; i < instr.data.size(); i++) {
+        const auto& instLev = instr.data[i];
+        for (size_t j = 0; j < instLev.size(); j++) {
+            cuns task = levelStart[i + 1] + (uns)j;
+            cuns child1 = levelStart[instLev[j].cell1Level] + instLev[j].cell1Index;
+            cuns child2 = levelStart[instLev[j].cell2Level] + instLev[j].cell2Index;
+            if (taskLinks[child1].parent != noTask || taskLinks[child2].parent != noTask)
+                throw hmgExcept("hmgSunred::buildTasks", "a node is merged more than once in the reduction tree (level %u, index %u)", (uns)i + 1, (uns)j);
+            taskLinks[task].child1 = child1;
+            taskLinks[task].child2 = child2;
+            taskLinks[child1].parent = task;
+            taskLinks[child2].parent = task;
         }
     }
+
+    leafTasks.resize(nLeafTasks);
+    for (uns i = 0; i < nLeafTasks; i++)
+        leafTasks[i] = i;
+
+    nWaitingChildren = std::make_unique<std::atomic<uns>[]>(nTasks);
+    nSplitThreads = 0;
+}
+
+
+//***********************************************************************
+void hmgSunred::splitNarrowLevels() {
+// the number of threads can change between two runs (hexmg -threads)
+//***********************************************************************
+    cuns nThreads = ThreadPool::getInstance().getNThreads();
+    if (nSplitThreads == nThreads)
+        return;
+    firstNarrowLevel = (uns)levels.size();
+    while (firstNarrowLevel > 1 && levels[firstNarrowLevel - 1].size() < nThreads)
+        firstNarrowLevel--;
+    nWideTasks = levelStart[firstNarrowLevel];
+    rootTasks.clear();
+    for (uns i = nLeafTasks; i < nWideTasks; i++)
+        if (taskLinks[i].parent == noTask || taskLinks[i].parent >= nWideTasks)
+            rootTasks.push_back(i);
+    nSplitThreads = nThreads;
+}
+
+
+//***********************************************************************
+struct SunredTrace {
+// hexmg -trace <file>: wall time, busy time (the sum of the node reduction times) and idle time of the threads
+// (a node of the narrow top levels is counted once, although its matrix kernels run on the threads of the pool)
+//***********************************************************************
+    using Clock = std::chrono::steady_clock;
+    FILE* fp = nullptr;
+    std::mutex mutex; // more hmgSunred can run parallel
+    rvt sumWall = 0, sumBusy = 0, sumIdle = 0;
+    uns nPasses = 0;
+    //***********************************************************************
+    bool isOn() const noexcept { return fp != nullptr; }
+    //***********************************************************************
+    void write(const char* passName, uns nNodes, Clock::time_point start, unsigned long long busyNs) {
+    //***********************************************************************
+        crvt wall = std::chrono::duration<rvt>(Clock::now() - start).count();
+        cuns nThreads = ThreadPool::getInstance().getNThreads();
+        crvt busy = busyNs * 1e-9;
+        crvt idle = wall * nThreads > busy ? wall * nThreads - busy : 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fp == nullptr)
+            return;
+        fprintf_s(fp, "%-10s\t%-8s\tthreads=%u\tnodes=%u\twall=%.6f s\tbusy=%.6f s\tidle=%.6f s\tutilization=%.1f%%\n",
+            passName, hmgSunred::scheduling == ssLevels ? "levels" : "dataflow", nThreads, nNodes,
+            wall, busy, idle, wall > 0 ? 100 * busy / (wall * nThreads) : 100.0);
+        sumWall += wall;
+        sumBusy += busy;
+        sumIdle += idle;
+        nPasses++;
+    }
+};
+static SunredTrace sunredTrace;
+
+
+//***********************************************************************
+void hmgSunred::openTrace(const char* fileName) {
+//***********************************************************************
+    closeTrace();
+    std::lock_guard<std::mutex> lock(sunredTrace.mutex);
+    if (fopen_s(&sunredTrace.fp, fileName, "wt") != 0)
+        throw hmgExcept("hmgSunred::openTrace", "cannot open file to write: %s", fileName);
+    sunredTrace.sumWall = sunredTrace.sumBusy = sunredTrace.sumIdle = 0;
+    sunredTrace.nPasses = 0;
+}
+
+
+//***********************************************************************
+void hmgSunred::closeTrace() {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(sunredTrace.mutex);
+    if (sunredTrace.fp == nullptr)
+        return;
+    crvt all = sunredTrace.sumBusy + sunredTrace.sumIdle;
+    fprintf_s(sunredTrace.fp, "total\tpasses=%u\twall=%.6f s\tbusy=%.6f s\tidle=%.6f s\tutilization=%.1f%%\n",
+        sunredTrace.nPasses, sunredTrace.sumWall, sunredTrace.sumBusy, sunredTrace.sumIdle, all > 0 ? 100 * sunredTrace.sumBusy / all : 100.0);
+    fclose(sunredTrace.fp);
+    sunredTrace.fp = nullptr;
+}
+
+
+//***********************************************************************
+struct SunredPassState {
+// the first exception of a pass is rethrown when the pass is done; after an error the node steps
+// are skipped, but the dependencies are still resolved, so the pass terminates
+//***********************************************************************
+    std::atomic<bool> hasError = false;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    std::atomic<unsigned long long> busyNs = 0;
+    const bool isTraced = sunredTrace.isOn();
+    //***********************************************************************
+    void run(SunredTreeNode* node, void (SunredTreeNode::*step)(ComponentSubCircuit*), ComponentSubCircuit* pSrc) {
+    //***********************************************************************
+        if (hasError.load(std::memory_order_relaxed))
+            return;
+        try {
+            if (isTraced) {
+                const auto start = SunredTrace::Clock::now();
+                (node->*step)(pSrc);
+                busyNs += (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(SunredTrace::Clock::now() - start).count();
+            }
+            else
+                (node->*step)(pSrc);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            hasError = true;
+        }
+    }
+    //***********************************************************************
+    void rethrow() {
+    //***********************************************************************
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+
+//***********************************************************************
+void hmgSunred::runForward(NodeStep step, const char* passName) {
+//***********************************************************************
+    if (levels.empty())
+        return;
+    const auto start = SunredTrace::Clock::now();
+    SunredPassState state;
+    splitNarrowLevels();
+    if (scheduling == ssLevels) {
+        for (uns i = 0; i < firstNarrowLevel; i++) {
+            auto& level = levels[i];
+            ThreadPool::getInstance().parallelTasks((uns)level.size(), [&](unsigned j) { state.run(&level[j], step, pSrc); });
+        }
+    }
+    else {
+        for (uns i = nLeafTasks; i < nWideTasks; i++)
+            nWaitingChildren[i].store(2, std::memory_order_relaxed);
+        ThreadPool::getInstance().parallelDataflow(nWideTasks, leafTasks, [&](unsigned task, const ThreadPool::ReadyFunction& ready) {
+            state.run(taskNodes[task], step, pSrc);
+            cuns parent = taskLinks[task].parent;
+            if (parent < nWideTasks && nWaitingChildren[parent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                ready(parent);
+        });
+    }
+    for (uns i = firstNarrowLevel; i < levels.size(); i++) // parallel inside the nodes
+        for (auto& node : levels[i])
+            state.run(&node, step, pSrc);
+    if (state.isTraced)
+        sunredTrace.write(passName, (uns)taskNodes.size(), start, state.busyNs);
+    state.rethrow();
+}
+
+
+//***********************************************************************
+void hmgSunred::runBackward(NodeStep step, const char* passName) {
+// the backsubs of the leaves is empty, they are not scheduled
+//***********************************************************************
+    if (levels.empty())
+        return;
+    const auto start = SunredTrace::Clock::now();
+    SunredPassState state;
+    splitNarrowLevels();
+    for (uns i = (uns)levels.size() - 1; i >= firstNarrowLevel && i > 0; i--) // parallel inside the nodes
+        for (auto& node : levels[i])
+            state.run(&node, step, pSrc);
+    if (scheduling == ssLevels) {
+        for (uns i = firstNarrowLevel - 1; i > 0; i--) {
+            auto& level = levels[i];
+            ThreadPool::getInstance().parallelTasks((uns)level.size(), [&](unsigned j) { state.run(&level[j], step, pSrc); });
+        }
+    }
+    else {
+        ThreadPool::getInstance().parallelDataflow(nWideTasks - nLeafTasks, rootTasks, [&](unsigned task, const ThreadPool::ReadyFunction& ready) {
+            state.run(taskNodes[task], step, pSrc);
+            const TaskLinks& links = taskLinks[task];
+            if (links.child2 >= nLeafTasks)
+                ready(links.child2);
+            if (links.child1 >= nLeafTasks)
+                ready(links.child1);
+        });
+    }
+    if (state.isTraced)
+        sunredTrace.write(passName, (uns)taskNodes.size() - nLeafTasks, start, state.busyNs);
+    state.rethrow();
 }
 
 
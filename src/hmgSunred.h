@@ -14,6 +14,7 @@
 //***********************************************************************
 #include "hmgCommon.h"
 #include "hmgMatrix.hpp"
+#include <memory>
 //***********************************************************************
 
 
@@ -38,6 +39,10 @@ struct SunredReductorDC {
     vektor<rvt> JRED;
     std::unique_ptr<CalcPack> calc;
     std::unique_ptr<LeafPack> leaf; // only if there are common (connected) nodes, so the YRED and JRED is not the same as the YRED and JRED of the source component
+    bool isFloatReduced = false; // the stored reduction is mixed precision (see SimControl::isFloatReductionDC)
+    bool isSpilled = false; // the matrices of calc are in the file backed arena (hexmg -membudget)
+    bool isLeafLoaded = false; // the leaf YRED has been loaded from the component
+    uns leafYVersion = 0; // ComponentBase::getYDCVersion at the last load of the leaf
 };
 
 
@@ -60,6 +65,15 @@ struct SunredReductorAC {
 };
 
 
+//***********************************************************************
+template<typename T> struct SunredScatterMap {
+// the A nodes of a source cell in the merged cell, built in loadNodeDataFromTwoNodes: the A node srcA[i]
+// of the source is the A node dstA[i] of the merged cell, srcB[i] is dstB[i] in the B block; srcA and srcB are ascending
+//***********************************************************************
+    std::vector<T> srcA, dstA, srcB, dstB;
+};
+
+
 class ComponentBase;
 class ComponentSubCircuit;
 class hmgSunred;
@@ -82,16 +96,23 @@ class SunredTreeNode {
     std::vector<Connections> ANodeIndex; // node in the subcircuit; if (ANodeIndex & XNodeFlag) == 0 => internal node, else external; ANodeIndex.size() = Arowcol
     std::vector<uns> BNodeIndex; // node in the subcircuit; only internal nodes can be in B block !; BNodeIndex.size() = Browcol
     std::vector<IndexPair> CNodeIndex; // used in leafs only
+    SunredScatterMap<ush> narrowMap1, narrowMap2;   // nonleaf: srcCell1 => this, srcCell2 => this, if every index fits in 16 bits...
+    SunredScatterMap<uns> wideMap1, wideMap2;       // ...else these
+    bool isWideMap = false;
     bool isSymmDC = false, isSymmAC = false;
     bool isChangedDC = false, isChangedAC = false;
     std::unique_ptr<SunredReductorDC> dc;
     std::unique_ptr<SunredReductorAC> ac;
+    //***********************************************************************
+    template<typename T> void buildScatterMap(SunredScatterMap<T>& dest, const SunredTreeNode* src) const;
+    //***********************************************************************
 public:
     //***********************************************************************
     void loadLeafDataFromSubcircuit(ComponentBase* src, ComponentSubCircuit* pSubckt);
     void loadNodeDataFromTwoNodes(SunredTreeNode* src1, SunredTreeNode* src2);
     //***********************************************************************
-    void allocDC() {
+    void allocDC(AlignedArena& arena, AlignedArena* spillArena = nullptr) {
+    // if spillArena is given, the matrices of calc are allocated from it
     //***********************************************************************
         if (srcComponent != nullptr || srcCell1 != nullptr) {
 
@@ -100,31 +121,38 @@ public:
             cuns Csiz = (uns)CNodeIndex.size();
 
             dc = std::make_unique<SunredReductorDC>();
-            dc->YRED.resize_if_needed(Asiz, Asiz, isSymmDC);
-            dc->JRED.resize_if_needed(Asiz);
+            dc->YRED.resize_if_needed(Asiz, Asiz, isSymmDC, &arena);
+            dc->JRED.resize_if_needed(Asiz, &arena);
 
             if (srcComponent != nullptr) { // leaf
                 if (Asiz != Csiz) {
                     dc->leaf = std::make_unique<SunredReductorDC::LeafPack>();
-                    dc->leaf->YA.resize_if_needed(Csiz, Csiz, isSymmDC);
-                    dc->leaf->JA.resize_if_needed(Csiz);
+                    dc->leaf->YA.resize_if_needed(Csiz, Csiz, isSymmDC, &arena);
+                    dc->leaf->JA.resize_if_needed(Csiz, &arena);
                 }
             }
             else { // nonleaf
+                AlignedArena* matrixArena = spillArena != nullptr ? spillArena : &arena;
+                dc->isSpilled = spillArena != nullptr;
                 dc->calc = std::make_unique<SunredReductorDC::CalcPack>();
-                if (!isSymmDC) dc->calc->XAT.resize_if_needed(Asiz, Bsiz, false);
-                dc->calc->XB.resize_if_needed(Asiz, Bsiz, false);
-                dc->calc->YB_NZB.resize_if_needed(Bsiz, Bsiz, false); // never symmetrical!
-                dc->calc->NZBXA.resize_if_needed(Bsiz, Asiz, false);
-                dc->calc->NZBXAT.resize_if_needed(Asiz, Bsiz, false);
-                dc->calc->JAUA.resize_if_needed(Asiz);
-                dc->calc->JBUB.resize_if_needed(Bsiz);
-                dc->calc->NZBJB.resize_if_needed(Bsiz);
+                if (!isSymmDC) dc->calc->XAT.resize_if_needed(Asiz, Bsiz, false, matrixArena);
+                dc->calc->XB.resize_if_needed(Asiz, Bsiz, false, matrixArena);
+                if (isSymmDC && Bsiz > 2) { // LDLT factor in YB_NZB, L^-1 * XA in NZBXAT, no NZBXA
+                    dc->calc->YB_NZB.resize_if_needed(Bsiz, Bsiz, true, matrixArena);
+                }
+                else {
+                    dc->calc->YB_NZB.resize_if_needed(Bsiz, Bsiz, false, matrixArena); // inverse, never symmetrical!
+                    dc->calc->NZBXA.resize_if_needed(Bsiz, Asiz, false, matrixArena);
+                }
+                dc->calc->NZBXAT.resize_if_needed(Asiz, Bsiz, false, matrixArena);
+                dc->calc->JAUA.resize_if_needed(Asiz, &arena);
+                dc->calc->JBUB.resize_if_needed(Bsiz, &arena);
+                dc->calc->NZBJB.resize_if_needed(Bsiz, &arena);
             }
         } // else: empty node, belsongs to a disabled component, nothing to do
     }
     //***********************************************************************
-    void allocAC() {
+    void allocAC(AlignedArena& arena) {
     //***********************************************************************
         if (srcComponent != nullptr || srcCell1 != nullptr) {
 
@@ -133,32 +161,42 @@ public:
             cuns Csiz = (uns)CNodeIndex.size();
 
             ac = std::make_unique<SunredReductorAC>();
-            ac->YRED.resize_if_needed(Asiz, Asiz, isSymmAC);
-            ac->JRED.resize_if_needed(Asiz);
+            ac->YRED.resize_if_needed(Asiz, Asiz, isSymmAC, &arena);
+            ac->JRED.resize_if_needed(Asiz, &arena);
 
             if (srcComponent != nullptr) { // leaf
                 if (Asiz != Csiz) {
                     ac->leaf = std::make_unique<SunredReductorAC::LeafPack>();
-                    ac->leaf->YA.resize_if_needed(Csiz, Csiz, isSymmAC);
-                    ac->leaf->JA.resize_if_needed(Csiz);
+                    ac->leaf->YA.resize_if_needed(Csiz, Csiz, isSymmAC, &arena);
+                    ac->leaf->JA.resize_if_needed(Csiz, &arena);
                 }
             }
             else { // nonleaf
                 ac->calc = std::make_unique<SunredReductorAC::CalcPack>();
-                if (!isSymmAC) ac->calc->XAT.resize_if_needed(Asiz, Bsiz, false);
-                ac->calc->XB.resize_if_needed(Asiz, Bsiz, false);
-                ac->calc->YB_NZB.resize_if_needed(Bsiz, Bsiz, false); // never symmetrical!
-                ac->calc->NZBXA.resize_if_needed(Bsiz, Asiz, false);
-                ac->calc->NZBXAT.resize_if_needed(Asiz, Bsiz, false);
-                ac->calc->JAUA.resize_if_needed(Asiz);
-                ac->calc->JBUB.resize_if_needed(Bsiz);
-                ac->calc->NZBJB.resize_if_needed(Bsiz);
+                if (!isSymmAC) ac->calc->XAT.resize_if_needed(Asiz, Bsiz, false, &arena);
+                ac->calc->XB.resize_if_needed(Asiz, Bsiz, false, &arena);
+                ac->calc->YB_NZB.resize_if_needed(Bsiz, Bsiz, false, &arena); // never symmetrical!
+                ac->calc->NZBXA.resize_if_needed(Bsiz, Asiz, false, &arena);
+                ac->calc->NZBXAT.resize_if_needed(Asiz, Bsiz, false, &arena);
+                ac->calc->JAUA.resize_if_needed(Asiz, &arena);
+                ac->calc->JBUB.resize_if_needed(Bsiz, &arena);
+                ac->calc->NZBJB.resize_if_needed(Bsiz, &arena);
             }
         } // else: empty node, belsongs to a disabled component, nothing to do
     }
     //***********************************************************************
     void clearDC() { dc.reset(); }
     void clearAC() { ac.reset(); }
+    //***********************************************************************
+    bool isEnabled() const noexcept { return srcComponent != nullptr || srcCell1 != nullptr; } // false: empty node of a disabled component
+    uns getAsiz() const noexcept { return (uns)ANodeIndex.size(); }
+    uns getBsiz() const noexcept { return (uns)BNodeIndex.size(); }
+    double getPredictedFlopsDC() const noexcept;
+    size_t getPredictedBytesDC() const noexcept;
+    size_t getSpillBytesDC() const noexcept; // the matrices of calc in the arena, with the alignment
+    void evictDC() const noexcept;      // if dc->isSpilled: the matrices of calc go to the scratch file...
+    void prefetchDC() const noexcept;   // ...and come back
+    //***********************************************************************
     void forwsubsDC(ComponentSubCircuit* pSrc);
     void forwsubsAC(ComponentSubCircuit* pSrc);
     void backsubsDC(ComponentSubCircuit* pSrc);
@@ -178,6 +216,16 @@ public:
 };
 
 
+struct SunredTreeCost;
+//***********************************************************************
+enum SunredScheduling {
+// the order of the node reductions in the threads of the pool
+//***********************************************************************
+    ssLevels,   // level by level, the levels are barriers
+    ssDataflow  // a node is reduced as soon as its two source nodes are ready, backsubs in reverse
+};
+
+
 //***********************************************************************
 class hmgSunred {
 //***********************************************************************
@@ -185,33 +233,74 @@ public:
     struct ReductionTreeInstructions {
         std::vector<std::vector<ReductionInstruction>> data; // data[0] = Level 1, data[1] = Level 2, etc. level[0][i] = pSrc->components[i]
     };
+    inline static SunredScheduling scheduling = ssDataflow; // hexmg -sunred levels|dataflow
+    inline static size_t memoryBudget = 0; // hexmg -membudget <MB>: the lowest levels are spilled to a scratch file until the rest fits, 0: no limit
 private:
+    //***********************************************************************
+    static constexpr uns noTask = ~0u;
+    struct TaskLinks {
+    // the nodes are tasks, numbered level by level
+    //***********************************************************************
+        uns parent = noTask;                    // the node that merges this node
+        uns child1 = noTask, child2 = noTask;   // srcCell1 and srcCell2
+    };
+    using NodeStep = void (SunredTreeNode::*)(ComponentSubCircuit*);
+    //***********************************************************************
+    AlignedArena arenaDC, arenaAC; // the matrices of the nodes, they must be destroyed after levels
+    AlignedArena spillDC;           // file backed, the matrices of calc in the spilled levels
+    bool isAllocatedDC = false, isAllocatedAC = false;
+    uns nSpilledLevelsDC = 0;
     std::vector<std::vector<SunredTreeNode>> levels;
     //std::vector<std::vector<uns>> nodeConnectingComponents; // nodeConnectingComponents[i][j] => i: node, j: component
     ComponentSubCircuit* pSrc = nullptr;
+    std::vector<SunredTreeNode*> taskNodes;     // task index => node
+    std::vector<TaskLinks> taskLinks;
+    std::vector<uns> levelStart;                // the first task of the levels, levelStart[levels.size()] is the number of tasks
+    std::vector<uns> leafTasks, rootTasks;      // the first tasks of forwsubs (level 0) and of backsubs (no parent in the wide levels)
+    std::unique_ptr<std::atomic<uns>[]> nWaitingChildren; // forwsubs countdowns
+    uns nLeafTasks = 0;                         // the tasks of level 0 are 0...nLeafTasks-1, their backsubs is empty
+    ReductionTreeInstructions autoTree;         // SUNRED=AUTO, built by SunredTreeBuilder
+    // the top levels with fewer nodes than threads are narrow: their nodes are reduced one by one
+    // by the calling thread, outside of the pool jobs, so the matrix kernels can use all threads
+    uns firstNarrowLevel = 0;                   // levels.size() if every level is wide
+    uns nWideTasks = 0;                         // levelStart[firstNarrowLevel]
+    uns nSplitThreads = 0;                      // the firstNarrowLevel is set for this number of threads, 0: not set
+    //***********************************************************************
+    void loadTree(const ReductionTreeInstructions& instr, ComponentSubCircuit* pSrc_);
+    void buildTasks(const ReductionTreeInstructions& instr);
+    void splitNarrowLevels();
+    void runForward(NodeStep step, const char* passName);
+    void runBackward(NodeStep step, const char* passName);
 public:
     //***********************************************************************
-    void buildTree(const ReductionTreeInstructions& instr, ComponentSubCircuit* pSrc_);
+    static void openTrace(const char* fileName); // hexmg -trace <file>: utilization of the threads in every forwsubs / backsubs
+    static void closeTrace();
     //***********************************************************************
-    void allocDC() {
+    void buildTree(const ReductionTreeInstructions& instr, ComponentSubCircuit* pSrc_);
+    void buildAutoTree(ComponentSubCircuit* pSrc_); // SUNRED=AUTO
+    void getPredictedCost(SunredTreeCost& dest) const;
     //***********************************************************************
-        for (auto& level : levels)
-            for (auto& node : level)
-                node.allocDC();
-    }
+    void allocDC(); // the nodes keep their matrices until the tree is rebuilt or clearDC() is called
     //***********************************************************************
     void clearDC() {
     //***********************************************************************
         for (auto& level : levels)
             for (auto& node : level)
                 node.clearDC();
+        arenaDC.reset();
+        spillDC.release();
+        isAllocatedDC = false;
     }
     //***********************************************************************
     void allocAC() {
+    // the nodes keep their matrices until the tree is rebuilt or clearAC() is called
     //***********************************************************************
+        if (isAllocatedAC)
+            return;
         for (auto& level : levels)
             for (auto& node : level)
-                node.allocAC();
+                node.allocAC(arenaAC);
+        isAllocatedAC = true;
     }
     //***********************************************************************
     void clearAC() {
@@ -219,43 +308,17 @@ public:
         for (auto& level : levels)
             for (auto& node : level)
                 node.clearAC();
+        arenaAC.reset();
+        isAllocatedAC = false;
     }
     //***********************************************************************
-    void forwsubsDC() {
-    // TO PARALLEL
-    //***********************************************************************
-        for (auto& level : levels)
-            for (auto& node : level)
-                node.forwsubsDC(pSrc);
-    }
-    //***********************************************************************
-    void backsubsDC() {
-    // TO PARALLEL
-    //***********************************************************************
-        for (size_t i = levels.size(); i != 0; i--) {
-            auto& level = levels[i - 1];
-            for (auto& node : level)
-                node.backsubsDC(pSrc);
-        }
-    }
-    //***********************************************************************
-    void forwsubsAC() {
-    // TO PARALLEL
+    void forwsubsDC() { runForward(&SunredTreeNode::forwsubsDC, "forwsubsDC"); }
     //***********************************************************************
-        for (auto& level : levels)
-            for (auto& node : level)
-                node.forwsubsAC(pSrc);
-    }
+    void backsubsDC() { runBackward(&SunredTreeNode::backsubsDC, "backsubsDC"); }
     //***********************************************************************
-    void backsubsAC() {
-    // TO PARALLEL
+    void forwsubsAC() { runForward(&SunredTreeNode::forwsubsAC, "forwsubsAC"); }
     //***********************************************************************
-        for (size_t i = levels.size(); i != 0; i--) {
-            auto& level = levels[i - 1];
-            for (auto& node : level)
-                node.backsubsAC(pSrc);
-        }
-    }
+    void backsubsAC() { runBackward(&SunredTreeNode::backsubsAC, "backsubsAC"); }
     //***********************************************************************
 };
 
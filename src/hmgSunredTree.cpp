@@ -0,0 +1,417 @@
+//***********************************************************************
+// HexMG SUNRED Tree Builder CPP
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgSunredTree.h"
+#include "hmgComponent.h"
+#include <algorithm>
+#include <mutex>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+uns SunredTreeBuilder::breadthFirst(uns first, uns begin, uns end, uns* result) {
+// visits the leaves of order[begin...end-1] from first, result is the visiting order (the queue),
+// a disconnected part is continued from its first unvisited leaf; returns the last visited leaf
+//***********************************************************************
+    cuns n = end - begin;
+    visitStamp++;
+    uns nVisited = 0, head = 0, next = begin, last = first;
+    leafVisit[first] = visitStamp;
+    result[nVisited++] = first;
+    for (;;) {
+        while (head < nVisited) {
+            last = result[head++];
+            for (uns node : leafToNodes[last]) {
+                if (nodeVisit[node] == visitStamp) // every leaf of this node is already seen
+                    continue;
+                nodeVisit[node] = visitStamp;
+                for (uns neighbour : nodeToLeaves[node])
+                    if (leafSet[neighbour] == setStamp && leafVisit[neighbour] != visitStamp) {
+                        leafVisit[neighbour] = visitStamp;
+                        result[nVisited++] = neighbour;
+                    }
+            }
+        }
+        if (nVisited == n)
+            return last;
+        while (leafVisit[order[next]] == visitStamp)
+            next++;
+        leafVisit[order[next]] = visitStamp;
+        result[nVisited++] = order[next];
+    }
+}
+
+
+//***********************************************************************
+SunredTreeBuilder::Cell SunredTreeBuilder::dissect(uns begin, uns end) {
+// the depth of the recursion is log2(number of leaves)
+//***********************************************************************
+    cuns n = end - begin;
+    if (n == 1)
+        return Cell{ 0, order[begin] };
+
+    setStamp++;
+    for (uns i = begin; i < end; i++)
+        leafSet[order[i]] = setStamp;
+
+    // the second search starts from a pseudo-peripheral leaf: the levels are narrow
+
+    cuns peripheral = breadthFirst(order[begin], begin, end, queue.data());
+    breadthFirst(peripheral, begin, end, queue.data());
+    for (uns i = 0; i < n; i++)
+        order[begin + i] = queue[i];
+
+    cuns middle = begin + n / 2;
+    const Cell cell1 = dissect(begin, middle);
+    const Cell cell2 = dissect(middle, end);
+
+    cuns level = (cell1.level > cell2.level ? cell1.level : cell2.level) + 1;
+    if (dest.data.size() < level)
+        dest.data.resize(level);
+    auto& destLevel = dest.data[level - 1];
+    destLevel.push_back(ReductionInstruction{ cell1.level, cell1.index, cell2.level, cell2.index });
+    return Cell{ level, (uns)destLevel.size() - 1 };
+}
+
+
+//***********************************************************************
+void SunredTreeBuilder::build(const std::vector<std::vector<uns>>& nodeToLeaves, const std::vector<bool>& isLeafEnabled,
+    hmgSunred::ReductionTreeInstructions& dest) {
+// the disabled leaves are not in the tree
+//***********************************************************************
+    dest.data.clear();
+    SunredTreeBuilder builder(nodeToLeaves, dest);
+    cuns nLeaves = (uns)isLeafEnabled.size();
+
+    builder.leafToNodes.resize(nLeaves);
+    for (uns node = 0; node < nodeToLeaves.size(); node++)
+        for (uns leaf : nodeToLeaves[node])
+            builder.leafToNodes[leaf].push_back(node);
+    for (uns leaf = 0; leaf < nLeaves; leaf++)
+        if (isLeafEnabled[leaf])
+            builder.order.push_back(leaf);
+    if (builder.order.size() < 2)
+        return;
+
+    builder.leafSet.assign(nLeaves, 0);
+    builder.leafVisit.assign(nLeaves, 0);
+    builder.nodeVisit.assign(nodeToLeaves.size(), 0);
+    builder.queue.resize(builder.order.size());
+    builder.dissect(0, (uns)builder.order.size());
+}
+
+
+//***********************************************************************
+void SunredTreeCost::add(uns level, const SunredTreeNode& node) {
+//***********************************************************************
+    if (levels.size() <= level)
+        levels.resize(level + 1);
+    if (!node.isEnabled())
+        return;
+    auto& dest = levels[level];
+    cuns Asiz = node.getAsiz();
+    cuns Bsiz = node.getBsiz();
+    crvt nodeFlops = node.getPredictedFlopsDC();
+    const size_t nodeBytes = node.getPredictedBytesDC();
+    dest.nNodes++;
+    if (dest.maxA < Asiz) dest.maxA = Asiz;
+    if (dest.maxB < Bsiz) dest.maxB = Bsiz;
+    dest.flops += nodeFlops;
+    dest.bytes += nodeBytes;
+    flops += nodeFlops;
+    bytes += nodeBytes;
+}
+
+
+//***********************************************************************
+void SunredTreeCost::print(FILE* fp, const char* title) const {
+// the peak memory of a level is the memory of the level and of the levels below
+//***********************************************************************
+    fprintf_s(fp, "// %s: %u levels, %.4g flops, %.3f MB\n", title, (uns)levels.size(), flops, bytes / 1048576.0);
+    fprintf_s(fp, "//   level   nodes    maxA    maxB        flops   memory[MB]     peak[MB]\n");
+    size_t sumBytes = 0;
+    for (uns i = 0; i < levels.size(); i++) {
+        const auto& level = levels[i];
+        sumBytes += level.bytes;
+        fprintf_s(fp, "// %7u %7u %7u %7u %12.4g %12.3f %12.3f\n", i, level.nNodes, level.maxA, level.maxB, level.flops, level.bytes / 1048576.0, sumBytes / 1048576.0);
+    }
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::load(const hmgSunred::ReductionTreeInstructions& src, ComponentSubCircuit* pSrc) {
+// the source tree is already checked by hmgSunred::buildTree
+//***********************************************************************
+    cuns nLeaves = (uns)pSrc->components.size();
+    std::vector<uns> levelStart(src.data.size() + 1);
+    levelStart[0] = 0;
+    uns nCells = nLeaves;
+    for (uns i = 0; i < src.data.size(); i++) {
+        levelStart[i + 1] = nCells;
+        nCells += (uns)src.data[i].size();
+    }
+
+    cells.clear();
+    cells.resize(nCells); // no reallocation later: the nodes point to their source nodes
+    for (uns i = 0; i < nLeaves; i++)
+        if (pSrc->components[i]->isEnabled)
+            cells[i].node.loadLeafDataFromSubcircuit(pSrc->components[i].get(), pSrc);
+    for (uns i = 0; i < src.data.size(); i++)
+        for (uns j = 0; j < src.data[i].size(); j++) {
+            const auto& inst = src.data[i][j];
+            merge(levelStart[i + 1] + j, levelStart[inst.cell1Level] + inst.cell1Index, levelStart[inst.cell2Level] + inst.cell2Index);
+        }
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::setOrder() {
+//***********************************************************************
+    order.clear();
+    std::vector<uns> stack;
+    for (uns i = 0; i < cells.size(); i++) {
+        if (cells[i].parent != noCell || !cells[i].node.isEnabled())
+            continue;
+        stack.push_back(i); // root
+        while (!stack.empty()) {
+            cuns cell = stack.back();
+            stack.pop_back();
+            order.push_back(cell);
+            if (cells[cell].child1 != noCell) {
+                stack.push_back(cells[cell].child1);
+                stack.push_back(cells[cell].child2);
+            }
+        }
+    }
+    std::reverse(order.begin(), order.end()); // parents first => children first
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::merge(uns dest, uns src1, uns src2) {
+//***********************************************************************
+    auto& cell = cells[dest];
+    cell.child1 = src1;
+    cell.child2 = src2;
+    cells[src1].parent = dest;
+    cells[src2].parent = dest;
+    cell.node.loadNodeDataFromTwoNodes(&cells[src1].node, &cells[src2].node);
+}
+
+
+//***********************************************************************
+bool SunredTreeOptimizer::improve(uns p) {
+// tries the rotations and re-pairings of p, applies the best one if it is cheaper than the current subtree
+//***********************************************************************
+    cuns x = cells[p].child1, y = cells[p].child2;
+    if (x == noCell)
+        return false;
+    const bool isXMerged = cells[x].child1 != noCell;
+    const bool isYMerged = cells[y].child1 != noCell;
+
+    enum Move { mNone, mRotate, mRepair };
+    Move bestMove = mNone;
+    uns bestA = 0, bestB = 0, bestC = 0, bestD = 0, bestX = 0;
+    rvt bestGain = 0;
+
+    // rotations: P = ((a, b), Y) => P = ((a, Y), b)
+
+    for (uns side = 0; side < 2; side++) {
+        cuns X = side == 0 ? x : y;
+        cuns Y = side == 0 ? y : x;
+        if (cells[X].child1 == noCell)
+            continue;
+        crvt oldCost = cost(X) + cost(p);
+        for (uns k = 0; k < 2; k++) {
+            cuns a = k == 0 ? cells[X].child1 : cells[X].child2;
+            cuns b = k == 0 ? cells[X].child2 : cells[X].child1;
+            trial1.loadNodeDataFromTwoNodes(&cells[a].node, &cells[Y].node);
+            trial2.loadNodeDataFromTwoNodes(&trial1, &cells[b].node);
+            crvt gain = oldCost - trial1.getPredictedFlopsDC() - trial2.getPredictedFlopsDC();
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestMove = mRotate;
+                bestX = X;
+                bestA = a;
+                bestB = b;
+                bestC = Y;
+            }
+        }
+    }
+
+    // re-pairings: P = ((a, b), (c, d)) => P = ((a, c), (b, d))
+
+    if (isXMerged && isYMerged) {
+        crvt oldCost = cost(x) + cost(y) + cost(p);
+        for (uns k = 0; k < 2; k++) {
+            cuns a = cells[x].child1, b = cells[x].child2;
+            cuns c = k == 0 ? cells[y].child1 : cells[y].child2;
+            cuns d = k == 0 ? cells[y].child2 : cells[y].child1;
+            trial1.loadNodeDataFromTwoNodes(&cells[a].node, &cells[c].node);
+            trial2.loadNodeDataFromTwoNodes(&cells[b].node, &cells[d].node);
+            trial3.loadNodeDataFromTwoNodes(&trial1, &trial2);
+            crvt gain = oldCost - trial1.getPredictedFlopsDC() - trial2.getPredictedFlopsDC() - trial3.getPredictedFlopsDC();
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestMove = mRepair;
+                bestA = a;
+                bestB = b;
+                bestC = c;
+                bestD = d;
+            }
+        }
+    }
+
+    // a change must be better than the rounding errors of the cost
+
+    if (bestMove == mNone || bestGain <= 1.0e-9 * (cost(x) + cost(y) + cost(p)))
+        return false;
+    if (bestMove == mRotate) {
+        merge(bestX, bestA, bestC);
+        merge(p, bestX, bestB);
+    }
+    else {
+        merge(x, bestA, bestC);
+        merge(y, bestB, bestD);
+        merge(p, x, y);
+    }
+    return true;
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::store(hmgSunred::ReductionTreeInstructions& dest, SunredTreeCost& destCost) {
+// the level of a cell is 1 + the level of its higher source
+//***********************************************************************
+    dest.data.clear();
+    destCost = SunredTreeCost{};
+    std::vector<uns> cellLevel(cells.size()), cellIndex(cells.size());
+    for (uns i = 0; i < cells.size(); i++) { // level 0 is every component, the disabled ones too
+        cellIndex[i] = i;
+        if (cells[i].child1 != noCell)
+            break;
+        destCost.add(0, cells[i].node);
+    }
+    for (uns cell : order) {
+        const auto& act = cells[cell];
+        if (act.child1 == noCell)
+            continue;
+        cuns level1 = cellLevel[act.child1], level2 = cellLevel[act.child2];
+        cuns level = (level1 > level2 ? level1 : level2) + 1;
+        if (dest.data.size() < level)
+            dest.data.resize(level);
+        auto& destLevel = dest.data[level - 1];
+        cellLevel[cell] = level;
+        cellIndex[cell] = (uns)destLevel.size();
+        destLevel.push_back(ReductionInstruction{ level1, cellIndex[act.child1], level2, cellIndex[act.child2] });
+        destCost.add(level, act.node);
+    }
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::optimize(const hmgSunred::ReductionTreeInstructions& src, ComponentSubCircuit* pSrc,
+    hmgSunred::ReductionTreeInstructions& dest, SunredTreeCost& destCost, uns maxPasses) {
+//***********************************************************************
+    SunredTreeOptimizer optimizer;
+    optimizer.load(src, pSrc);
+    bool isImproved = true;
+    for (uns pass = 0; pass < maxPasses && isImproved; pass++) {
+        isImproved = false;
+        optimizer.setOrder();
+        for (uns cell : optimizer.order)
+            isImproved = optimizer.improve(cell) || isImproved;
+    }
+    optimizer.setOrder();
+    optimizer.store(dest, destCost);
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::write(FILE* fp, const char* name, const hmgSunred::ReductionTreeInstructions& tree) {
+//***********************************************************************
+    fprintf_s(fp, ".SUNREDTREE %s\n", name);
+    for (uns i = 0; i < tree.data.size(); i++)
+        for (uns j = 0; j < tree.data[i].size(); j++) {
+            const auto& inst = tree.data[i][j];
+            fprintf_s(fp, "RED %u %u %u %u %u %u\n", i + 1, j, inst.cell1Level, inst.cell1Index, inst.cell2Level, inst.cell2Index);
+        }
+    fprintf_s(fp, ".END SUNREDTREE %s\n", name);
+}
+
+
+//***********************************************************************
+struct SunredTreeOutput {
+// hexmg -treeopt <file>
+//***********************************************************************
+    FILE* fp = nullptr;
+    uns nTrees = 0;
+    std::mutex mutex; // the subcircuits can be built parallel
+};
+static SunredTreeOutput sunredTreeOutput;
+
+
+//***********************************************************************
+void SunredTreeOptimizer::openOutput(const char* fileName) {
+//***********************************************************************
+    closeOutput();
+    std::lock_guard<std::mutex> lock(sunredTreeOutput.mutex);
+    if (fopen_s(&sunredTreeOutput.fp, fileName, "wt") != 0)
+        throw hmgExcept("SunredTreeOptimizer::openOutput", "cannot open file to write: %s", fileName);
+    sunredTreeOutput.nTrees = 0;
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::closeOutput() {
+//***********************************************************************
+    std::lock_guard<std::mutex> lock(sunredTreeOutput.mutex);
+    if (sunredTreeOutput.fp == nullptr)
+        return;
+    fclose(sunredTreeOutput.fp);
+    sunredTreeOutput.fp = nullptr;
+}
+
+
+//***********************************************************************
+bool SunredTreeOptimizer::isOutputOpen() {
+//***********************************************************************
+    return sunredTreeOutput.fp != nullptr;
+}
+
+
+//***********************************************************************
+void SunredTreeOptimizer::optimizeToOutput(const hmgSunred::ReductionTreeInstructions& src, ComponentSubCircuit* pSrc, const SunredTreeCost& srcCost) {
+// the trees are named OPT1, OPT2, ... in the order of the tree building
+//***********************************************************************
+    hmgSunred::ReductionTreeInstructions dest;
+    SunredTreeCost destCost;
+    optimize(src, pSrc, dest, destCost);
+
+    std::lock_guard<std::mutex> lock(sunredTreeOutput.mutex);
+    if (sunredTreeOutput.fp == nullptr)
+        return;
+    char name[32];
+    sprintf_s(name, 32, "OPT%u", ++sunredTreeOutput.nTrees);
+    srcCost.print(sunredTreeOutput.fp, "source tree");
+    destCost.print(sunredTreeOutput.fp, name);
+    write(sunredTreeOutput.fp, name, dest);
+    fprintf_s(sunredTreeOutput.fp, "\n");
+    fflush(sunredTreeOutput.fp);
+    printf("SUNRED tree %s: %.4g => %.4g flops, %.3f => %.3f MB\n", name, srcCost.flops, destCost.flops, srcCost.bytes / 1048576.0, destCost.bytes / 1048576.0);
+}
+
+
+//***********************************************************************
+}
+//***********************************************************************
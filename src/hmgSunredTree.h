@@ -0,0 +1,117 @@
+//***********************************************************************
+// HexMG SUNRED Tree Builder Header
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_SUNRED_TREE_HEADER
+#define	HMG_SUNRED_TREE_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgSunred.h"
+#include <cstdio>
+#include <vector>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+class SunredTreeBuilder {
+// SUNRED=AUTO: nested dissection of the component graph. The components are the leaves,
+// two components are neighbours if they share an internal node. A cell is bisected along
+// the breadth-first level structure from a pseudo-peripheral component, so the halves are
+// compact and the separator (the common A nodes of the halves) is small. The halves are
+// reduced recursively, then merged; the level of a cell is 1 + the level of its higher source.
+//***********************************************************************
+    const std::vector<std::vector<uns>>& nodeToLeaves;  // ComponentSubCircuit::internalNodesToComponents
+    std::vector<std::vector<uns>> leafToNodes;
+    std::vector<uns> order;                             // the leaves of a cell are in a contiguous range
+    std::vector<uns> leafSet, leafVisit, nodeVisit;     // stamps
+    std::vector<uns> queue;
+    uns setStamp = 0, visitStamp = 0;
+    hmgSunred::ReductionTreeInstructions& dest;
+    struct Cell { uns level, index; };
+    //***********************************************************************
+    SunredTreeBuilder(const std::vector<std::vector<uns>>& nodeToLeaves_, hmgSunred::ReductionTreeInstructions& dest_)
+        : nodeToLeaves{ nodeToLeaves_ }, dest{ dest_ } {}
+    uns breadthFirst(uns first, uns begin, uns end, uns* result);
+    Cell dissect(uns begin, uns end);
+    //***********************************************************************
+public:
+    //***********************************************************************
+    static void build(const std::vector<std::vector<uns>>& nodeToLeaves, const std::vector<bool>& isLeafEnabled,
+        hmgSunred::ReductionTreeInstructions& dest);
+    //***********************************************************************
+};
+
+
+//***********************************************************************
+struct SunredTreeCost {
+// the predicted cost of forwsubsDC from the ANodeIndex and BNodeIndex sizes of the nodes
+//***********************************************************************
+    struct Level {
+        uns nNodes = 0, maxA = 0, maxB = 0;
+        double flops = 0;   // SunredTreeNode::getPredictedFlopsDC
+        size_t bytes = 0;   // SunredTreeNode::getPredictedBytesDC
+    };
+    std::vector<Level> levels;
+    double flops = 0;
+    size_t bytes = 0;       // every node keeps its matrices for backsubs, so this is the peak memory
+    //***********************************************************************
+    void add(uns level, const SunredTreeNode& node);
+    void print(FILE* fp, const char* title) const; // as .hmg comment lines
+    //***********************************************************************
+};
+
+
+//***********************************************************************
+class SunredTreeOptimizer {
+// Local changes of a SUNRED tree that decrease the predicted flops of forwsubsDC.
+// Only the nodes under the changed node change: the node set of a cell depends on its leaves only.
+//   rotation:   P = ((a, b), Y) => P = ((a, Y), b) or ((b, Y), a)
+//   re-pairing: P = ((a, b), (c, d)) => P = ((a, c), (b, d)) or ((a, d), (b, c))
+// The cells are visited children first, the best change is applied, until no change decreases the cost.
+//***********************************************************************
+    static constexpr uns noCell = ~0u;
+    struct Cell {
+        uns parent = noCell;
+        uns child1 = noCell, child2 = noCell; // noCell: leaf
+        SunredTreeNode node;
+    };
+    std::vector<Cell> cells;                  // cells[i] = pSrc->components[i] for i < nLeaves, then the merged cells
+    std::vector<uns> order;                   // children first
+    SunredTreeNode trial1, trial2, trial3;
+    //***********************************************************************
+    SunredTreeOptimizer() = default;
+    void load(const hmgSunred::ReductionTreeInstructions& src, ComponentSubCircuit* pSrc);
+    void setOrder();
+    double cost(uns cell) const { return cells[cell].node.getPredictedFlopsDC(); }
+    void merge(uns dest, uns src1, uns src2);
+    bool improve(uns cell);
+    void store(hmgSunred::ReductionTreeInstructions& dest, SunredTreeCost& destCost);
+    //***********************************************************************
+public:
+    //***********************************************************************
+    static void optimize(const hmgSunred::ReductionTreeInstructions& src, ComponentSubCircuit* pSrc,
+        hmgSunred::ReductionTreeInstructions& dest, SunredTreeCost& destCost, uns maxPasses = 16);
+    static void write(FILE* fp, const char* name, const hmgSunred::ReductionTreeInstructions& tree); // .SUNREDTREE text
+    //***********************************************************************
+    static void openOutput(const char* fileName); // hexmg -treeopt <file>: every SUNRED tree is optimized and written into the file
+    static void closeOutput();
+    static bool isOutputOpen();
+    static void optimizeToOutput(const hmgSunred::ReductionTreeInstructions& src, ComponentSubCircuit* pSrc, const SunredTreeCost& srcCost);
+    //***********************************************************************
+};
+
+
+}
+
+#endif
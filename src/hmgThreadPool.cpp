@@ -0,0 +1,289 @@
+//***********************************************************************
+// HexMG Thread Pool CPP
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#include "hmgThreadPool.h"
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+static thread_local bool isInsideJob = false;
+static thread_local unsigned threadIndex = 0; // the index of the StealRange of the thread
+//***********************************************************************
+
+
+//***********************************************************************
+void ThreadPool::stopWorkers() {
+//***********************************************************************
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        isStopping = true;
+    }
+    startCV.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+    isStopping = false;
+}
+
+
+//***********************************************************************
+void ThreadPool::setNThreads(unsigned n) {
+//***********************************************************************
+    if (n == 0)
+        n = std::thread::hardware_concurrency();
+    if (n == 0)
+        n = 1;
+    std::lock_guard<std::mutex> callerLock(callerMutex);
+    if (n == getNThreads())
+        return;
+    stopWorkers();
+    ranges = std::make_unique<StealRange[]>(n);
+    deques = std::make_unique<TaskDeque[]>(n);
+    for (unsigned i = 1; i < n; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i, generation);
+}
+
+
+//***********************************************************************
+void ThreadPool::runChunks() {
+//***********************************************************************
+    const unsigned chunkSize = (jobSize + jobChunks - 1) / jobChunks;
+    for (unsigned chunk = nextChunk++; chunk < jobChunks; chunk = nextChunk++) {
+        const unsigned begin = chunk * chunkSize;
+        const unsigned end = begin + chunkSize < jobSize ? begin + chunkSize : jobSize;
+        if (begin < end)
+            (*job)(begin, end);
+    }
+}
+
+
+//***********************************************************************
+bool ThreadPool::popTask(unsigned self, unsigned& task) {
+//***********************************************************************
+    std::atomic<unsigned long long>& range = ranges[self].range;
+    unsigned long long r = range.load();
+    while (true) {
+        const unsigned begin = unsigned(r >> 32), end = unsigned(r);
+        if (begin >= end)
+            return false;
+        if (range.compare_exchange_weak(r, (r & 0xffffffff) | ((unsigned long long)(begin + 1) << 32))) {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+
+//***********************************************************************
+bool ThreadPool::stealTasks(unsigned self) {
+// takes the upper half of the range of the first thread that has tasks, false if no one has
+// (the tasks do not create new tasks, so the job is done for this thread)
+//***********************************************************************
+    const unsigned nThreads = getNThreads();
+    for (unsigned i = 1; i < nThreads; i++) {
+        std::atomic<unsigned long long>& victim = ranges[(self + i) % nThreads].range;
+        unsigned long long r = victim.load();
+        while (true) {
+            const unsigned begin = unsigned(r >> 32), end = unsigned(r);
+            if (begin >= end)
+                break;
+            const unsigned newEnd = end - (end - begin + 1) / 2;
+            if (victim.compare_exchange_weak(r, ((unsigned long long)begin << 32) | newEnd)) {
+                // own range is empty, the thieves do not modify it
+                ranges[self].range.store(((unsigned long long)newEnd << 32) | end);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//***********************************************************************
+void ThreadPool::runTasks() {
+//***********************************************************************
+    const unsigned self = threadIndex;
+    unsigned task;
+    do {
+        while (popTask(self, task))
+            (*taskJob)(task);
+    } while (stealTasks(self));
+}
+
+
+//***********************************************************************
+bool ThreadPool::popReadyTask(unsigned self, unsigned& task) {
+// from the back of the own deque (the last readied task: its inputs are hot in the cache),
+// or from the front of an other deque
+//***********************************************************************
+    const unsigned nThreads = getNThreads();
+    {   TaskDeque& own = deques[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned i = 1; i < nThreads; i++) {
+        TaskDeque& victim = deques[(self + i) % nThreads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//***********************************************************************
+void ThreadPool::runDataflow() {
+// a thread without ready task waits for the others while tasks remain
+//***********************************************************************
+    const unsigned self = threadIndex;
+    TaskDeque& own = deques[self];
+    const ReadyFunction ready = [&own](unsigned task) {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(task);
+    };
+    unsigned task;
+    while (remainingTasks.load() != 0) {
+        if (popReadyTask(self, task)) {
+            (*dataflowJob)(task, ready);
+            remainingTasks--;
+        }
+        else
+            std::this_thread::yield();
+    }
+}
+
+
+//***********************************************************************
+void ThreadPool::workerLoop(unsigned index, unsigned long long seenGeneration) {
+// seenGeneration is the generation when the thread was created, a job can arrive before the thread starts
+//***********************************************************************
+    isInsideJob = true;
+    threadIndex = index;
+    std::unique_lock<std::mutex> lock(jobMutex);
+    while (true) {
+        startCV.wait(lock, [this, seenGeneration] { return isStopping || generation != seenGeneration; });
+        if (isStopping)
+            return;
+        seenGeneration = generation;
+        lock.unlock();
+        (this->*runJob)();
+        lock.lock();
+        if (--busyWorkers == 0)
+            doneCV.notify_one();
+    }
+}
+
+
+//***********************************************************************
+void ThreadPool::parallelFor(unsigned n, const std::function<void(unsigned begin, unsigned end)>& fn) {
+//***********************************************************************
+    if (n == 0)
+        return;
+    if (workers.empty() || n == 1 || isInsideJob || !callerMutex.try_lock()) {
+        fn(0, n);
+        return;
+    }
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        runJob = &ThreadPool::runChunks;
+        job = &fn;
+        jobSize = n;
+        jobChunks = n < 4 * getNThreads() ? n : 4 * getNThreads(); // smaller chunks for load balance
+        nextChunk = 0;
+    }
+    runJobAndWait();
+}
+
+
+//***********************************************************************
+void ThreadPool::parallelTasks(unsigned n, const std::function<void(unsigned i)>& fn) {
+//***********************************************************************
+    if (n == 0)
+        return;
+    if (workers.empty() || n == 1 || isInsideJob || !callerMutex.try_lock()) {
+        for (unsigned i = 0; i < n; i++)
+            fn(i);
+        return;
+    }
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        runJob = &ThreadPool::runTasks;
+        taskJob = &fn;
+        const unsigned nThreads = getNThreads();
+        for (unsigned i = 0; i < nThreads; i++) {
+            const unsigned long long begin = (unsigned long long)n * i / nThreads, end = (unsigned long long)n * (i + 1) / nThreads;
+            ranges[i].range.store((begin << 32) | end);
+        }
+    }
+    runJobAndWait();
+}
+
+
+//***********************************************************************
+void ThreadPool::parallelDataflow(unsigned nTasks, const std::vector<unsigned>& firstTasks, const DataflowFunction& fn) {
+//***********************************************************************
+    if (nTasks == 0)
+        return;
+    if (workers.empty() || nTasks == 1 || isInsideJob || !callerMutex.try_lock()) {
+        std::vector<unsigned> stack(firstTasks.rbegin(), firstTasks.rend());
+        const ReadyFunction ready = [&stack](unsigned task) { stack.push_back(task); };
+        while (!stack.empty()) {
+            const unsigned task = stack.back();
+            stack.pop_back();
+            fn(task, ready);
+        }
+        return;
+    }
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        runJob = &ThreadPool::runDataflow;
+        dataflowJob = &fn;
+        remainingTasks = nTasks;
+        const unsigned nThreads = getNThreads();
+        const size_t n = firstTasks.size();
+        for (unsigned i = 0; i < nThreads; i++) { // contiguous blocks: the neighbouring tasks usually have common successors
+            std::lock_guard<std::mutex> dequeLock(deques[i].mutex);
+            deques[i].tasks.assign(firstTasks.begin() + n * i / nThreads, firstTasks.begin() + n * (i + 1) / nThreads);
+        }
+    }
+    runJobAndWait();
+}
+
+
+//***********************************************************************
+void ThreadPool::runJobAndWait() {
+// the job is set, callerMutex is locked by the caller, it is unlocked at the end
+//***********************************************************************
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        busyWorkers = (unsigned)workers.size();
+        generation++;
+    }
+    startCV.notify_all();
+    isInsideJob = true;
+    threadIndex = 0;
+    (this->*runJob)();
+    isInsideJob = false;
+    {   std::unique_lock<std::mutex> lock(jobMutex);
+        doneCV.wait(lock, [this] { return busyWorkers == 0; });
+        job = nullptr;
+        taskJob = nullptr;
+        dataflowJob = nullptr;
+    }
+    callerMutex.unlock();
+}
+
+
+}
@@ -0,0 +1,107 @@
+//***********************************************************************
+// HexMG Thread Pool Header
+// Creation date:  2026. 10. 17.
+// Creator:        Pohl Lszl
+//***********************************************************************
+
+
+//***********************************************************************
+#ifndef HMG_THREAD_POOL_HEADER
+#define	HMG_THREAD_POOL_HEADER
+//***********************************************************************
+
+
+//***********************************************************************
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+//***********************************************************************
+
+
+//***********************************************************************
+namespace nsHMG {
+//***********************************************************************
+
+
+//***********************************************************************
+class ThreadPool {
+// Process-wide worker threads for the data parallel loops of the matrix operations and for the
+// independent nodes of the SUNRED trees. The calling thread also works. parallelFor and
+// parallelTasks are serial if they are called from a job or while an other thread runs a job,
+// so the callers do not need to know about each other.
+//***********************************************************************
+    struct alignas(64) StealRange {
+    // the not yet started tasks of a thread: begin in the upper, end in the lower 32 bits;
+    // the owner takes the tasks from the begin, the thieves take the upper half
+        std::atomic<unsigned long long> range = 0;
+    };
+    struct alignas(64) TaskDeque {
+    // the ready tasks of a dataflow job: the owner works at the back, the thieves take from the front
+        std::mutex mutex;
+        std::deque<unsigned> tasks;
+    };
+public:
+    using ReadyFunction = std::function<void(unsigned task)>;
+    using DataflowFunction = std::function<void(unsigned task, const ReadyFunction& ready)>;
+private:
+    std::vector<std::thread> workers;
+    std::unique_ptr<StealRange[]> ranges; // [0] is the calling thread, [i] is workers[i - 1]
+    std::unique_ptr<TaskDeque[]> deques;  // indexed as ranges
+    std::mutex jobMutex;
+    std::mutex callerMutex; // one job at a time
+    std::condition_variable startCV, doneCV;
+    void (ThreadPool::*runJob)() = nullptr; // runChunks, runTasks or runDataflow
+    const std::function<void(unsigned, unsigned)>* job = nullptr;
+    const std::function<void(unsigned)>* taskJob = nullptr;
+    const DataflowFunction* dataflowJob = nullptr;
+    std::atomic<unsigned> remainingTasks = 0;
+    unsigned jobSize = 0, jobChunks = 0;
+    std::atomic<unsigned> nextChunk = 0;
+    unsigned busyWorkers = 0;
+    unsigned long long generation = 0;
+    bool isStopping = false;
+    //***********************************************************************
+    ThreadPool() { setNThreads(0); }
+    ~ThreadPool() { stopWorkers(); }
+    void stopWorkers();
+    void workerLoop(unsigned index, unsigned long long seenGeneration);
+    void runChunks();
+    void runTasks();
+    bool popTask(unsigned self, unsigned& task);
+    bool stealTasks(unsigned self);
+    void runDataflow();
+    bool popReadyTask(unsigned self, unsigned& task);
+    void runJobAndWait();
+    //***********************************************************************
+public:
+    //***********************************************************************
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    static ThreadPool& getInstance() { static ThreadPool pool; return pool; }
+    //***********************************************************************
+    unsigned getNThreads() const noexcept { return (unsigned)workers.size() + 1; } // with the calling thread
+    void setNThreads(unsigned n); // 0: std::thread::hardware_concurrency()
+    //***********************************************************************
+    // fn(begin, end) is called for disjoint subranges covering [0, n), fn cannot throw
+    void parallelFor(unsigned n, const std::function<void(unsigned begin, unsigned end)>& fn);
+    //***********************************************************************
+    // fn(i) is called for every i in [0, n), fn cannot throw; for tasks of very different
+    // cost: every thread starts with a contiguous range, the idle threads steal from the others
+    void parallelTasks(unsigned n, const std::function<void(unsigned i)>& fn);
+    //***********************************************************************
+    // dataflow: fn(task, ready) is called for firstTasks and for every task that is reported
+    // by an fn with ready(task) when its inputs are done (e.g. with atomic countdowns);
+    // the job returns when nTasks tasks have run, fn cannot throw
+    void parallelDataflow(unsigned nTasks, const std::vector<unsigned>& firstTasks, const DataflowFunction& fn);
+    //***********************************************************************
+};
+
+
+}
+
+#endif
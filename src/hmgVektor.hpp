@@ -13,9 +13,12 @@
 
 //***********************************************************************
 #include "hmgException.h"
+#include "hmgArena.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <type_traits>
+#include <utility>
 //***********************************************************************
 
 
@@ -24,6 +27,21 @@ namespace nsHMG {
 //***********************************************************************
 
 
+//***********************************************************************
+template<typename datatype> struct vektor_view {
+// non-owning, element i is arr[i * stride]
+//***********************************************************************
+    datatype* arr = nullptr;
+    unsigned n = 0;
+    size_t stride = 1;
+    //***********************************************************************
+    unsigned size() const noexcept { return n; }
+    datatype& operator[](unsigned i) const noexcept(!hmgVErrorCheck) { if constexpr (hmgVErrorCheck) is_smaller_error(i, n, "vektor_view::operator[]"); return arr[i * stride]; }
+    operator vektor_view<const datatype>() const noexcept requires (!std::is_const<datatype>::value) { return { arr, n, stride }; }
+    //***********************************************************************
+};
+
+
 #ifdef NDEBUG // in release mode the original vektor is used
 
 //***********************************************************************
@@ -34,13 +52,27 @@ template<typename datatype> class vektor {
     bool to_be_deleted;
     //***********************************************************************
     vektor(const vektor&) = delete;
-    vektor(const vektor&&) = delete;
-    void operator=(const vektor&&) = delete;
     //***********************************************************************
 public:
     //***********************************************************************
     vektor() noexcept :arr{ nullptr }, n{ 0 }, to_be_deleted{ false } {}
     //***********************************************************************
+    vektor(datatype* laid_arr, unsigned laid_n) noexcept :arr{ laid_arr }, n{ laid_n }, to_be_deleted{ false } {} // non-owning, like lay()
+    //***********************************************************************
+    vektor(vektor&& theother) noexcept :arr{ theother.arr }, n{ theother.n }, to_be_deleted{ theother.to_be_deleted } {
+    //***********************************************************************
+        theother.arr = nullptr;
+        theother.n = 0;
+        theother.to_be_deleted = false;
+    }
+    //***********************************************************************
+    vektor& operator=(vektor&& theother) noexcept { if (this != &theother) { clear(); swap(theother); } return *this; }
+    //***********************************************************************
+    void swap(vektor& theother) noexcept { std::swap(arr, theother.arr); std::swap(n, theother.n); std::swap(to_be_deleted, theother.to_be_deleted); }
+    //***********************************************************************
+    vektor_view<datatype> view() noexcept { return { arr, n, 1 }; }
+    vektor_view<const datatype> view() const noexcept { return { arr, n, 1 }; }
+    //***********************************************************************
     ~vektor() { clear_without_setting_member_variables(); }
     //***********************************************************************
     unsigned size()const noexcept { return n; }
@@ -49,8 +81,23 @@ public:
     //***********************************************************************
     void clear() noexcept { clear_without_setting_member_variables(); arr = nullptr; n = 0; to_be_deleted = false; }
     //***********************************************************************
-    void set_size(unsigned new_size) { clear_without_setting_member_variables(); n = new_size; arr = (n == 0) ? nullptr : new datatype[n]; to_be_deleted = true; }
-    void resize_if_needed(unsigned new_size) { if (n != new_size)set_size(new_size); }
+    void set_size(unsigned new_size, AlignedArena* arena = nullptr) {
+    // if arena is given, the storage comes from the arena (aligned, the arena frees it)
+    //***********************************************************************
+        clear_without_setting_member_variables();
+        n = new_size;
+        if constexpr (std::is_trivially_destructible<datatype>::value) {
+            if (arena != nullptr) {
+                arr = arena->allocate_array<datatype>(n);
+                to_be_deleted = false;
+                return;
+            }
+        }
+        arr = (n == 0) ? nullptr : new datatype[n];
+        to_be_deleted = true;
+    }
+    //***********************************************************************
+    void resize_if_needed(unsigned new_size, AlignedArena* arena = nullptr) { if (n != new_size)set_size(new_size, arena); }
     //***********************************************************************
     void set_size_and_zero(unsigned new_size) { set_size(new_size); zero(); }
     //***********************************************************************
@@ -64,6 +111,10 @@ public:
     //***********************************************************************
     datatype& last() noexcept(!hmgVErrorCheck) { return operator[](n - 1); }
     //***********************************************************************
+    datatype* data() noexcept { return arr; }
+    //***********************************************************************
+    const datatype* data() const noexcept { return arr; }
+    //***********************************************************************
         
     //***********************************************************************
     vektor & operator=(const vektor& theother){
@@ -292,21 +343,32 @@ template<typename datatype> class vektor {
     bool to_be_deleted = false;
     //***********************************************************************
     //vektor(const vektor&) = delete;
-    //vektor(const vektor&&) = delete;
-    //void operator=(const vektor&&) = delete;
     //***********************************************************************
 public:
     //***********************************************************************
     vektor() = default;
     //***********************************************************************
+    vektor(datatype* laid_arr, unsigned laid_n) noexcept :arr{ laid_arr }, n{ laid_n }, to_be_deleted{ false } {} // non-owning, like lay()
+    //***********************************************************************
+    vektor(vektor&& theother) noexcept { swap(theother); }
+    //***********************************************************************
+    vektor& operator=(vektor&& theother) noexcept { if (this != &theother) { clear(); swap(theother); } return *this; }
+    //***********************************************************************
+    void swap(vektor& theother) noexcept { vec.swap(theother.vec); std::swap(arr, theother.arr); std::swap(n, theother.n); std::swap(to_be_deleted, theother.to_be_deleted); } // arr stays valid, std::vector::swap does not move the elements
+    //***********************************************************************
+    vektor_view<datatype> view() noexcept { return { arr, n, 1 }; }
+    vektor_view<const datatype> view() const noexcept { return { arr, n, 1 }; }
+    //***********************************************************************
     unsigned size()const noexcept { return n; }
     //***********************************************************************
     void clear_without_setting_member_variables() noexcept { if (to_be_deleted)vec.clear(); }
     //***********************************************************************
     void clear() noexcept { clear_without_setting_member_variables(); arr = nullptr; n = 0; to_be_deleted = false; }
     //***********************************************************************
-    void set_size(unsigned new_size) { clear_without_setting_member_variables(); n = new_size; vec.resize(n); arr = (n == 0) ? nullptr : &vec[0]; to_be_deleted = true; }
-    void resize_if_needed(unsigned new_size) { if (n != new_size)set_size(new_size); }
+    // debug builds always allocate on the heap (the own std::vector), the arena is ignored,
+    // so the memory of every vektor can be checked separately
+    void set_size(unsigned new_size, [[maybe_unused]] AlignedArena* arena = nullptr) { clear_without_setting_member_variables(); n = new_size; vec.resize(n); arr = (n == 0) ? nullptr : &vec[0]; to_be_deleted = true; }
+    void resize_if_needed(unsigned new_size, [[maybe_unused]] AlignedArena* arena = nullptr) { if (n != new_size)set_size(new_size); }
     //***********************************************************************
     void set_size_and_zero(unsigned new_size) { set_size(new_size); zero(); }
     //***********************************************************************
@@ -320,6 +382,10 @@ public:
     //***********************************************************************
     datatype& last() noexcept(!hmgVErrorCheck) { return operator[](n - 1); }
     //***********************************************************************
+    datatype* data() noexcept { return arr; }
+    //***********************************************************************
+    const datatype* data() const noexcept { return arr; }
+    //***********************************************************************
         
     //***********************************************************************
     vektor & operator=(const vektor& theother){